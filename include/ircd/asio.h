@@ -40,6 +40,17 @@ namespace boost
 }
 #endif
 
+// Select the io_uring backend for the whole of asio rather than the epoll
+// reactor: socket, timer and descriptor operations become ring submissions
+// which the scheduler submits and reaps together on each pass of the run
+// loop. This must be identical for every unit including asio.
+#if defined(IRCD_USE_ASIO_IO_URING) && BOOST_VERSION < 107800
+	#error "The asio io_uring backend requires boost 1.78 or later."
+#elif defined(IRCD_USE_ASIO_IO_URING)
+	#define BOOST_ASIO_HAS_IO_URING 1
+	#define BOOST_ASIO_DISABLE_EPOLL 1
+#endif
+
 // Needed for consistent interop with std::system_error
 #include <boost/system/system_error.hpp>
 
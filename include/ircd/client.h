@@ -32,6 +32,7 @@ struct ircd::client
 	struct conf;
 	struct settings;
 	struct request;
+	struct h2;
 
 	static log::log log;
 	static struct settings settings;
@@ -48,6 +49,7 @@ struct ircd::client
 	static void close_all();
 	static void wait_all();
 	static void spawn();
+	static void resume(std::shared_ptr<client>, std::function<bool (client &)>);
 
 	struct conf *conf {&default_conf};
 	unique_buffer<mutable_buffer> head_buffer;
@@ -62,6 +64,10 @@ struct ircd::client
 	size_t head_length {0};
 	size_t content_consumed {0};
 	resource::request request;
+	std::shared_ptr<struct h2> h2;    // HTTP/2 connection state, if negotiated
+	http2::stream *stream {nullptr};  // HTTP/2 stream carrying this request
+	bool parkable {false};            // request may be parked (see park())
+	bool parked {false};              // request continues on resume()
 
 	string_view loghead() const;
 	size_t write_all(const net::const_buffers &);
@@ -69,9 +75,12 @@ struct ircd::client
 	void close(const net::close_opts &, net::close_callback);
 	ctx::future<void> close(const net::close_opts & = {});
 
+	bool park();
 	void discard_unconsumed(const http::request::head &);
 	bool resource_request(const http::request::head &);
 	bool handle_request(parse::capstan &pc);
+	bool handle_frame(const http2::frame::header &, const const_buffer &);
+	bool main_h2();
 	bool main();
 	bool async();
 
@@ -22,6 +22,8 @@ namespace ircd::ctx::ole
 	struct init;
 	struct opts;
 	struct offload;
+
+	size_t thread_count() noexcept;
 }
 
 namespace ircd::ctx
@@ -42,7 +44,9 @@ struct ircd::ctx::ole::opts
 	/// Optionally give this offload task a name for any tasklist.
 	string_view name;
 
-	/// The function will be executed on each thread.
+	/// The function will be executed this many times, each potentially on
+	/// a different thread. The function is responsible for partitioning the
+	/// work among its invocations. Offload returns after all have returned.
 	size_t concurrency {1};
 
 	/// Queuing priority; in the form of a nice value.
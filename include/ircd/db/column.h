@@ -70,6 +70,12 @@ namespace ircd::db
 	uint64_t read(const columns &, const keys &, const bufs &, const gopts & = {});
 	uint64_t read(column &, const keys &, const bufs &, const gopts & = {});
 
+	// [GET] Parallel query without copying; the closure is called for each
+	// key found with its position in the keys vector. Returns count found.
+	using read_closure = std::function<void (const size_t &, const string_view &)>;
+	size_t read(const columns &, const keys &, const read_closure &, const gopts & = {});
+	size_t read(column &, const keys &, const read_closure &, const gopts & = {});
+
 	// [SET] Write data to the db
 	void write(column &, const string_view &key, const const_buffer &value, const sopts & = {});
 
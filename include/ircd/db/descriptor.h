@@ -94,6 +94,10 @@ struct ircd::db::descriptor
 	/// Compaction priority algorithm
 	std::string compaction_pri {};
 
+	/// User given merge operator; when given, op::MERGE deltas to the column
+	/// are combined with the existing value by this closure.
+	db::merge_closure merge {};
+
 	/// Compaction related parameters. see: rocksdb/advanced_options.h
 	struct
 	{
@@ -94,6 +94,7 @@ struct ircd::db::txn::append
 	append(txn &, const row::delta &);
 	append(txn &, const delta &);
 	append(txn &, const string_view &key, const json::iov &);
+	append(txn &, const txn &);
 };
 
 struct ircd::db::txn::checkpoint
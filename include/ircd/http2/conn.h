@@ -0,0 +1,76 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_HTTP2_CONN_H
+
+namespace ircd::http2
+{
+	struct conn;
+}
+
+/// Framing layer of one HTTP/2 connection, shared by the server (client.cc)
+/// and the client (server/) directions. The owner runs a loop over read(),
+/// passing each frame to handle(); frames concerning only the connection are
+/// dealt with there and anything remaining is for the owner's streams.
+///
+/// Writes may be made from any context. Frames are serialized by the write
+/// mutex and DATA observes flow control: a writer blocks until the peer
+/// extends credit. Heads are exchanged with the owner in HTTP/1.1 form so
+/// the existing grammars on either side are reused unmodified.
+///
+struct ircd::http2::conn
+{
+	static conf::item<size_t> window_size;
+	static conf::item<size_t> streams_max;
+	static conf::item<size_t> head_max;
+
+	std::shared_ptr<net::socket> sock;
+	struct settings local;                   // settings we sent the peer
+	struct settings remote;                  // settings the peer sent us
+	hpack::decoder decoder;
+	std::map<uint32_t, stream *> streams;
+	unique_buffer<mutable_buffer> buf;       // input read off the socket
+	size_t buf_parsed {0};                   // frames consumed from buf
+	size_t buf_read {0};                     // end of input in buf
+	int64_t send_window {65535};
+	int64_t recv_window {65535};
+	uint32_t last_id {0};                    // highest stream opened by the peer
+	uint32_t goaway {-1U};                   // last stream id allowed by the peer
+	ctx::mutex write_mutex;
+	ctx::dock dock;                          // notified on credit or closure
+
+	static const_buffer payload(const frame::header &, const const_buffer &);
+
+	// Receiving
+	size_t buffered() const                  { return buf_read - buf_parsed;   }
+	const_buffer read(frame::header &);
+	bool handle(const frame::header &, const const_buffer &);
+	bool read_head(stream &, const const_buffer &block);
+
+	// Transmitting
+	void write(const frame::header &, const net::const_buffers &);
+	void write_settings(const bool &ack = false);
+	void write_window_update(const uint32_t &stream_id, const uint32_t &inc);
+	void write_rst_stream(stream &, const enum error::code &);
+	void write_goaway(const enum error::code &);
+	void write_head(stream &, const string_view &head, const bool &end_stream);
+	size_t write_data(stream &, const net::const_buffers &, const bool &end_stream);
+
+	// Stream registry
+	void add(stream &);
+	void del(stream &) noexcept;
+	void close() noexcept;
+
+	conn(std::shared_ptr<net::socket>);
+	conn(conn &&) = delete;
+	conn(const conn &) = delete;
+	~conn() noexcept;
+};
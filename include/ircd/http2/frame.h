@@ -21,10 +21,13 @@ struct ircd::http2::frame
 	struct header;
 	struct settings;
 	enum type :uint8_t;
+	enum flag :uint8_t;
 
 	static string_view reflect(const type &);
 };
 
+/// Frame header in host order. The wire format is big-endian and must go
+/// through the constructor or write() rather than a reinterpretation.
 struct ircd::http2::frame::header
 {
 	uint32_t len        : 24;
@@ -32,6 +35,12 @@ struct ircd::http2::frame::header
 	uint8_t flags;
 	uint32_t            : 1;
 	uint32_t stream_id  : 31;
+
+	const_buffer write(const mutable_buffer &) const;
+
+	header(const uint32_t &len, const enum type &, const uint8_t &flags, const uint32_t &stream_id);
+	explicit header(const const_buffer &);
+	header() = default;
 }
 __attribute__((packed));
 
@@ -49,3 +58,15 @@ enum ircd::http2::frame::type
 	WINDOW_UPDATE  = 0x8,
 	CONTINUATION   = 0x9,
 };
+
+/// Flag bits are interpreted per frame type; ACK is found with the SETTINGS
+/// and PING frames while END_STREAM is found with DATA and HEADERS.
+enum ircd::http2::frame::flag
+:uint8_t
+{
+	ACK            = 0x01,
+	END_STREAM     = 0x01,
+	END_HEADERS    = 0x04,
+	PADDED         = 0x08,
+	HAS_PRIORITY   = 0x20,
+};
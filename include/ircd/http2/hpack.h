@@ -0,0 +1,57 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_HTTP2_HPACK_H
+
+/// Header compression for HTTP/2 (RFC 7541)
+namespace ircd::http2::hpack
+{
+	struct table;
+	struct decoder;
+	using entry = std::pair<string_view, string_view>;
+	using closure = std::function<void (const string_view &, const string_view &)>;
+
+	extern const entry static_table[61];
+
+	// Huffman string literals
+	size_t huffman_decode(const mutable_buffer &out, const const_buffer &in);
+
+	// Integer with N-bit prefix; the high bits of the first byte are flags.
+	size_t encode(const mutable_buffer &out, const uint8_t &flags, const uint8_t &prefix, const size_t &val);
+	size_t decode(const_buffer &in, const uint8_t &prefix);
+
+	// Header field; encoding never touches the dynamic table.
+	size_t encode(window_buffer &, const string_view &name, const string_view &value);
+}
+
+/// Dynamic table. Entries are indexed after the static table with the most
+/// recently inserted entry first.
+struct ircd::http2::hpack::table
+{
+	std::deque<std::pair<std::string, std::string>> entries;
+	size_t size {0};
+	size_t max {4096};
+
+	entry operator[](const size_t &index) const;  // 1-based; spans both tables
+	void resize(const size_t &max);
+	void add(const string_view &name, const string_view &value);
+};
+
+/// Decoding context for the header blocks received on a connection. Blocks
+/// must be decoded in the order they were received since each may alter the
+/// dynamic table for the next.
+struct ircd::http2::hpack::decoder
+{
+	struct table table;
+	size_t max {4096};   // SETTINGS_HEADER_TABLE_SIZE we advertised
+
+	void operator()(const const_buffer &block, const closure &);
+};
@@ -62,5 +62,8 @@ struct ircd::http2::settings
 	using code = frame::settings::code;
 	using array_type = std::array<uint32_t, num_of<code>()>;
 
+	const uint32_t &operator[](const code &c) const  { return array_type::at(c - 1);  }
+	uint32_t &operator[](const code &c)              { return array_type::at(c - 1);  }
+
 	settings();
 };
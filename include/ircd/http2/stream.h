@@ -20,9 +20,21 @@ struct ircd::http2::stream
 {
 	enum class state :uint8_t;
 
+	uint32_t id {0};
 	enum state state;
+	int64_t send_window {65535};             // credit for DATA we may send
+	int64_t recv_window {65535};             // credit for DATA the peer may send
+	size_t content_length {-1UL};            // outgoing; -1 is until END_STREAM
+	size_t content_sent {0};                 // outgoing DATA written so far
+	std::string block;                       // incoming header block fragments
+	std::string head;                        // incoming head as HTTP/1.1 text
+	std::string content;                     // incoming DATA
 
-	stream();
+	bool closed() const;
+	bool local_closed() const;               // we have sent END_STREAM
+	bool remote_closed() const;              // peer has sent END_STREAM
+
+	stream(const uint32_t &id = 0);
 };
 
 namespace ircd::http2
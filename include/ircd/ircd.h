@@ -103,6 +103,7 @@
 #include "rfc1035.h"
 #include "rfc3986.h"
 #include "net/net.h"
+#include "http2/conn.h"
 #include "server/server.h"
 #include "magick.h"
 #include "resource/resource.h"
@@ -64,6 +64,7 @@ struct ircd::json::object
 {
 	struct member;
 	struct const_iterator;
+	struct tape;
 
 	using key_type = string_view;
 	using mapped_type = string_view;
@@ -112,6 +113,7 @@ struct ircd::json::object
 
 #include "object_member.h"
 #include "object_iterator.h"
+#include "object_tape.h"
 
 template<ircd::json::name_hash_t key,
          class T>
@@ -0,0 +1,168 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_JSON_OBJECT_TAPE_H
+
+namespace ircd::json
+{
+	template<name_hash_t key, class T = string_view> T at(const object::tape &);
+	template<name_hash_t key, class T = string_view> T get(const object::tape &, const T &def = {});
+}
+
+/// Structural index of a json::object.
+///
+/// The object is parsed once when the tape is made; the members are recorded
+/// in their order with the hash of each key, ordered by that hash for lookup.
+/// Queries to the tape are then a binary search over integers rather than a
+/// parse of the object from its first byte; this is worthwhile when many
+/// queries are made to the same object. Only the top level is indexed; the
+/// values are the same views of the object as with object::find().
+///
+/// The tape can be remade for another object; its allocations are reused.
+///
+struct ircd::json::object::tape
+{
+	using hash_pos = std::pair<name_hash_t, uint32_t>;
+
+	json::object object;
+	std::vector<member> members;             // document order
+	std::vector<hash_pos> hashes;            // ordered by hash; pos in members
+
+	const member *_find(const name_hash_t &, const string_view &key = {}) const;
+
+  public:
+	// fundamental
+	auto begin() const                       { return std::begin(members);     }
+	auto end() const                         { return std::end(members);       }
+	size_t count() const                     { return members.size();          }
+	bool empty() const                       { return members.empty();         }
+	const member *find(const name_hash_t &key) const;
+	const member *find(const string_view &key) const;
+
+	// util
+	bool has(const string_view &key) const;
+	bool has(const string_view &key, const enum json::type &) const;
+
+	// returns value or default
+	template<class T> T get(const string_view &key, const T &def = T{}) const;
+	string_view get(const string_view &key, const string_view &def = {}) const;
+
+	// returns value or throws not_found
+	template<class T = string_view> T at(const string_view &key) const;
+
+	// returns value or empty
+	string_view operator[](const string_view &key) const;
+
+	// (re)index
+	void operator()(const json::object &);
+
+	tape(const json::object &);
+	tape() = default;
+};
+
+template<class T>
+inline T
+ircd::json::object::tape::at(const string_view &key)
+const try
+{
+	const auto *const member
+	{
+		find(key)
+	};
+
+	if(unlikely(!member))
+		throw not_found
+		{
+			"'%s'", key
+		};
+
+	return lex_cast<T>(member->second);
+}
+catch(const bad_lex_cast &e)
+{
+	throw type_error
+	{
+		"'%s' must cast to type %s",
+		key,
+		typeid(T).name()
+	};
+}
+
+template<class T>
+inline T
+ircd::json::object::tape::get(const string_view &key,
+                              const T &def)
+const try
+{
+	const string_view sv
+	{
+		operator[](key)
+	};
+
+	return !sv.empty()?
+		lex_cast<T>(sv):
+		def;
+}
+catch(const bad_lex_cast &e)
+{
+	return def;
+}
+
+template<ircd::json::name_hash_t key,
+         class T>
+inline T
+ircd::json::at(const object::tape &tape)
+try
+{
+	const auto *const member
+	{
+		tape.find(key)
+	};
+
+	if(unlikely(!member))
+		throw not_found
+		{
+			"[key hash] '%lu'", ulong(key)
+		};
+
+	return lex_cast<T>(member->second);
+}
+catch(const bad_lex_cast &e)
+{
+	throw type_error
+	{
+		"[key hash] '%lu' must cast to type %s",
+		ulong(key),
+		typeid(T).name()
+	};
+}
+
+template<ircd::json::name_hash_t key,
+         class T>
+inline T
+ircd::json::get(const object::tape &tape,
+                const T &def)
+try
+{
+	const auto *const member
+	{
+		tape.find(key)
+	};
+
+	if(!member || member->second.empty())
+		return def;
+
+	return lex_cast<T>(member->second);
+}
+catch(const bad_lex_cast &e)
+{
+	return def;
+}
@@ -36,6 +36,12 @@ namespace ircd::json
 	void valid(const string_view &);
 	std::string why(const string_view &);
 
+	// Components of valid(): the vectorized structural scanner, which is only
+	// conclusive when true, and the grammar, which has the final say. The
+	// scanner serves valid() only; iteration and access use the grammar.
+	bool scan(const string_view &) noexcept;
+	bool parse_valid(const string_view &) noexcept;
+
 	struct stats extern stats;
 }
 
@@ -53,12 +53,17 @@ namespace ircd::m::dbs::appendix
 #include "event_sender.h"           // sender | event_idx || hostpart | localpart, event_idx
 #include "event_type.h"             // type | event_idx
 #include "event_state.h"            // state_key, type, room_id, depth, event_idx
+#include "event_term.h"             // term | room_id, event_idx => frequency
+#include "event_chain.h"            // event_idx => chain labels || chain | seq => event_idx
 #include "room_events.h"            // room_id | depth, event_idx
 #include "room_type.h"              // room_id | type, depth, event_idx
 #include "room_state.h"             // room_id | type, state_key => event_idx
 #include "room_state_space.h"       // room_id | type, state_key, depth, event_idx
 #include "room_joined.h"            // room_id | origin, member => event_idx
 #include "room_head.h"              // room_id | event_id => event_idx
+#include "room_count.h"             // room_id, type | event_idx => rank
+#include "room_stats.h"             // room_id | counter, host => int64
+#include "user_touch.h"             // user_id | room_id => event_idx
 
 /// Options that affect the dbs::write() of an event to the transaction.
 struct ircd::m::dbs::write_opts
@@ -97,6 +102,13 @@ struct ircd::m::dbs::write_opts
 	/// has not even been written to the database, and this may even point to
 	/// the same db::txn as the result being composed in the first place. By
 	/// default a database query is made as a fallback after using this.
+	///
+	/// Indexers which read what they then modify rely on this: evals compose
+	/// their transactions one at a time, after every prior write is either
+	/// committed or found here, so what was read can't be changed by another
+	/// writer before the result commits. Writers outside of the vm have the
+	/// same guarantee while they compose and commit under a
+	/// vm::sequence::hold.
 	const db::txn *interpose {nullptr};
 
 	/// Whether indexers are allowed to make database queries when composing
@@ -162,12 +174,28 @@ enum ircd::m::dbs::appendix::index
 	/// Involves the event_state column.
 	EVENT_STATE,
 
+	/// Involves the event_term column (inverted index on the content.body).
+	EVENT_TERM,
+
+	/// Involves the event_chain and chain_event columns (chain cover of the
+	/// auth graph). State events only.
+	EVENT_CHAIN,
+
 	/// Involves room_events table.
 	ROOM_EVENTS,
 
 	/// Involves room_type table.
 	ROOM_TYPE,
 
+	/// Involves the room_count table. Must be dark when re-indexing events
+	/// which were already counted, otherwise they are counted again.
+	ROOM_COUNT,
+
+	/// Involves the room_stats table. Each counter follows the bit of the
+	/// index it counts: events with ROOM_EVENTS, JSON bytes with EVENT_JSON
+	/// and members with ROOM_STATE.
+	ROOM_STATS,
+
 	/// Whether the event should be added to the room_head, indicating that
 	/// it has not yet been referenced at the time of this write. Defaults
 	/// to true, but if this is an older event this opt should be rethought.
@@ -186,6 +214,10 @@ enum ircd::m::dbs::appendix::index
 	/// Involves room_joined table.
 	ROOM_JOINED,
 
+	/// Involves the user_touch table; fans out to the local members of the
+	/// room. Can be dark when the event is of no interest to clients.
+	USER_TOUCH,
+
 	/// Take branch to handle room redaction events.
 	ROOM_REDACT,
 };
@@ -0,0 +1,57 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_EVENT_CHAIN_H
+
+namespace ircd::m::dbs
+{
+	// Position of a state event in the auth graph: (chain, seq).
+	using chain_pos = std::pair<uint64_t, uint64_t>;
+	using event_chain_closure = std::function<void (const chain_pos &self, const vector_view<const chain_pos> &reach)>;
+
+	constexpr size_t EVENT_CHAIN_KEY_MAX_SIZE
+	{
+		sizeof(uint64_t) + sizeof(uint64_t)
+	};
+
+	string_view chain_event_key(const mutable_buffer &out, const uint64_t &chain, const uint64_t &seq);
+	string_view chain_event_key(const mutable_buffer &out, const uint64_t &chain);
+	uint64_t chain_event_key(const string_view &amalgam);
+
+	bool event_chain_get(const event::idx &, const event_chain_closure &, const write_opts * = nullptr);
+
+	void _index_event_chain(db::txn &, const event &, const write_opts &);
+
+	// event_idx => chain, seq, (chain, seq)...
+	extern db::column event_chain;
+
+	// chain | seq => event_idx
+	extern db::domain chain_event;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> event_chain__comp;
+	extern conf::item<size_t> event_chain__block__size;
+	extern conf::item<size_t> event_chain__meta_block__size;
+	extern conf::item<size_t> event_chain__cache__size;
+	extern conf::item<size_t> event_chain__cache_comp__size;
+	extern const db::descriptor event_chain;
+
+	extern conf::item<std::string> chain_event__comp;
+	extern conf::item<size_t> chain_event__block__size;
+	extern conf::item<size_t> chain_event__meta_block__size;
+	extern conf::item<size_t> chain_event__cache__size;
+	extern conf::item<size_t> chain_event__cache_comp__size;
+	extern const db::prefix_transform chain_event__pfx;
+	extern const db::comparator chain_event__cmp;
+	extern const db::descriptor chain_event;
+}
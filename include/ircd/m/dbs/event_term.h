@@ -0,0 +1,52 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_EVENT_TERM_H
+
+namespace ircd::m::dbs
+{
+	using event_term_closure = std::function<bool (const string_view &, const uint16_t &)>;
+
+	constexpr size_t EVENT_TERM_MAX_SIZE
+	{
+		48
+	};
+
+	constexpr size_t EVENT_TERM_KEY_MAX_SIZE
+	{
+		EVENT_TERM_MAX_SIZE + 1 + id::MAX_SIZE + 1 + 8
+	};
+
+	// Tokenizer; closure receives each distinct normalized term and its
+	// frequency in the input text. Shared by the indexer and the query side.
+	bool event_term_for_each(const string_view &text, const event_term_closure &);
+
+	string_view event_term_key(const mutable_buffer &out, const string_view &term, const id::room &, const event::idx & = 0UL);
+	string_view event_term_key(const mutable_buffer &out, const string_view &term);
+	std::tuple<string_view, event::idx> event_term_key(const string_view &amalgam);
+
+	void _index_event_term(db::txn &, const event &, const write_opts &);
+
+	// term | room_id, ~event_idx => frequency
+	extern db::domain event_term;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> event_term__comp;
+	extern conf::item<size_t> event_term__block__size;
+	extern conf::item<size_t> event_term__meta_block__size;
+	extern conf::item<size_t> event_term__cache__size;
+	extern conf::item<size_t> event_term__cache_comp__size;
+	extern conf::item<size_t> event_term__terms__max;
+	extern const db::prefix_transform event_term__pfx;
+	extern const db::descriptor event_term;
+}
@@ -0,0 +1,47 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_ROOM_COUNT_H
+
+namespace ircd::m::dbs
+{
+	constexpr size_t ROOM_COUNT_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE                   // room_id
+		+ 1                            // \0
+		+ event::TYPE_MAX_SIZE         // type
+		+ 1                            // \0
+		+ 8                            // u64
+	};
+
+	event::idx room_count_key(const string_view &amalgam);
+	string_view room_count_key(const mutable_buffer &out, const id::room &, const string_view &type, const event::idx &);
+	string_view room_count_key(const mutable_buffer &out, const id::room &, const string_view &type = {});
+
+	bool room_count_rank(uint64_t &ret, const id::room &, const string_view &type, const event::idx &);
+	bool room_count_range(size_t &ret, const id::room &, const string_view &type, const event::idx_range &);
+
+	void _index_room_count(db::txn &, const event &, const write_opts &);
+
+	// room_id, type | event_idx => rank
+	extern db::domain room_count;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> room_count__comp;
+	extern conf::item<size_t> room_count__block__size;
+	extern conf::item<size_t> room_count__meta_block__size;
+	extern conf::item<size_t> room_count__cache__size;
+	extern conf::item<size_t> room_count__cache_comp__size;
+	extern const db::prefix_transform room_count__pfx;
+	extern const db::descriptor room_count;
+}
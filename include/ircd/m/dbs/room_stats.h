@@ -0,0 +1,50 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_ROOM_STATS_H
+
+namespace ircd::m::dbs
+{
+	constexpr size_t ROOM_STATS_NAME_MAX_SIZE
+	{
+		32
+	};
+
+	constexpr size_t ROOM_STATS_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE                   // room_id
+		+ 1                            // \0
+		+ ROOM_STATS_NAME_MAX_SIZE     // counter
+		+ 1                            // \0
+		+ rfc3986::DOMAIN_BUFSIZE      // host
+	};
+
+	std::tuple<string_view, string_view> room_stats_key(const string_view &amalgam);
+	string_view room_stats_key(const mutable_buffer &out, const id::room &, const string_view &name, const string_view &host = {});
+	string_view room_stats_key(const mutable_buffer &out, const id::room &);
+	string_view room_stats_member(const mutable_buffer &out, const string_view &membership);
+
+	void _index_room_stats(db::txn &, const event &, const write_opts &);
+
+	// room_id | counter, host => int64
+	extern db::domain room_stats;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> room_stats__comp;
+	extern conf::item<size_t> room_stats__block__size;
+	extern conf::item<size_t> room_stats__meta_block__size;
+	extern conf::item<size_t> room_stats__cache__size;
+	extern conf::item<size_t> room_stats__cache_comp__size;
+	extern const db::prefix_transform room_stats__pfx;
+	extern const db::descriptor room_stats;
+}
@@ -0,0 +1,43 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_USER_TOUCH_H
+
+namespace ircd::m::dbs
+{
+	constexpr size_t USER_TOUCH_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE + 1 + id::MAX_SIZE
+	};
+
+	string_view user_touch_key(const mutable_buffer &out, const id::user &, const id::room &);
+	string_view user_touch_key(const mutable_buffer &out, const id::user &);
+	string_view user_touch_key(const string_view &amalgam);
+
+	void _index_user_touch(db::txn &, const event &, const write_opts &);
+
+	// The index is only maintained while its reader is enabled.
+	extern conf::item<bool> user_touch_enable;
+
+	// user_id | room_id => event_idx
+	extern db::domain user_touch;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> user_touch__comp;
+	extern conf::item<size_t> user_touch__block__size;
+	extern conf::item<size_t> user_touch__meta_block__size;
+	extern conf::item<size_t> user_touch__cache__size;
+	extern conf::item<size_t> user_touch__cache_comp__size;
+	extern const db::prefix_transform user_touch__pfx;
+	extern const db::descriptor user_touch;
+}
@@ -53,6 +53,7 @@ namespace ircd::m
 	bool verify(const event &, const string_view &origin, const string_view &pkid); // io/yield
 	bool verify(const event &, const string_view &origin); // io/yield
 	bool verify(const event &); // io/yield
+	uint64_t verify(const vector_view<const event> &, const uint64_t &mask = -1UL); // io/yield
 
 	sha256::buf hash(const event &);
 	ed25519::sig sign(const event &, const ed25519::sk &);
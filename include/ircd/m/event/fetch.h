@@ -42,6 +42,7 @@ struct ircd::m::event::fetch
 :event
 {
 	struct opts;
+	struct batch;
 
 	using keys = event::keys;
 	using view_closure = std::function<void (const string_view &)>;
@@ -110,3 +111,43 @@ struct ircd::m::event::fetch::opts
 	opts(const db::gopts &, const event::keys::selection & = {});
 	opts() noexcept;
 };
+
+/// Batched Event Fetcher (local).
+///
+/// Populates an m::event for each of a set of event::idx. In contrast to
+/// constructing an event::fetch for each, the events are queried together:
+/// one parallel query (MultiGet) for each column involved, with the keys
+/// sorted, rather than a full round of point lookups per event. This suits
+/// pagination and serialization of many events at once.
+///
+/// The query type (row or JSON) is chosen by the options the same way as
+/// event::fetch. The results are copied into a buffer held by this object;
+/// the events presented are valid until the next query with this object,
+/// which reuses the allocations of the last.
+///
+struct ircd::m::event::fetch::batch
+{
+	using closure = std::function<bool (const event::idx &, const m::event &)>;
+
+	const opts *fopts {&default_opts};
+	std::vector<event::idx> idx;             // sorted and unique
+	std::vector<m::event> events;            // parallel to idx
+	std::vector<bool> valid;                 // parallel to idx
+	std::vector<std::pair<size_t, size_t>> val;
+	std::string buf;
+
+	size_t query(db::column &, std::pair<size_t, size_t> *const &);
+	string_view value(const std::pair<size_t, size_t> &) const;
+	void query_json();
+	void query_row();
+
+  public:
+	const m::event *find(const event::idx &) const;
+	bool for_each(const closure &) const;
+	size_t count() const;
+
+	size_t operator()(const vector_view<const event::idx> &);
+
+	batch(const vector_view<const event::idx> &, const opts & = default_opts);
+	batch(const opts & = default_opts);
+};
@@ -19,11 +19,19 @@ namespace ircd::m::media
 namespace ircd::m::media::file
 {
 	using closure = std::function<void (const const_buffer &)>;
+	using head_closure = std::function<void (const size_t &size, const string_view &content_type)>;
+
+	// All blocks of a file are this size except the last.
+	constexpr const size_t block_size
+	{
+		32_KiB
+	};
 
 	room::id room_id(room::id::buf &out, const mxc &);
 	room::id::buf room_id(const mxc &);
 
 	size_t read(const room &, const closure &);
+	size_t read(const room &, const std::pair<size_t, size_t> &range, const closure &);
 	size_t write(const room &, const user::id &, const const_buffer &content, const string_view &content_type);
 
 	room::id::buf
@@ -42,6 +50,18 @@ namespace ircd::m::media::file
 	         const m::user::id &user_id,
 	         const m::room::id &room_id,
 	         string_view remote = {});
+
+	// Downloads the remote file as above while presenting it to the closures
+	// as it arrives: the head closure once, then each block. Requests for a
+	// file already being downloaded follow that download. False when nothing
+	// was presented (the file is local or stored, or its size is not known
+	// in advance); the file is then read from its room.
+	bool
+	stream(const mxc &mxc,
+	       const m::user::id &user_id,
+	       const head_closure &,
+	       const closure &,
+	       string_view remote = {});
 };
 
 namespace ircd::m::media::block
@@ -70,6 +70,14 @@ struct ircd::m::push::match
 struct ircd::m::push::match::opts
 {
 	m::id::user user_id;
+
+	/// Index of the event's content, when the caller matches many rules
+	/// against the same event; otherwise the content is parsed for each.
+	const json::object::tape *content {nullptr};
+
+	/// The user's displayname, when the caller already has it (empty when
+	/// the user has none); otherwise the profile is queried for each rule.
+	const std::string *displayname {nullptr};
 };
 
 /// 13.13.1 I'm your pusher, baby.
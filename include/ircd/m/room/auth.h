@@ -76,8 +76,11 @@ struct ircd::m::room::auth::chain
   public:
 	bool for_each(const closure &) const;
 	bool has(const string_view &type) const;
+	bool has(const event::idx &) const;
 	size_t depth() const;
 
+	static size_t rebuild();
+
 	chain(const event::idx &idx)
 	:idx{idx}
 	{}
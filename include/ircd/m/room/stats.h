@@ -11,11 +11,29 @@
 #pragma once
 #define HAVE_IRCD_M_ROOM_STATS_H
 
+/// Counters of the room_stats column. Those which can't be answered by the
+/// counters, i.e. rooms older than the column until rebuilt, are computed by
+/// iterating the room.
 struct ircd::m::room::stats
 {
+	struct rebuild;
+
+	static bool complete(const m::room &);
+	static bool get(int64_t &, const m::room &, const string_view &name, const string_view &host = {});
+	static bool members(size_t &, const m::room &, const string_view &membership, const string_view &host = {});
+	static size_t events(const m::room &);
+
 	static size_t bytes_json_compressed(const m::room &);
 	static size_t bytes_json(const m::room &);
 
 	static size_t bytes_total_compressed(const m::room &);
 	static size_t bytes_total(const m::room &);
 };
+
+/// Recount the counters of a room from its events and present state, which
+/// then marks them complete. All evals are held off for the duration (see
+/// vm::sequence::hold), which is a scan of the room.
+struct ircd::m::room::stats::rebuild
+{
+	rebuild(const room::id &);
+};
@@ -16,6 +16,19 @@ namespace ircd::m::search
 	struct query;
 	struct result;
 	struct room_events;
+
+	// (room_id, event_idx, rank)
+	using closure = std::function<bool (const room::id &, const event::idx &, const long &)>;
+
+	// Iterate the events matching all terms of the search string using the
+	// inverted index. When a room_id is given the iteration is confined to
+	// that room, otherwise all rooms are iterated. Results for each room are
+	// presented newest first; the rank is the sum of the term frequencies.
+	bool for_each(const string_view &search_term, const room::id &, const closure &);
+	bool for_each(const string_view &search_term, const closure &);
+
+	// Build the inverted index over existing events
+	void rebuild();
 }
 
 struct ircd::m::search::room_events
@@ -74,3 +87,10 @@ struct ircd::m::search::result
 	event::idx event_idx {0UL};
 	long rank {0L};
 };
+
+inline bool
+ircd::m::search::for_each(const string_view &search_term,
+                          const closure &closure)
+{
+	return for_each(search_term, room::id{}, closure);
+}
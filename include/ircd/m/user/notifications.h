@@ -24,6 +24,8 @@ struct ircd::m::user::notifications
 
 	m::user user;
 
+	bool count_indexed(size_t &, const opts &) const;
+
   public:
 	bool for_each(const opts &, const closure_meta &) const;
 	bool for_each(const opts &, const closure &) const;
@@ -18,6 +18,7 @@ struct ircd::m::user::rooms
 
 	using closure = std::function<void (const m::room &, const string_view &)>;
 	using closure_bool = std::function<bool (const m::room &, const string_view &)>;
+	using closure_touched = std::function<bool (const room::id &, const event::idx &)>;
 
 	m::user user;
 
@@ -33,6 +34,13 @@ struct ircd::m::user::rooms
 	size_t count(const string_view &membership) const;
 	size_t count() const;
 
+	// Rooms concerning the user with an event at or after event_idx; the
+	// last such event is given. Requires the user_touch index to be built.
+	bool for_each_touched(const event::idx &, const closure_touched &) const;
+
+	// Build the user_touch index for all local users from the present heads
+	static size_t rebuild_touched();
+
 	rooms(const m::user &user)
 	:user{user}
 	{}
@@ -105,6 +105,11 @@ struct ircd::m::vm::opts
 	/// perform a parallel/mass fetch before proceeding with the evals.
 	bool mfetch_keys {true};
 
+	/// Whether to verify the signatures for an input vector of events as a
+	/// batch, offloaded to other threads, before proceeding with the evals.
+	/// Events failing the batch are verified again individually.
+	bool mverify {true};
+
 	/// Whether to launch prefetches for all event_id's (found at standard
 	/// locations) from the input vector, in addition to some other related
 	/// local db prefetches. Disabled by default because it operates prior
@@ -13,10 +13,14 @@
 
 namespace ircd::m::vm::sequence
 {
+	struct hold;
+
 	extern ctx::dock dock;
 	extern uint64_t retired;      // already written; always monotonic
 	extern uint64_t committed;    // pending write; usually monotonic
 	extern uint64_t uncommitted;  // evaluating; not monotonic
+	extern size_t committing;     // evals past the commit phase wait
+	extern bool held;             // commit phase is held off
 	static size_t pending;
 
 	const uint64_t &get(const eval &);
@@ -25,3 +29,15 @@ namespace ircd::m::vm::sequence
 	uint64_t max();
 	uint64_t min();
 }
+
+/// Holds evals off at the commit phase and waits for any eval already past
+/// it to retire. Maintenance writing to the indexes the evals compose
+/// against (e.g. a rebuild) can then query and commit without racing them.
+/// Holds are exclusive; keep them short as all evaluation stalls meanwhile.
+struct ircd::m::vm::sequence::hold
+{
+	hold();
+	hold(hold &&) = delete;
+	hold(const hold &) = delete;
+	~hold() noexcept;
+};
@@ -37,6 +37,7 @@ struct ircd::net::acceptor
 	static conf::item<std::string> ssl_curve_list;
 	static conf::item<std::string> ssl_cipher_list;
 	static conf::item<std::string> ssl_cipher_blacklist;
+	static conf::item<bool> alpn_h2;
 
 	net::listener *listener_;
 	std::string name;
@@ -102,6 +102,11 @@ struct ircd::net::open_opts
 	/// been set. If true, it will be sent regardless.
 	bool send_sni { true };
 
+	/// Protocols offered to the remote by ALPN in order of preference; none
+	/// are offered if empty. The protocol selected by the remote is found in
+	/// socket::alpn after the handshake. The strings must outlive the open.
+	vector_view<const string_view> alpn;
+
 	/// Option to toggle whether to allow self-signed certificates. This
 	/// currently defaults to true to not break Matrix development but will
 	/// likely change later and require setting to true for specific conns.
@@ -21,14 +21,20 @@ namespace ircd::server
 ///
 struct ircd::server::link
 {
+	struct h2;
+
 	static conf::item<size_t> tag_max_default;
 	static conf::item<size_t> tag_commit_max_default;
+	static conf::item<bool> h2_enable;
+	static conf::item<size_t> h2_tag_commit_max;
+	static conf::item<size_t> h2_stack_size;
 	static uint64_t ids;
 
 	uint64_t id {++ids};                         ///< unique identifier of link.
 	server::peer *peer;                          ///< backreference to peer
 	std::shared_ptr<net::socket> socket;         ///< link's socket
 	std::list<tag> queue;                        ///< link's work queue
+	std::shared_ptr<struct h2> h2;               ///< multiplexing when negotiated
 	size_t tag_done {0L};                        ///< total tags processed
 	time_t synack_ts {0L};                       ///< time socket was estab
 	time_t read_ts {0L};                         ///< time of last read
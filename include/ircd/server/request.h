@@ -33,6 +33,7 @@ namespace ircd::server
 	// control panel
 	void submit(const hostport &, request &);
 	bool cancel(request &);
+	bool pause(request &, const bool &paused = true);
 }
 
 /// Request data and options related to transmitting the request. This
@@ -181,6 +182,15 @@ struct ircd::server::request::opts
 	/// when false an overflow is an error and an exception is set so the
 	/// user does not process incomplete content.
 	bool truncate_content {false};
+
+	/// When true, a content buffer smaller than the content-length is reused
+	/// as a window: once it fills, reception continues from its start again
+	/// and the request completes without error. The progress callback must
+	/// consume the content as it arrives; in.content only holds the last
+	/// window when the request completes. A chunked encoded response cannot
+	/// be framed this way and is received into dynamic chunks instead, which
+	/// remain in the chunks vector.
+	bool content_window {false};
 };
 
 inline
@@ -39,6 +39,7 @@ struct ircd::server::tag
 		size_t chunk_read {0};         // content read after last chunk head
 		size_t chunk_length {0};       // -1 for chunk header mode
 		http::code status {(http::code)0};
+		bool paused {false};           // reception held by the user
 	}
 	state;
 	ctx::promise<http::code> p;
@@ -0,0 +1,59 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_SIMD_MOVEMASK_H
+
+namespace ircd::simd
+{
+	template<class T> u64 movemask(const T) noexcept;
+}
+
+/// Collects the most significant bit of each byte of the vector into an
+/// integer; byte 0 becomes bit 0. Vectors of comparison results (lanes all
+/// ones or all zeroes) become bitmaps this way. The vector is at most 64
+/// bytes. Scalar unless a specialization exists for the target.
+template<class T>
+inline ircd::u64
+ircd::simd::movemask(const T a)
+noexcept
+{
+	static_assert(sizeof(T) <= 64);
+	const auto b
+	{
+		reinterpret_cast<const u8 *>(&a)
+	};
+
+	u64 ret(0);
+	for(size_t i(0); i < sizeof(T); ++i)
+		ret |= u64(b[i] >> 7) << i;
+
+	return ret;
+}
+
+#if defined(HAVE_X86INTRIN_H) && defined(__SSE2__) && !defined(RB_GENERIC)
+template<>
+inline ircd::u64
+ircd::simd::movemask(const u8x16 a)
+noexcept
+{
+	return u16(_mm_movemask_epi8(__m128i(a)));
+}
+#endif
+
+#if defined(HAVE_X86INTRIN_H) && defined(__AVX2__) && !defined(RB_GENERIC)
+template<>
+inline ircd::u64
+ircd::simd::movemask(const u8x32 a)
+noexcept
+{
+	return u32(_mm256_movemask_epi8(__m256i(a)));
+}
+#endif
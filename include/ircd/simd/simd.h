@@ -30,6 +30,7 @@
 #include "popcnt.h"
 #include "lzcnt.h"
 #include "tzcnt.h"
+#include "movemask.h"
 #include "reduce.h"
 #include "any.h"
 #include "all.h"
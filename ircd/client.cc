@@ -336,6 +336,7 @@ namespace ircd
 	static bool handle_ec(client &, const error_code &);
 
 	static void handle_client_requests(std::shared_ptr<client>);
+	static void handle_client_resume(std::shared_ptr<client>, const std::function<bool (client &)> &);
 	static void handle_client_ready(std::shared_ptr<client>, const error_code &ec);
 }
 
@@ -463,6 +464,11 @@ try
 	};
 	#endif
 
+	// The request was parked by its handler; whoever holds it will resume()
+	// and the client goes back into async mode from there.
+	if(client->parked)
+		return;
+
 	client->async();
 }
 catch(const std::exception &e)
@@ -475,6 +481,88 @@ catch(const std::exception &e)
 	};
 }
 
+/// Continue a parked request on a context from the request pool. The closure
+/// completes the response; it returns false to disconnect the client like
+/// main(). Otherwise the client falls back to async mode for the next request.
+void
+ircd::client::resume(std::shared_ptr<client> client,
+                     std::function<bool (struct client &)> closure)
+{
+	assert(client);
+	assert(client->parked);
+	auto handler
+	{
+		std::bind(ircd::handle_client_resume, std::move(client), std::move(closure))
+	};
+
+	client::pool(std::move(handler));
+}
+
+void
+ircd::handle_client_resume(std::shared_ptr<client> client,
+                           const std::function<bool (struct client &)> &closure)
+try
+{
+	assert(ctx::current);
+	assert(!client->reqctx);
+	assert(client->parked);
+	client->reqctx = ctx::current;
+	client->parked = false;
+	client->ready_count++;
+	const unwind reset{[&client]
+	{
+		assert(bool(client));
+		assert(client->reqctx == ctx::current);
+		client->reqctx = nullptr;
+		if(client::pool.avail() <= 1)
+			client::dock.notify_all();
+	}};
+
+	// Nothing has been read past the parked request, so the closure may park
+	// it again.
+	const scope_restore parkable
+	{
+		client->parkable, true
+	};
+
+	if(!closure(*client))
+	{
+		client->close(net::dc::SSL_NOTIFY).wait();
+		return;
+	}
+
+	if(client->parked)
+		return;
+
+	client->async();
+}
+catch(const std::system_error &e)
+{
+	handle_ec(*client, e.code());
+}
+catch(const ctx::interrupted &e)
+{
+	log::warning
+	{
+		client::log, "%s resume interrupted :%s",
+		client->loghead(),
+		e.what()
+	};
+
+	client->close(net::dc::SSL_NOTIFY, net::close_ignore);
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		client::log, "%s resume fault :%s",
+		client->loghead(),
+		e.what()
+	};
+
+	client->close(net::dc::SSL_NOTIFY, net::close_ignore);
+}
+
 bool
 ircd::handle_ec(client &client,
                 const error_code &ec)
@@ -619,6 +707,643 @@ ircd::handle_ec_default(client &client,
 	return false;
 }
 
+//
+// HTTP/2
+//
+
+/// HTTP/2 state of the connection, created by the client which accepted the
+/// socket and shared with the clients of its streams. Each stream is handled
+/// by its own ircd::client on its own context, so the resource layer sees the
+/// same interface it does with HTTP/1.1; only the framing differs.
+struct ircd::client::h2
+:http2::conn
+{
+	struct stream;
+
+	static ios::descriptor timeout_desc;
+
+	std::map<uint32_t, std::shared_ptr<stream>> active;
+	uint32_t continuation {0};               // stream awaiting CONTINUATION
+
+	void remove(stream &) noexcept;
+	void dispatch(client &, stream &);
+	void handle_head(client &, stream &);
+
+	using http2::conn::conn;
+};
+
+struct ircd::client::h2::stream
+:http2::stream
+{
+	std::shared_ptr<ircd::client> client;
+	boost::asio::deadline_timer timer {ios::get()};
+	size_t content_max {0};
+	size_t received {0};
+	bool dispatched {false};
+	bool responded {false};                  // HEADERS were sent
+	bool reset {false};                      // RST_STREAM is to be sent
+
+	using http2::stream::stream;
+};
+
+namespace ircd
+{
+	static size_t write_stream(client &, const net::const_buffers &);
+	static void handle_client_stream(std::shared_ptr<client>, std::shared_ptr<client::h2::stream>);
+}
+
+decltype(ircd::client::h2::timeout_desc)
+ircd::client::h2::timeout_desc
+{
+	"ircd.client.h2.timeout"
+};
+
+/// HTTP/2 counterpart to main(). Frames are read and handled until no input
+/// remains buffered, then the client falls back to async mode exactly as it
+/// does between HTTP/1.1 requests. Requests are handled on contexts of their
+/// own and are not waited on here, so an idle connection holds no stack
+/// even while its streams are still being answered.
+bool
+ircd::client::main_h2()
+try
+{
+	if(!h2)
+	{
+		const net::scope_timeout timeout
+		{
+			*sock, conf->request_timeout
+		};
+
+		char preface[24];
+		assert(size(http2::connection_preface) == sizeof(preface));
+		net::read_all(*sock, mutable_buffer{preface, sizeof(preface)});
+		if(unlikely(string_view(preface, sizeof(preface)) != http2::connection_preface))
+			throw http2::error
+			{
+				http2::error::PROTOCOL_ERROR, "invalid connection preface"
+			};
+
+		h2 = std::make_shared<struct h2>(sock);
+		h2->write_settings();
+	}
+
+	do
+	{
+		// This timeout only covers the reception of a frame which has begun
+		// to arrive; the wait for a new frame happens in async mode.
+		const net::scope_timeout timeout
+		{
+			*sock, conf->request_timeout
+		};
+
+		http2::frame::header header;
+		const const_buffer payload
+		{
+			h2->read(header)
+		};
+
+		if(!handle_frame(header, payload))
+			return false;
+	}
+	while(h2->buffered());
+
+	return true;
+}
+catch(const http2::error &e)
+{
+	log::derror
+	{
+		log, "%s HTTP/2 :%s",
+		loghead(),
+		e.what()
+	};
+
+	if(h2 && sock && !sock->fini) try
+	{
+		h2->write_goaway(e.code);
+	}
+	catch(...) {}
+
+	if(h2)
+		h2->close();
+
+	close(net::dc::SSL_NOTIFY, net::close_ignore);
+	return false;
+}
+catch(const std::system_error &e)
+{
+	if(h2)
+		h2->close();
+
+	return handle_ec(*this, e.code());
+}
+catch(const ctx::interrupted &e)
+{
+	log::warning
+	{
+		log, "%s HTTP/2 interrupted :%s",
+		loghead(),
+		e.what()
+	};
+
+	if(h2)
+		h2->close();
+
+	close(net::dc::SSL_NOTIFY, net::close_ignore);
+	return false;
+}
+catch(const std::exception &e)
+{
+	log::critical
+	{
+		log, "%s HTTP/2 :%s",
+		loghead(),
+		e.what()
+	};
+
+	if(h2)
+		h2->close();
+
+	close(net::dc::RST, net::close_ignore);
+	return false;
+}
+catch(const ctx::terminated &)
+{
+	if(h2)
+		h2->close();
+
+	close(net::dc::RST, net::close_ignore);
+	throw;
+}
+
+/// Handle a frame for a stream. Connection errors are thrown as http2::error
+/// and answered with GOAWAY by main_h2(); stream errors are answered here.
+bool
+ircd::client::handle_frame(const http2::frame::header &header,
+                           const const_buffer &payload)
+{
+	using http2::frame;
+	using http2::error;
+
+	assert(h2);
+	auto &h2(*this->h2);
+
+	// A header block is contiguous on the connection.
+	if(unlikely(h2.continuation))
+		if(header.type != frame::type::CONTINUATION || header.stream_id != h2.continuation)
+			throw error
+			{
+				error::PROTOCOL_ERROR, "expected CONTINUATION of stream %u",
+				h2.continuation,
+			};
+
+	if(h2.handle(header, payload))
+		return true;
+
+	const auto it
+	{
+		h2.active.find(header.stream_id)
+	};
+
+	const auto stream
+	{
+		it != end(h2.active)? it->second: nullptr
+	};
+
+	switch(header.type)
+	{
+		case frame::type::HEADERS:
+		{
+			// Trailers are only accepted to end the request; they are decoded
+			// to keep the compression state but otherwise ignored.
+			if(stream && (stream->remote_closed() || ~header.flags & frame::flag::END_STREAM))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "unexpected HEADERS on stream %u",
+					uint(header.stream_id),
+				};
+
+			if(!stream && (~header.stream_id & 1 || header.stream_id <= h2.last_id))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "invalid stream %u for HEADERS",
+					uint(header.stream_id),
+				};
+
+			auto s{stream};
+			if(!s)
+			{
+				h2.last_id = header.stream_id;
+				s = std::make_shared<h2::stream>(header.stream_id);
+				s->reset = h2.active.size() >= size_t(http2::conn::streams_max);
+				h2.active.emplace(s->id, s);
+				h2.add(*s);
+			}
+
+			const const_buffer fragment
+			{
+				http2::conn::payload(header, payload)
+			};
+
+			s->block.append(data(fragment), size(fragment));
+			if(header.flags & frame::flag::END_STREAM)
+				s->state = http2::stream::state::HALF_CLOSED_REMOTE;
+
+			if(~header.flags & frame::flag::END_HEADERS)
+			{
+				h2.continuation = s->id;
+				return true;
+			}
+
+			h2.handle_head(*this, *s);
+			return true;
+		}
+
+		case frame::type::CONTINUATION:
+		{
+			if(unlikely(!stream || h2.continuation != header.stream_id))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "unexpected CONTINUATION on stream %u",
+					uint(header.stream_id),
+				};
+
+			if(unlikely(size(stream->block) + size(payload) > size_t(http2::conn::head_max) * 2))
+				throw error
+				{
+					error::ENHANCE_YOUR_CALM, "header block on stream %u too large",
+					uint(header.stream_id),
+				};
+
+			stream->block.append(data(payload), size(payload));
+			if(~header.flags & frame::flag::END_HEADERS)
+				return true;
+
+			h2.continuation = 0;
+			h2.handle_head(*this, *stream);
+			return true;
+		}
+
+		case frame::type::DATA:
+		{
+			// DATA in flight for a stream we already finished or reset is
+			// dropped; its flow control was accounted by the conn.
+			if(!stream && header.stream_id && header.stream_id <= h2.last_id)
+				return true;
+
+			if(unlikely(!stream || stream->remote_closed() || !empty(stream->block)))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "unexpected DATA on stream %u",
+					uint(header.stream_id),
+				};
+
+			const const_buffer content
+			{
+				http2::conn::payload(header, payload)
+			};
+
+			stream->received += size(content);
+			if(stream->received <= stream->content_max)
+				stream->content.append(data(content), size(content));
+
+			if(~header.flags & frame::flag::END_STREAM)
+				return true;
+
+			stream->state = http2::stream::state::HALF_CLOSED_REMOTE;
+			if(!stream->reset)
+				h2.dispatch(*this, *stream);
+
+			return true;
+		}
+
+		case frame::type::RST_STREAM:
+		{
+			if(!stream)
+				return true;
+
+			if(stream->client && stream->client->reqctx)
+				ctx::interrupt(*stream->client->reqctx);
+
+			if(!stream->dispatched)
+				h2.remove(*stream);
+
+			return true;
+		}
+
+		case frame::type::PUSH_PROMISE:
+			throw error
+			{
+				error::PROTOCOL_ERROR, "PUSH_PROMISE from client"
+			};
+
+		default:
+			return true;
+	}
+}
+
+void
+ircd::client::h2::handle_head(client &client,
+                              stream &stream)
+{
+	// The block was sent after the request was complete; trailer fields.
+	if(!empty(stream.head))
+	{
+		http2::stream trailer;
+		read_head(trailer, string_view(stream.block));
+		stream.block.clear();
+		if(!stream.reset)
+			dispatch(client, stream);
+
+		return;
+	}
+
+	const bool valid
+	{
+		read_head(stream, string_view(stream.block))
+	};
+
+	stream.block.clear();
+	stream.block.shrink_to_fit();
+	if(stream.reset || !valid)
+	{
+		write_rst_stream(stream, stream.reset? http2::error::REFUSED_STREAM: http2::error::PROTOCOL_ERROR);
+		remove(stream);
+		return;
+	}
+
+	// Content is buffered in full before dispatch; beyond the method's limit
+	// it is counted but not kept, and the declared length will draw a 413.
+	const string_view &line
+	{
+		split(string_view(stream.head), "\r\n").first
+	};
+
+	stream.content_max = resource::method::default_payload_max;
+	try
+	{
+		const auto &method(resource::find(split(token(line, ' ', 1), '?').first)[token(line, ' ', 0)]);
+		if(method.opts->payload_max != -1UL)
+			stream.content_max = method.opts->payload_max;
+	}
+	catch(const http::error &)
+	{
+		// The handler will answer for any missing resource or method.
+	}
+
+	if(stream.remote_closed())
+		dispatch(client, stream);
+}
+
+/// The request on the stream is complete. A client for it is composed with
+/// the head and content contiguous in its head_buffer as if it had been read
+/// off the socket, and it is submitted to the request pool.
+void
+ircd::client::h2::dispatch(client &client,
+                           stream &stream)
+{
+	assert(!stream.dispatched);
+	assert(stream.remote_closed());
+
+	string_view declared;
+	tokens(stream.head, "\r\n", [&declared]
+	(const string_view &line)
+	{
+		const auto &[key, val](split(line, ':'));
+		if(iequals(key, "content-length"_sv))
+			declared = strip(val, ' ');
+	});
+
+	if(declared && lex_cast<size_t>(declared) != stream.received)
+	{
+		write_rst_stream(stream, http2::error::PROTOCOL_ERROR);
+		remove(stream);
+		return;
+	}
+
+	char lenbuf[64];
+	const string_view length
+	{
+		declared?
+			string_view{}:
+			fmt::sprintf
+			{
+				lenbuf, "content-length: %zu\r\n", stream.received
+			}
+	};
+
+	const auto sc
+	{
+		std::make_shared<ircd::client>(client.sock)
+	};
+
+	sc->conf = client.conf;
+	sc->h2 = client.h2;
+	sc->stream = &stream;
+	sc->head_buffer = unique_buffer<mutable_buffer>
+	{
+		size(stream.head) + size(length) + 2 + size(stream.content)
+	};
+
+	mutable_buffer buf(sc->head_buffer);
+	consume(buf, copy(buf, string_view(stream.head)));
+	consume(buf, copy(buf, length));
+	consume(buf, copy(buf, "\r\n"_sv));
+	consume(buf, copy(buf, string_view(stream.content)));
+	assert(empty(buf));
+
+	stream.head = {};
+	stream.content = {};
+	stream.client = sc;
+	stream.dispatched = true;
+
+	auto handler
+	{
+		std::bind(ircd::handle_client_stream, sc, active.at(stream.id))
+	};
+
+	client::pool(std::move(handler));
+}
+
+void
+ircd::client::h2::remove(stream &stream)
+noexcept
+{
+	assert(!stream.client);
+	del(stream);
+	active.erase(stream.id);
+}
+
+/// A stream's request is handled on this context. Its timeout is kept on the
+/// stream rather than the socket, which is shared by the other streams.
+void
+ircd::handle_client_stream(std::shared_ptr<client> client,
+                           std::shared_ptr<client::h2::stream> stream)
+{
+	assert(ctx::current);
+	assert(client->h2);
+	assert(client->stream == stream.get());
+	client->reqctx = ctx::current;
+	client->ready_count++;
+	const unwind release{[&client, &stream]
+	{
+		stream->timer.cancel();
+		stream->client.reset();
+		client->h2->remove(*stream);
+		client->reqctx = nullptr;
+		client->stream = nullptr;
+	}};
+
+	if(stream->closed())
+		return;
+
+	try
+	{
+		const string_view &line
+		{
+			split(string_view(data(client->head_buffer), size(client->head_buffer)), "\r\n").first
+		};
+
+		resource::method *method(nullptr); try
+		{
+			method = &resource::find(split(token(line, ' ', 1), '?').first)[token(line, ' ', 0)];
+		}
+		catch(const http::error &) {}
+
+		if(method)
+		{
+			const auto &timeout
+			{
+				method->opts->timeout != 0s?
+					method->opts->timeout:
+					seconds(resource::method::default_timeout)
+			};
+
+			stream->timer.expires_from_now(boost::posix_time::milliseconds(duration_cast<milliseconds>(timeout).count()));
+			stream->timer.async_wait(ios::handle(client::h2::timeout_desc, [client, method]
+			(const boost::system::error_code &ec)
+			{
+				if(!ec && client->stream)
+					method->handle_timeout(*client);
+			}));
+		}
+
+		parse::buffer pb
+		{
+			const_buffer{client->head_buffer}
+		};
+
+		parse::capstan pc{pb, [](char *&, char *)
+		{
+			throw http::error
+			{
+				http::BAD_REQUEST, "Incomplete request on stream"
+			};
+		}};
+
+		client->handle_request(pc);
+	}
+	catch(const ctx::interrupted &e)
+	{
+		stream->reset = true;
+	}
+	catch(const std::exception &e)
+	{
+		log::derror
+		{
+			client::log, "%s stream :%s",
+			client->loghead(),
+			e.what()
+		};
+
+		stream->reset = true;
+	}
+
+	// The stream is finished here unless the peer reset it first or it was
+	// already ended by the content.
+	if(stream->closed())
+		return;
+
+	const ctx::exception_handler eh; try
+	{
+		if(stream->reset || !stream->responded)
+			client->h2->write_rst_stream(*stream, stream->responded?
+				http2::error::CANCEL:
+				http2::error::INTERNAL_ERROR);
+
+		else if(!stream->local_closed())
+			client->h2->write_data(*stream, {}, true);
+	}
+	catch(const std::exception &e)
+	{
+		log::derror
+		{
+			client::log, "%s stream finish :%s",
+			client->loghead(),
+			e.what()
+		};
+	}
+}
+
+/// Responses are composed by resource::response in HTTP/1.1 form. The first
+/// write to a stream is that head, translated here; everything after it is
+/// content. Chunked framing is never written to a stream (see chunked::write).
+size_t
+ircd::write_stream(client &client,
+                   const net::const_buffers &bufs)
+{
+	assert(client.h2);
+	assert(client.stream);
+	auto &h2(*client.h2);
+	auto &stream
+	{
+		static_cast<client::h2::stream &>(*client.stream)
+	};
+
+	if(unlikely(stream.reset))
+		throw http2::error
+		{
+			http2::error::STREAM_CLOSED, "stream %u was reset", stream.id
+		};
+
+	if(likely(stream.responded))
+		return h2.write_data(stream, bufs, false);
+
+	assert(!empty(bufs));
+	const string_view first
+	{
+		bufs[0]
+	};
+
+	const auto pos
+	{
+		first.find("\r\n\r\n")
+	};
+
+	if(unlikely(pos == first.npos))
+		throw http2::error
+		{
+			"response head on stream %u must be written whole", stream.id
+		};
+
+	h2.write_head(stream, first.substr(0, pos + 2), false);
+	stream.responded = true;
+
+	size_t ret(pos + 4);
+	const const_buffer rest[]
+	{
+		string_view(first.substr(pos + 4))
+	};
+
+	if(!empty(rest[0]))
+		ret += h2.write_data(stream, rest, false);
+
+	if(bufs.size() > 1)
+		ret += h2.write_data(stream, {bufs.data() + 1, bufs.size() - 1}, false);
+
+	return ret;
+}
+
 //
 // client
 //
@@ -691,12 +1416,20 @@ bool
 ircd::client::main()
 try
 {
+	if(h2 || string_view(sock->alpn) == "h2")
+		return main_h2();
+
 	parse::buffer pb{head_buffer};
 	parse::capstan pc{pb, read_closure(*this)}; do
 	{
 		if(!handle_request(pc))
 			return false;
 
+		// Nothing else can be read off the socket until the parked request
+		// has been resumed and completed.
+		if(parked)
+			return true;
+
 		// After the request, the head and content has been read off the socket
 		// and the capstan has advanced to the end of the content. The catch is
 		// that reading off the socket could have read too much, bleeding into
@@ -762,7 +1495,9 @@ try
 	// will block this request context below. The timeout limits that.
 	net::scope_timeout timeout
 	{
-		*sock, conf->request_timeout
+		!stream?
+			net::scope_timeout{*sock, conf->request_timeout}:
+			net::scope_timeout{}
 	};
 
 	// This is the first read off the wire. The headers are entirely read and
@@ -788,6 +1523,13 @@ try
 		content_consumed
 	};
 
+	// A request can only be parked when nothing after it has been read into
+	// the head buffer; the capstan does not outlive this context.
+	const scope_restore parkable
+	{
+		this->parkable, !stream && !pc.unparsed()
+	};
+
 	// Sets values in this->client::request based on everything we know from
 	// the head for this scope. This gets updated again in the resource::
 	// unit for their scope with more data including the content.
@@ -970,10 +1712,35 @@ catch(const std::exception &e)
 	return false;
 }
 
+/// Called by a resource handler to release this context and its stack for
+/// the remainder of the request. Returns false when the request can't be
+/// parked, in which case the handler proceeds as usual. Once parked, the
+/// handler returns without a response. The handler must keep the client's
+/// shared_ptr and later continue the response with client::resume(). The
+/// head of the request remains valid in the head_buffer meanwhile.
+bool
+ircd::client::park()
+{
+	assert(!parked);
+	if(!parkable || !sock || sock->fini)
+		return false;
+
+	// Content which hasn't been read must not be taken for the next request.
+	if(content_consumed != request.head.content_length)
+		return false;
+
+	if(iequals(request.head.connection, "close"_sv))
+		return false;
+
+	parked = true;
+	return true;
+}
+
 void
 ircd::client::discard_unconsumed(const http::request::head &head)
 {
-	if(unlikely(!sock))
+	// Content beyond what a stream buffered was never kept, not unread.
+	if(unlikely(!sock) || stream)
 		return;
 
 	const size_t unconsumed
@@ -996,9 +1763,17 @@ ircd::client::discard_unconsumed(const http::request::head &head)
 	assert(content_consumed == head.content_length);
 }
 
+/// For a client of an HTTP/2 stream only the stream is closed; it is reset
+/// once its context is done with it.
 ircd::ctx::future<void>
 ircd::client::close(const net::close_opts &opts)
 {
+	if(stream)
+	{
+		close(opts, net::close_ignore);
+		return ctx::already;
+	}
+
 	return likely(sock) && !sock->fini?
 		net::close(*sock, opts):
 		ctx::already;
@@ -1011,6 +1786,15 @@ ircd::client::close(const net::close_opts &opts,
 	if(!sock)
 		return;
 
+	if(stream)
+	{
+		static_cast<struct h2::stream *>(stream)->reset = true;
+		if(reqctx && reqctx != ctx::current)
+			ctx::interrupt(*reqctx);
+
+		return callback({});
+	}
+
 	if(sock->fini)
 		return callback({});
 
@@ -1032,6 +1816,9 @@ ircd::client::write_all(const net::const_buffers &bufs)
 			make_error_code(std::errc::not_connected)
 		};
 
+	if(stream)
+		return write_stream(*this, bufs);
+
 	return net::write_all(*sock, bufs);
 }
 
@@ -1046,8 +1833,11 @@ const
 {
 	thread_local char buf[512];
 
+	char alpnbuf[24];
 	const string_view alpn
 	{
+		sock && stream?
+			string_view(fmt::sprintf{alpnbuf, "%s/%u", sock->alpn, stream->id}):
 		sock?
 			sock->alpn:
 			nullptr
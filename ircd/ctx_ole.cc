@@ -28,9 +28,24 @@ decltype(ircd::ctx::ole::thread_max)
 ircd::ctx::ole::thread_max
 {
 	{ "name",     "ircd.ctx.ole.thread.max"  },
-	{ "default",  int64_t(1)                 },
+	{ "default",  int64_t(std::clamp(std::thread::hardware_concurrency() / 2U, 2U, 8U)) },
+	{ "description",
+
+	R"(
+	Number of offload threads. Every user of the offload engine shares this
+	pool (e.g. image processing and event signature verification), and the
+	concurrency limits of those users are bounded by it. Threads are started
+	on demand.
+	)"}
 };
 
+size_t
+ircd::ctx::ole::thread_count()
+noexcept
+{
+	return std::max(size_t(thread_max), 1UL);
+}
+
 ircd::ctx::ole::init::init()
 {
 	assert(threads.empty());
@@ -62,14 +77,16 @@ ircd::ctx::ole::offload::offload(const opts &opts,
                                  const function &func)
 {
 	assert(current);
-	assert(opts.concurrency == 1); // not yet implemented
+	assert(opts.concurrency >= 1);
 
 	// Prepare the offload package on our stack here. These objects will
-	// remain here for the duration of the offload.
-	latch latch{1};
+	// remain here for the duration of the offload. The closure is queued
+	// once for each unit of concurrency; the latch is hit by each.
+	latch latch(opts.concurrency);
+	std::mutex eptr_mutex;
 	std::exception_ptr eptr;
 	auto *const context(current);
-	auto closure{[&func, &latch, &eptr, &context]
+	auto closure{[&func, &latch, &eptr, &eptr_mutex, &context]
 	() noexcept
 	{
 		try
@@ -79,8 +96,15 @@ ircd::ctx::ole::offload::offload(const opts &opts,
 		catch(...)
 		{
 			// Note that the write to eptr is taking place on a different
-			// thread from where we created the eptr.
-			eptr = std::current_exception();
+			// thread from where we created the eptr. Only the first
+			// exception from any of the workers is propagated.
+			const std::lock_guard lock
+			{
+				eptr_mutex
+			};
+
+			if(!eptr)
+				eptr = std::current_exception();
 		}
 
 		// The ctx::signal() is a special device which executes the closure
@@ -101,7 +125,9 @@ ircd::ctx::ole::offload::offload(const opts &opts,
 	// capable of throwing an interrupt that was received during this scope.
 	const uninterruptible uninterruptible;
 
-	ole::push(std::move(closure));       // scope address required for clang-7
+	for(size_t i(0); i < opts.concurrency; ++i)
+		ole::push(offload::function{closure});
+
 	latch.wait();
 
 	// Don't throw any exception if there is a pending interrupt for this ctx.
@@ -1410,7 +1410,7 @@ const
 	return !for_each(*this, delta_closure_bool{[&op, &col]
 	(const auto &delta)
 	{
-		return std::get<delta::OP>(delta) != op &&
+		return std::get<delta::OP>(delta) != op ||
 		       std::get<delta::COL>(delta) != col;
 	}});
 }
@@ -1458,8 +1458,8 @@ const
 	return !for_each(*this, delta_closure_bool{[&op, &col, &key]
 	(const auto &delta)
 	{
-		return std::get<delta::OP>(delta) != op &&
-		       std::get<delta::COL>(delta) != col &&
+		return std::get<delta::OP>(delta) != op ||
+		       std::get<delta::COL>(delta) != col ||
 		       std::get<delta::KEY>(delta) != key;
 	}});
 }
@@ -1576,6 +1576,21 @@ ircd::db::txn::append::append(txn &t,
 	});
 }
 
+ircd::db::txn::append::append(txn &t,
+                              const txn &src)
+{
+	assert(bool(t.d));
+	assert(t.d == src.d);
+	for_each(src, delta_closure{[&t]
+	(const delta &delta)
+	{
+		append
+		{
+			t, *t.d, delta
+		};
+	}});
+}
+
 ircd::db::txn::append::append(txn &t,
                               const delta &delta)
 {
@@ -2929,6 +2944,65 @@ ircd::db::read(const columns &c,
 	return ret;
 }
 
+size_t
+ircd::db::read(column &column,
+               const keys &keys,
+               const read_closure &closure,
+               const gopts &opts)
+{
+	const columns columns
+	{
+		&column, 1
+	};
+
+	return read(columns, keys, closure, opts);
+}
+
+size_t
+ircd::db::read(const columns &c,
+               const keys &key,
+               const read_closure &closure,
+               const gopts &gopts)
+{
+	if(c.empty())
+		return 0UL;
+
+	const auto &num
+	{
+		key.size()
+	};
+
+	if(unlikely(!num || num > 64))
+		throw std::out_of_range
+		{
+			"db::read() :too many columns or vector size mismatch"
+		};
+
+	_read_op op[num];
+	for(size_t i(0); i < num; ++i)
+		op[i] =
+		{
+			c[std::min(c.size() - 1, i)], key[i]
+		};
+
+	size_t i(0), ret(0);
+	auto opts(make_opts(gopts));
+	_read({op, num}, opts, [&i, &ret, &closure]
+	(column &, const column::delta &d, const rocksdb::Status &s)
+	{
+		if(s.ok())
+		{
+			closure(i, std::get<column::delta::VAL>(d));
+			++ret;
+		}
+
+		++i;
+		return true;
+	});
+
+	return ret;
+}
+
 std::string
 ircd::db::read(column &column,
                const string_view &key,
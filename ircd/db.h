@@ -75,6 +75,12 @@ namespace ircd::db
 	extern conf::item<bool> read_checksum;
 	extern conf::item<size_t> request_pool_size;
 	extern conf::item<size_t> request_pool_stack_size;
+	extern conf::item<size_t> background_jobs;
+	extern conf::item<size_t> background_flushes;
+	extern conf::item<size_t> background_compactions;
+	extern conf::item<size_t> background_subcompactions;
+	extern conf::item<size_t> compaction_write_buffer;
+	extern conf::item<size_t> compaction_readahead;
 	extern ctx::pool::opts request_pool_opts;
 	extern ctx::pool request;
 
@@ -378,6 +384,7 @@ ircd::db::database::column final
 	comparator cmp;
 	prefix_transform prefix;
 	compaction_filter cfilter;
+	std::shared_ptr<struct database::mergeop> mergeop;
 	rocksdb::WriteStallCondition stall;
 	std::shared_ptr<struct database::stats> stats;
 	std::shared_ptr<struct database::allocator> allocator;
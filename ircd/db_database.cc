@@ -81,6 +81,55 @@ ircd::db::open_slave
 	{ "persist",  false                },
 };
 
+/// Limits on the concurrent background work of each database; these are the
+/// widths of the env pools. Applies on database open.
+decltype(ircd::db::background_jobs)
+ircd::db::background_jobs
+{
+	{ "name",     "ircd.db.background.jobs" },
+	{ "default",  16L                       },
+};
+
+decltype(ircd::db::background_flushes)
+ircd::db::background_flushes
+{
+	{ "name",     "ircd.db.background.flushes" },
+	{ "default",  8L                           },
+};
+
+decltype(ircd::db::background_compactions)
+ircd::db::background_compactions
+{
+	{ "name",     "ircd.db.background.compactions" },
+	{ "default",  4L                               },
+};
+
+decltype(ircd::db::background_subcompactions)
+ircd::db::background_subcompactions
+{
+	{ "name",     "ircd.db.background.subcompactions" },
+	{ "default",  1L                                  },
+};
+
+/// For the write-side of a compaction process: writes will be of approx
+/// this size. The compaction process is composing a buffer of this size
+/// between those writes. Too large a buffer will hog the CPU and starve
+/// other ircd::ctx's. Too small a buffer will be inefficient.
+decltype(ircd::db::compaction_write_buffer)
+ircd::db::compaction_write_buffer
+{
+	{ "name",     "ircd.db.compaction.write_buffer" },
+	{ "default",  long(2_MiB)                       },
+};
+
+/// For the read-side of the compaction process. Not used with direct reads.
+decltype(ircd::db::compaction_readahead)
+ircd::db::compaction_readahead
+{
+	{ "name",     "ircd.db.compaction.readahead" },
+	{ "default",  long(2_MiB)                    },
+};
+
 void
 ircd::db::sync(database &d)
 {
@@ -907,20 +956,15 @@ try
 	// MUST be 0 or std::threads are spawned in rocksdb.
 	opts->max_file_opening_threads = 0;
 
-	opts->max_background_jobs = 16;
-	opts->max_background_flushes = 8;
-	opts->max_background_compactions = 4;
-	opts->max_subcompactions = 1;
+	opts->max_background_jobs = size_t(background_jobs);
+	opts->max_background_flushes = size_t(background_flushes);
+	opts->max_background_compactions = size_t(background_compactions);
+	opts->max_subcompactions = size_t(background_subcompactions);
 
-	// For the write-side of a compaction process: writes will be of approx
-	// this size. The compaction process is composing a buffer of this size
-	// between those writes. Too large a buffer will hog the CPU and starve
-	// other ircd::ctx's. Too small a buffer will be inefficient.
-	opts->writable_file_max_buffer_size = 2_MiB; //TODO: conf
-
-	// For the read-side of the compaction process.
+	// Compaction I/O sizes; see the conf items.
+	opts->writable_file_max_buffer_size = size_t(compaction_write_buffer);
 	opts->compaction_readahead_size = !opts->use_direct_reads?
-		2_MiB: //TODO: conf
+		size_t(compaction_readahead):
 		0;
 
 	opts->max_total_wal_size = 96_MiB;
@@ -1622,6 +1666,12 @@ ircd::db::database::column::column(database &d,
 ,cmp{this->d, this->descriptor->cmp}
 ,prefix{this->d, this->descriptor->prefix}
 ,cfilter{this, this->descriptor->compactor}
+,mergeop
+{
+	this->descriptor->merge?
+		std::make_shared<struct database::mergeop>(this->d, this->descriptor->merge):
+		nullptr
+}
 ,stall{rocksdb::WriteStallCondition::kNormal}
 ,stats
 {
@@ -1680,6 +1730,10 @@ ircd::db::database::column::column(database &d,
 	// Set the compaction filter
 	this->options.compaction_filter = &this->cfilter;
 
+	// Set the merge operator
+	if(this->mergeop)
+		this->options.merge_operator = this->mergeop;
+
 	//this->options.paranoid_file_checks = true;
 
 	// More stats reported by the rocksdb.stats property.
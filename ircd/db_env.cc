@@ -16,6 +16,46 @@ ircd::db::database::env::log
 	"db.env"
 };
 
+/// Scheduling priority of the contexts of each background pool; positive
+/// values are nicer. The contexts of a pool with a positive value yield to
+/// other work once they exceed ircd.db.env.pool.yield.cycles. Applies to
+/// pools created after the change (i.e. on database open).
+decltype(ircd::db::database::env::nice_high)
+ircd::db::database::env::nice_high
+{
+	{ "name",     "ircd.db.env.nice.high" },
+	{ "default",  -5L                     },
+};
+
+decltype(ircd::db::database::env::nice_low)
+ircd::db::database::env::nice_low
+{
+	{ "name",     "ircd.db.env.nice.low" },
+	{ "default",  5L                     },
+};
+
+decltype(ircd::db::database::env::nice_bottom)
+ircd::db::database::env::nice_bottom
+{
+	{ "name",     "ircd.db.env.nice.bottom" },
+	{ "default",  20L                       },
+};
+
+/// Priority of the file I/O submitted by files of each IOPriority.
+decltype(ircd::db::database::env::ionice_high)
+ircd::db::database::env::ionice_high
+{
+	{ "name",     "ircd.db.env.ionice.high" },
+	{ "default",  -5L                       },
+};
+
+decltype(ircd::db::database::env::ionice_low)
+ircd::db::database::env::ionice_low
+{
+	{ "name",     "ircd.db.env.ionice.low" },
+	{ "default",  5L                       },
+};
+
 //
 // env::env
 //
@@ -1219,9 +1259,9 @@ ircd::db::database::env::make_nice(const Priority &prio)
 {
 	switch(prio)
 	{
-		case Priority::HIGH:     return -5;
-		case Priority::LOW:      return 5;
-		case Priority::BOTTOM:   return 20;
+		case Priority::HIGH:     return std::clamp(int64_t(nice_high), -128L, 127L);
+		case Priority::LOW:      return std::clamp(int64_t(nice_low), -128L, 127L);
+		case Priority::BOTTOM:   return std::clamp(int64_t(nice_bottom), -128L, 127L);
 		default:     	         return 0;
 	}
 }
@@ -1231,8 +1271,8 @@ ircd::db::database::env::make_nice(const IOPriority &prio)
 {
 	switch(prio)
 	{
-		case IOPriority::IO_HIGH:     return -5;
-		case IOPriority::IO_LOW:      return 5;
+		case IOPriority::IO_HIGH:     return std::clamp(int64_t(ionice_high), -128L, 127L);
+		case IOPriority::IO_LOW:      return std::clamp(int64_t(ionice_low), -128L, 127L);
 		default:                      return 0;
 	}
 }
@@ -1709,6 +1749,7 @@ noexcept try
 {
 	assert(!opts.direct);
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 	const std::lock_guard lock{mutex};
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1773,6 +1814,7 @@ noexcept try
 {
 	assert(!opts.direct);
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 	const std::lock_guard lock{mutex};
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -2342,6 +2384,7 @@ ircd::db::database::env::writable_file_direct::Append(const Slice &s)
 noexcept try
 {
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 	const std::lock_guard lock{mutex};
 
 	if(!aligned(logical_offset) || !aligned(data(s)))
@@ -2427,6 +2470,7 @@ ircd::db::database::env::writable_file_direct::PositionedAppend(const Slice &s,
 noexcept
 {
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 	const std::lock_guard lock{mutex};
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -2922,6 +2966,7 @@ ircd::db::database::env::sequential_file::Read(size_t length,
 noexcept try
 {
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 	const std::unique_lock lock
 	{
 		mutex, std::try_to_lock
@@ -3467,6 +3512,7 @@ ircd::db::database::env::random_access_file::Read(uint64_t offset,
 const noexcept try
 {
 	const ctx::uninterruptible::nothrow ui;
+	state::pool::courtesy();
 
 	assert(result);
 	assert(scratch);
@@ -4159,6 +4205,38 @@ ircd::db::database::env::state::pool::stack_size
 	{ "default",  long(128_KiB)                 },
 };
 
+decltype(ircd::db::database::env::state::pool::yield_cycles)
+ircd::db::database::env::state::pool::yield_cycles
+{
+	{ "name",     "ircd.db.env.pool.yield.cycles" },
+	{ "default",  long(8 * 1000000L)              },
+};
+
+/// Cooperative preemption of background work. A flush or compaction runs on
+/// its pool context from start to finish; the context otherwise only gives
+/// way while it waits on I/O, and up to writable_file_max_buffer_size of
+/// output is merged and compressed between writes. The file operations call
+/// this first: a context of a pool with a positive nice value which has run
+/// longer than yield_cycles in its current slice yields, so request handling
+/// interleaves with a long compaction rather than waiting it out.
+void
+ircd::db::database::env::state::pool::courtesy()
+noexcept
+{
+	if(!ctx::current || ctx::nice(ctx::cur()) <= 0)
+		return;
+
+	const ulong &cycles
+	{
+		yield_cycles
+	};
+
+	if(!cycles || ctx::prof::cur_slice_cycles() < cycles)
+		return;
+
+	ctx::yield();
+}
+
 //
 // state::pool::pool
 //
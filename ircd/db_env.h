@@ -38,6 +38,11 @@ ircd::db::database::env final
 	static int8_t make_nice(const IOPriority &);
 	static int8_t make_nice(const Priority &);
 
+	static conf::item<int64_t> nice_high;
+	static conf::item<int64_t> nice_low;
+	static conf::item<int64_t> nice_bottom;
+	static conf::item<int64_t> ionice_high;
+	static conf::item<int64_t> ionice_low;
 	static ircd::log::log log;
 
 	database &d;
@@ -38,6 +38,7 @@ ircd::db::database::env::state::pool
 	using IOPriority = rocksdb::Env::IOPriority;
 
 	static conf::item<size_t> stack_size;
+	static conf::item<ulong> yield_cycles;
 
 	database &d;
 	Priority pri;
@@ -50,6 +51,8 @@ ircd::db::database::env::state::pool
 	ctx::pool::opts popts;
 	ctx::pool p;
 
+	static void courtesy() noexcept;
+
 	size_t cancel(void *const &tag);
 	void operator()(task &&);
 
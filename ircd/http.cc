@@ -506,6 +506,7 @@ ircd::http::response::response(window_buffer &out,
 	const bool write_content_length_header
 	{
 		code != NO_CONTENT
+		&& code != NOT_MODIFIED
 		&& content_length != size_t(-1) // chunked encoding indication
 		&& !has_header("content-length")
 	};
@@ -14,19 +14,1751 @@ ircd::http2::connection_preface
 	"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
 };
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// conn.h
+//
+
+decltype(ircd::http2::conn::window_size)
+ircd::http2::conn::window_size
+{
+	{ "name",     "ircd.http2.window_size" },
+	{ "default",  long(256_KiB)            },
+	{ "description",
+
+	R"(
+	Flow control window advertised to the peer for each stream and for the
+	connection as a whole. Received content is buffered in full, so credit is
+	returned to the peer as soon as each DATA frame is read; this only bounds
+	what may be in flight.
+	)"}
+};
+
+decltype(ircd::http2::conn::streams_max)
+ircd::http2::conn::streams_max
+{
+	{ "name",     "ircd.http2.streams.max" },
+	{ "default",  24L                      },
+	{ "description",
+
+	R"(
+	Maximum number of concurrent streams the peer may open on a connection.
+	Each open stream occupies a request context while it is being handled.
+	)"}
+};
+
+decltype(ircd::http2::conn::head_max)
+ircd::http2::conn::head_max
+{
+	{ "name",     "ircd.http2.head.max" },
+	{ "default",  long(8_KiB)           },
+	{ "description",
+
+	R"(
+	Maximum size of the decompressed header list of a stream, advertised to
+	the peer as SETTINGS_MAX_HEADER_LIST_SIZE.
+	)"}
+};
+
+ircd::http2::conn::conn(std::shared_ptr<net::socket> sock)
+:sock
+{
+	std::move(sock)
+}
+,buf
+{
+	2 * (local[settings::code::MAX_FRAME_SIZE] + sizeof(frame::header))
+}
+{
+	local[settings::code::ENABLE_PUSH] = 0;
+	local[settings::code::MAX_CONCURRENT_STREAMS] = size_t(streams_max);
+	local[settings::code::INITIAL_WINDOW_SIZE] = std::min(size_t(window_size), 0x7fffffffUL);
+	local[settings::code::MAX_HEADER_LIST_SIZE] = size_t(head_max);
+}
+
+ircd::http2::conn::~conn()
+noexcept
+{
+	assert(streams.empty());
+}
+
+void
+ircd::http2::conn::add(stream &stream)
+{
+	assert(stream.id);
+	stream.send_window = remote[settings::code::INITIAL_WINDOW_SIZE];
+	stream.recv_window = local[settings::code::INITIAL_WINDOW_SIZE];
+	streams.emplace(stream.id, &stream);
+}
+
+void
+ircd::http2::conn::del(stream &stream)
+noexcept
+{
+	const auto it
+	{
+		streams.find(stream.id)
+	};
+
+	if(it != end(streams) && it->second == &stream)
+		streams.erase(it);
+}
+
+/// Marks every stream closed and wakes any writers blocked on credit; called
+/// by the owner when the connection has failed or is going away.
+void
+ircd::http2::conn::close()
+noexcept
+{
+	for(auto &[id, stream] : streams)
+		stream->state = stream::state::CLOSED;
+
+	dock.notify_all();
+}
+
+/// Reads the next frame. Input is read off the socket ahead of the frame in
+/// large requests, so at least one TLS record always fits: nothing remains
+/// buffered in the TLS layer where it would be invisible to a wait for the
+/// socket to become readable. The owner should continue while buffered().
+/// The payload is valid until the next call.
+ircd::const_buffer
+ircd::http2::conn::read(frame::header &header)
+{
+	const size_t max
+	{
+		local[settings::code::MAX_FRAME_SIZE] + sizeof(frame::header)
+	};
+
+	const auto need{[this, &max]
+	(const size_t &len)
+	{
+		while(buffered() < len)
+		{
+			if(size(buf) - buf_read < max)
+			{
+				memmove(data(buf), data(buf) + buf_parsed, buffered());
+				buf_read -= buf_parsed;
+				buf_parsed = 0;
+			}
+
+			buf_read += net::read_few(*sock, mutable_buffer
+			{
+				data(buf) + buf_read, size(buf) - buf_read
+			});
+		}
+	}};
+
+	need(sizeof(frame::header));
+	header = frame::header
+	{
+		const_buffer{data(buf) + buf_parsed, sizeof(frame::header)}
+	};
+
+	if(unlikely(header.len + sizeof(frame::header) > max))
+		throw error
+		{
+			error::FRAME_SIZE_ERROR, "%s frame of %u bytes exceeds maximum %zu",
+			frame::reflect(header.type),
+			uint(header.len),
+			max - sizeof(frame::header),
+		};
+
+	need(sizeof(frame::header) + header.len);
+	const const_buffer payload
+	{
+		data(buf) + buf_parsed + sizeof(frame::header), header.len
+	};
+
+	buf_parsed += sizeof(frame::header) + header.len;
+	return payload;
+}
+
+/// Connection-level frames are handled entirely and true is returned. False
+/// is returned for frames the owner must handle; the flow control accounting
+/// for DATA has already been done here. Throws http2::error for connection
+/// errors, which the owner should answer with GOAWAY.
+bool
+ircd::http2::conn::handle(const frame::header &header,
+                          const const_buffer &payload)
+{
+	const auto it
+	{
+		header.stream_id?
+			streams.find(header.stream_id):
+			end(streams)
+	};
+
+	stream *const stream
+	{
+		it != end(streams)? it->second : nullptr
+	};
+
+	switch(header.type)
+	{
+		case frame::type::SETTINGS:
+		{
+			if(unlikely(header.stream_id))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "SETTINGS on stream %u", uint(header.stream_id)
+				};
+
+			if(header.flags & frame::flag::ACK)
+				return true;
+
+			if(unlikely(header.len % 6))
+				throw error
+				{
+					error::FRAME_SIZE_ERROR, "SETTINGS length %u", uint(header.len)
+				};
+
+			for(size_t i(0); i < header.len; i += 6)
+			{
+				uint16_t id;
+				uint32_t val;
+				memcpy(&id, data(payload) + i, sizeof(id));
+				memcpy(&val, data(payload) + i + sizeof(id), sizeof(val));
+				id = ntoh(id);
+				val = ntoh(val);
+
+				// Unknown settings must be ignored.
+				if(!id || id >= num_of<settings::code>())
+					continue;
+
+				const auto code
+				{
+					settings::code(id)
+				};
+
+				switch(code)
+				{
+					case settings::code::ENABLE_PUSH:
+						if(unlikely(val > 1))
+							throw error
+							{
+								error::PROTOCOL_ERROR, "ENABLE_PUSH %u", val
+							};
+
+						break;
+
+					case settings::code::INITIAL_WINDOW_SIZE:
+					{
+						if(unlikely(val > 0x7fffffffU))
+							throw error
+							{
+								error::FLOW_CONTROL_ERROR, "INITIAL_WINDOW_SIZE %u", val
+							};
+
+						const int64_t delta
+						{
+							int64_t(val) - int64_t(remote[code])
+						};
+
+						for(auto &[id, stream] : streams)
+							stream->send_window += delta;
+
+						break;
+					}
+
+					case settings::code::MAX_FRAME_SIZE:
+						if(unlikely(val < 16_KiB || val > 16_MiB - 1))
+							throw error
+							{
+								error::PROTOCOL_ERROR, "MAX_FRAME_SIZE %u", val
+							};
+
+						break;
+
+					default:
+						break;
+				}
+
+				remote[code] = val;
+			}
+
+			write_settings(true);
+			dock.notify_all();
+			return true;
+		}
+
+		case frame::type::PING:
+		{
+			if(unlikely(header.stream_id))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "PING on stream %u", uint(header.stream_id)
+				};
+
+			if(unlikely(header.len != 8))
+				throw error
+				{
+					error::FRAME_SIZE_ERROR, "PING length %u", uint(header.len)
+				};
+
+			if(~header.flags & frame::flag::ACK)
+				write({8, frame::type::PING, frame::flag::ACK, 0}, {&payload, 1});
+
+			return true;
+		}
+
+		case frame::type::WINDOW_UPDATE:
+		{
+			if(unlikely(header.len != 4))
+				throw error
+				{
+					error::FRAME_SIZE_ERROR, "WINDOW_UPDATE length %u", uint(header.len)
+				};
+
+			uint32_t inc;
+			memcpy(&inc, data(payload), sizeof(inc));
+			inc = ntoh(inc) & 0x7fffffffU;
+
+			if(!header.stream_id)
+			{
+				if(unlikely(!inc))
+					throw error
+					{
+						error::PROTOCOL_ERROR, "WINDOW_UPDATE of zero"
+					};
+
+				send_window += inc;
+				if(unlikely(send_window > 0x7fffffffL))
+					throw error
+					{
+						error::FLOW_CONTROL_ERROR, "connection window overflow"
+					};
+			}
+			else if(stream && !inc)
+				write_rst_stream(*stream, error::PROTOCOL_ERROR);
+			else if(stream)
+			{
+				stream->send_window += inc;
+				if(unlikely(stream->send_window > 0x7fffffffL))
+					write_rst_stream(*stream, error::FLOW_CONTROL_ERROR);
+			}
+
+			dock.notify_all();
+			return true;
+		}
+
+		case frame::type::GOAWAY:
+		{
+			if(unlikely(header.len < 8))
+				throw error
+				{
+					error::FRAME_SIZE_ERROR, "GOAWAY length %u", uint(header.len)
+				};
+
+			uint32_t last;
+			memcpy(&last, data(payload), sizeof(last));
+			goaway = ntoh(last) & 0x7fffffffU;
+			dock.notify_all();
+			return true;
+		}
+
+		case frame::type::PRIORITY:
+			return true;
+
+		case frame::type::RST_STREAM:
+		{
+			if(unlikely(header.len != 4))
+				throw error
+				{
+					error::FRAME_SIZE_ERROR, "RST_STREAM length %u", uint(header.len)
+				};
+
+			if(stream)
+				stream->state = stream::state::CLOSED;
+
+			dock.notify_all();
+			return false;
+		}
+
+		case frame::type::DATA:
+		{
+			recv_window -= header.len;
+			if(unlikely(recv_window < 0))
+				throw error
+				{
+					error::FLOW_CONTROL_ERROR, "connection window exceeded by %ld",
+					-recv_window,
+				};
+
+			if(stream)
+				stream->recv_window -= header.len;
+
+			if(!header.len)
+				return false;
+
+			// Content is buffered in full by the owner, which bounds it by its
+			// own limits; credit is returned immediately.
+			write_window_update(0, header.len);
+			recv_window += header.len;
+
+			if(stream && stream->recv_window >= 0 && ~header.flags & frame::flag::END_STREAM)
+			{
+				write_window_update(stream->id, header.len);
+				stream->recv_window += header.len;
+			}
+
+			return false;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/// Decompresses a complete header block into the stream's head, rewritten
+/// as HTTP/1.1 without the terminating blank line so the owner may append
+/// fields before parsing it. Returns false if the head is malformed or too
+/// large; that is an error for the stream only. The block is always decoded
+/// in full so the compression state remains synchronized with the peer.
+bool
+ircd::http2::conn::read_head(stream &stream,
+                             const const_buffer &block)
+{
+	static const auto valid{[]
+	(const string_view &s, const bool &name)
+	{
+		return std::none_of(begin(s), end(s), [&name]
+		(const char &c)
+		{
+			return c == '\r' || c == '\n' || c == '\0' || (name && (c == ':' || c == ' '));
+		});
+	}};
+
+	std::string method, path, authority, status, fields;
+	bool ret(true), host(false);
+	size_t total(0);
+	decoder(block, [&](const string_view &name, const string_view &value)
+	{
+		total += size(name) + size(value) + 32;
+		ret &= total <= size_t(head_max);
+		ret &= !empty(name) && valid(value, false);
+		if(!ret)
+			return;
+
+		if(name[0] == ':')
+		{
+			ret &= empty(fields) && valid(name.substr(1), true);
+			if(name == ":method")
+				method = value;
+			else if(name == ":path")
+				path = value;
+			else if(name == ":authority")
+				authority = value;
+			else if(name == ":status")
+				status = value;
+			else if(name != ":scheme")
+				ret = false;
+
+			return;
+		}
+
+		ret &= valid(name, true);
+		if(iequals(name, "connection"_sv) ||
+		   iequals(name, "keep-alive"_sv) ||
+		   iequals(name, "proxy-connection"_sv) ||
+		   iequals(name, "transfer-encoding"_sv) ||
+		   iequals(name, "upgrade"_sv) ||
+		   empty(value))
+			return;
+
+		host |= iequals(name, "host"_sv);
+		fields.append(name);
+		fields.append(": ");
+		fields.append(value);
+		fields.append("\r\n");
+	});
+
+	if(!ret)
+		return false;
+
+	if(!empty(status))
+	{
+		stream.head = "HTTP/1.1 ";
+		stream.head.append(status);
+		stream.head.append("\r\n");
+	}
+	else if(!empty(method) && !empty(path))
+	{
+		stream.head = method;
+		stream.head.append(" ");
+		stream.head.append(path);
+		stream.head.append(" HTTP/1.1\r\n");
+		if(!host && !empty(authority))
+		{
+			stream.head.append("host: ");
+			stream.head.append(authority);
+			stream.head.append("\r\n");
+		}
+	}
+	else return false;
+
+	stream.head.append(fields);
+	return true;
+}
+
+void
+ircd::http2::conn::write(const frame::header &header,
+                         const net::const_buffers &payload)
+{
+	assert(payload.size() < 8);
+	char hbuf[sizeof(frame::header)];
+	const_buffer iov[8];
+	size_t iovs(0);
+	iov[iovs++] = header.write(hbuf);
+	for(size_t i(0); i < payload.size() && iovs < 8; ++i)
+		iov[iovs++] = payload[i];
+
+	const std::lock_guard lock
+	{
+		write_mutex
+	};
+
+	net::write_all(*sock, net::const_buffers{iov, iovs});
+}
+
+void
+ircd::http2::conn::write_settings(const bool &ack)
+{
+	if(ack)
+		return write({0, frame::type::SETTINGS, frame::flag::ACK, 0}, {});
+
+	static const struct settings defaults;
+	char buf[num_of<settings::code>() * 6];
+	size_t len(0);
+	for(size_t i(1); i < num_of<settings::code>(); ++i)
+	{
+		const auto code{settings::code(i)};
+		if(local[code] == defaults[code])
+			continue;
+
+		const uint16_t id(hton(uint16_t(i)));
+		const uint32_t val(hton(local[code]));
+		memcpy(buf + len, &id, sizeof(id));
+		memcpy(buf + len + sizeof(id), &val, sizeof(val));
+		len += 6;
+	}
+
+	const const_buffer payload
+	{
+		buf, len
+	};
+
+	write({uint32_t(len), frame::type::SETTINGS, 0, 0}, {&payload, 1});
+
+	// The connection window starts at the protocol default regardless of
+	// SETTINGS; it is raised to match the stream window here.
+	const int64_t inc
+	{
+		int64_t(local[settings::code::INITIAL_WINDOW_SIZE]) - 65535L
+	};
+
+	if(inc > 0)
+	{
+		write_window_update(0, inc);
+		recv_window += inc;
+	}
+}
+
+void
+ircd::http2::conn::write_window_update(const uint32_t &stream_id,
+                                       const uint32_t &inc)
+{
+	assert(inc > 0 && inc <= 0x7fffffffU);
+	const uint32_t val
+	{
+		hton(inc)
+	};
+
+	const const_buffer payload
+	{
+		reinterpret_cast<const char *>(&val), sizeof(val)
+	};
+
+	write({4, frame::type::WINDOW_UPDATE, 0, stream_id}, {&payload, 1});
+}
+
+void
+ircd::http2::conn::write_rst_stream(stream &stream,
+                                    const enum error::code &code)
+{
+	const uint32_t val
+	{
+		hton(uint32_t(code))
+	};
+
+	const const_buffer payload
+	{
+		reinterpret_cast<const char *>(&val), sizeof(val)
+	};
+
+	stream.state = stream::state::CLOSED;
+	dock.notify_all();
+	write({4, frame::type::RST_STREAM, 0, stream.id}, {&payload, 1});
+}
+
+void
+ircd::http2::conn::write_goaway(const enum error::code &code)
+{
+	const uint32_t val[2]
+	{
+		hton(last_id), hton(uint32_t(code))
+	};
+
+	const const_buffer payload
+	{
+		reinterpret_cast<const char *>(val), sizeof(val)
+	};
+
+	write({8, frame::type::GOAWAY, 0, 0}, {&payload, 1});
+}
+
+/// Translates an HTTP/1.1 head (request or response) into a header block and
+/// sends it as HEADERS followed by any CONTINUATION. Hop-by-hop fields are
+/// dropped. The stream learns the length of the content to follow from the
+/// Content-Length so DATA can end the stream by itself; when the length is
+/// zero the stream is ended here.
+void
+ircd::http2::conn::write_head(stream &stream,
+                              const string_view &head,
+                              const bool &end_stream)
+{
+	const string_view first
+	{
+		head.substr(0, head.find("\r\n"))
+	};
+
+	const string_view fields
+	{
+		head.substr(std::min(size(first) + 2, size(head)))
+	};
+
+	const unique_buffer<mutable_buffer> block_buf
+	{
+		size(head) + 128
+	};
+
+	window_buffer block{block_buf};
+	const bool response
+	{
+		startswith(first, "HTTP/")
+	};
+
+	stream.content_length = -1UL;
+	if(response)
+		hpack::encode(block, ":status", token(first, ' ', 1));
+	else
+	{
+		string_view authority;
+		tokens(fields, "\r\n", [&authority]
+		(const string_view &line)
+		{
+			const auto &[name, value](split(line, ':'));
+			if(iequals(name, "host"_sv))
+				authority = strip(value, ' ');
+		});
+
+		hpack::encode(block, ":method", token(first, ' ', 0));
+		hpack::encode(block, ":scheme", "https");
+		hpack::encode(block, ":authority", authority);
+		hpack::encode(block, ":path", token(first, ' ', 1));
+	}
+
+	tokens(fields, "\r\n", [&stream, &block]
+	(const string_view &line)
+	{
+		const auto &[name_, value_](split(line, ':'));
+		const string_view value
+		{
+			strip(value_, ' ')
+		};
+
+		char buf[128];
+		const string_view name
+		{
+			tolower(buf, strip(name_, ' '))
+		};
+
+		if(empty(name) ||
+		   name == "host" ||
+		   name == "connection" ||
+		   name == "keep-alive" ||
+		   name == "proxy-connection" ||
+		   name == "transfer-encoding" ||
+		   name == "upgrade")
+			return;
+
+		if(name == "content-length")
+			stream.content_length = lex_cast<size_t>(value);
+
+		hpack::encode(block, name, value);
+	});
+
+	const bool end
+	{
+		end_stream || stream.content_length == 0
+	};
+
+	// Each fragment needs a frame header; all frames are composed into one
+	// buffer because CONTINUATION must follow HEADERS without interruption.
+	const const_buffer &completed(block.completed());
+	const size_t max_frame(remote[settings::code::MAX_FRAME_SIZE]);
+	const size_t frames(size(completed) / max_frame + 1);
+	const unique_buffer<mutable_buffer> out_buf
+	{
+		size(completed) + frames * sizeof(frame::header)
+	};
+
+	mutable_buffer out{out_buf};
+	const_buffer remain{completed};
+	for(size_t i(0); i == 0 || !empty(remain); ++i)
+	{
+		const size_t len(std::min(size(remain), max_frame));
+		const frame::header header
+		{
+			uint32_t(len),
+			i == 0? frame::type::HEADERS: frame::type::CONTINUATION,
+			uint8_t
+			(
+				(len == size(remain)? frame::flag::END_HEADERS : 0) |
+				(i == 0 && end? frame::flag::END_STREAM : 0)
+			),
+			stream.id,
+		};
+
+		consume(out, size(header.write(out)));
+		consume(out, copy(out, const_buffer{data(remain), len}));
+		consume(remain, len);
+	}
+
+	const std::lock_guard lock
+	{
+		write_mutex
+	};
+
+	net::write_all(*sock, const_buffer{data(out_buf), data(out)});
+	if(end)
+		stream.state = stream.remote_closed()?
+			stream::state::CLOSED:
+			stream::state::HALF_CLOSED_LOCAL;
+}
+
+/// Sends content as DATA frames. The calling context blocks while the peer
+/// has not extended enough credit for the connection or the stream. The
+/// stream is ended with the final frame if end_stream is true, or once the
+/// amount of content declared by the head has been sent.
+size_t
+ircd::http2::conn::write_data(stream &stream,
+                              const net::const_buffers &bufs,
+                              const bool &end_stream)
+{
+	size_t total(0);
+	for(const auto &buf : bufs)
+		total += size(buf);
+
+	const bool end
+	{
+		end_stream ||
+		(stream.content_length != -1UL && stream.content_sent + total >= stream.content_length)
+	};
+
+	if(!total)
+	{
+		if(end && !stream.local_closed())
+		{
+			write({0, frame::type::DATA, frame::flag::END_STREAM, stream.id}, {});
+			stream.state = stream.remote_closed()?
+				stream::state::CLOSED:
+				stream::state::HALF_CLOSED_LOCAL;
+		}
+
+		return 0;
+	}
+
+	size_t ret(0);
+	for(const_buffer remain : bufs)
+		while(!empty(remain))
+		{
+			dock.wait([this, &stream]
+			{
+				return stream.local_closed()
+				|| !sock || !net::opened(*sock)
+				|| (send_window > 0 && stream.send_window > 0);
+			});
+
+			if(unlikely(stream.local_closed() || !sock || !net::opened(*sock)))
+				throw error
+				{
+					error::STREAM_CLOSED, "stream %u", uint(stream.id)
+				};
+
+			const size_t len
+			{
+				std::min
+				({
+					size(remain),
+					size_t(send_window),
+					size_t(stream.send_window),
+					size_t(remote[settings::code::MAX_FRAME_SIZE]),
+				})
+			};
+
+			const bool last
+			{
+				end && ret + len == total
+			};
+
+			const const_buffer payload
+			{
+				data(remain), len
+			};
+
+			// Credit is taken before yielding to the write so other streams
+			// waking on the dock observe it.
+			send_window -= len;
+			stream.send_window -= len;
+			stream.content_sent += len;
+			consume(remain, len);
+			write({uint32_t(len), frame::type::DATA, uint8_t(last? frame::flag::END_STREAM: 0), stream.id}, {&payload, 1});
+			ret += len;
+
+			if(last)
+				stream.state = stream.remote_closed()?
+					stream::state::CLOSED:
+					stream::state::HALF_CLOSED_LOCAL;
+		}
+
+	return ret;
+}
+
+/// Removes padding and priority fields from HEADERS and DATA payloads.
+ircd::const_buffer
+ircd::http2::conn::payload(const frame::header &header,
+                           const const_buffer &payload)
+{
+	const_buffer ret{payload};
+	size_t pad(0);
+	const bool paddable
+	{
+		header.type == frame::type::DATA ||
+		header.type == frame::type::HEADERS
+	};
+
+	if(paddable && (header.flags & frame::flag::PADDED))
+	{
+		if(unlikely(empty(ret)))
+			throw error
+			{
+				error::PROTOCOL_ERROR, "missing pad length"
+			};
+
+		pad = uint8_t(ret[0]);
+		consume(ret, 1);
+	}
+
+	if(header.type == frame::type::HEADERS && (header.flags & frame::flag::HAS_PRIORITY))
+	{
+		if(unlikely(size(ret) < 5))
+			throw error
+			{
+				error::PROTOCOL_ERROR, "truncated priority"
+			};
+
+		consume(ret, 5);
+	}
+
+	if(unlikely(pad > size(ret)))
+		throw error
+		{
+			error::PROTOCOL_ERROR, "padding exceeds payload"
+		};
+
+	return const_buffer
+	{
+		data(ret), size(ret) - pad
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// hpack.h
+//
+
+namespace ircd::http2::hpack
+{
+	struct huffman;
+
+	static string_view read_string(const_buffer &in, mutable_buffer &out);
+}
+
+/// RFC 7541 Appendix B; code and bit-length for each symbol. The code is
+/// canonical so decoding only needs the first code of each length.
+struct ircd::http2::hpack::huffman
+{
+	static const std::pair<uint32_t, uint8_t> code[257];
+
+	uint32_t first[31] {0};
+	uint16_t offset[31] {0};
+	uint16_t count[31] {0};
+	uint16_t symbol[257] {0};
+
+	huffman();
+};
+
+decltype(ircd::http2::hpack::huffman::code)
+ircd::http2::hpack::huffman::code
+{
+	{ 0x1ff8,     13 },   // 0
+	{ 0x7fffd8,   23 },   // 1
+	{ 0xfffffe2,  28 },   // 2
+	{ 0xfffffe3,  28 },   // 3
+	{ 0xfffffe4,  28 },   // 4
+	{ 0xfffffe5,  28 },   // 5
+	{ 0xfffffe6,  28 },   // 6
+	{ 0xfffffe7,  28 },   // 7
+	{ 0xfffffe8,  28 },   // 8
+	{ 0xffffea,   24 },   // 9
+	{ 0x3ffffffc, 30 },   // 10
+	{ 0xfffffe9,  28 },   // 11
+	{ 0xfffffea,  28 },   // 12
+	{ 0x3ffffffd, 30 },   // 13
+	{ 0xfffffeb,  28 },   // 14
+	{ 0xfffffec,  28 },   // 15
+	{ 0xfffffed,  28 },   // 16
+	{ 0xfffffee,  28 },   // 17
+	{ 0xfffffef,  28 },   // 18
+	{ 0xffffff0,  28 },   // 19
+	{ 0xffffff1,  28 },   // 20
+	{ 0xffffff2,  28 },   // 21
+	{ 0x3ffffffe, 30 },   // 22
+	{ 0xffffff3,  28 },   // 23
+	{ 0xffffff4,  28 },   // 24
+	{ 0xffffff5,  28 },   // 25
+	{ 0xffffff6,  28 },   // 26
+	{ 0xffffff7,  28 },   // 27
+	{ 0xffffff8,  28 },   // 28
+	{ 0xffffff9,  28 },   // 29
+	{ 0xffffffa,  28 },   // 30
+	{ 0xffffffb,  28 },   // 31
+	{ 0x14,        6 },   // ' '
+	{ 0x3f8,      10 },   // '!'
+	{ 0x3f9,      10 },   // '"'
+	{ 0xffa,      12 },   // '#'
+	{ 0x1ff9,     13 },   // '$'
+	{ 0x15,        6 },   // '%'
+	{ 0xf8,        8 },   // '&'
+	{ 0x7fa,      11 },   // "'"
+	{ 0x3fa,      10 },   // '('
+	{ 0x3fb,      10 },   // ')'
+	{ 0xf9,        8 },   // '*'
+	{ 0x7fb,      11 },   // '+'
+	{ 0xfa,        8 },   // ','
+	{ 0x16,        6 },   // '-'
+	{ 0x17,        6 },   // '.'
+	{ 0x18,        6 },   // '/'
+	{ 0x0,         5 },   // '0'
+	{ 0x1,         5 },   // '1'
+	{ 0x2,         5 },   // '2'
+	{ 0x19,        6 },   // '3'
+	{ 0x1a,        6 },   // '4'
+	{ 0x1b,        6 },   // '5'
+	{ 0x1c,        6 },   // '6'
+	{ 0x1d,        6 },   // '7'
+	{ 0x1e,        6 },   // '8'
+	{ 0x1f,        6 },   // '9'
+	{ 0x5c,        7 },   // ':'
+	{ 0xfb,        8 },   // ';'
+	{ 0x7ffc,     15 },   // '<'
+	{ 0x20,        6 },   // '='
+	{ 0xffb,      12 },   // '>'
+	{ 0x3fc,      10 },   // '?'
+	{ 0x1ffa,     13 },   // '@'
+	{ 0x21,        6 },   // 'A'
+	{ 0x5d,        7 },   // 'B'
+	{ 0x5e,        7 },   // 'C'
+	{ 0x5f,        7 },   // 'D'
+	{ 0x60,        7 },   // 'E'
+	{ 0x61,        7 },   // 'F'
+	{ 0x62,        7 },   // 'G'
+	{ 0x63,        7 },   // 'H'
+	{ 0x64,        7 },   // 'I'
+	{ 0x65,        7 },   // 'J'
+	{ 0x66,        7 },   // 'K'
+	{ 0x67,        7 },   // 'L'
+	{ 0x68,        7 },   // 'M'
+	{ 0x69,        7 },   // 'N'
+	{ 0x6a,        7 },   // 'O'
+	{ 0x6b,        7 },   // 'P'
+	{ 0x6c,        7 },   // 'Q'
+	{ 0x6d,        7 },   // 'R'
+	{ 0x6e,        7 },   // 'S'
+	{ 0x6f,        7 },   // 'T'
+	{ 0x70,        7 },   // 'U'
+	{ 0x71,        7 },   // 'V'
+	{ 0x72,        7 },   // 'W'
+	{ 0xfc,        8 },   // 'X'
+	{ 0x73,        7 },   // 'Y'
+	{ 0xfd,        8 },   // 'Z'
+	{ 0x1ffb,     13 },   // '['
+	{ 0x7fff0,    19 },   // '\\'
+	{ 0x1ffc,     13 },   // ']'
+	{ 0x3ffc,     14 },   // '^'
+	{ 0x22,        6 },   // '_'
+	{ 0x7ffd,     15 },   // '`'
+	{ 0x3,         5 },   // 'a'
+	{ 0x23,        6 },   // 'b'
+	{ 0x4,         5 },   // 'c'
+	{ 0x24,        6 },   // 'd'
+	{ 0x5,         5 },   // 'e'
+	{ 0x25,        6 },   // 'f'
+	{ 0x26,        6 },   // 'g'
+	{ 0x27,        6 },   // 'h'
+	{ 0x6,         5 },   // 'i'
+	{ 0x74,        7 },   // 'j'
+	{ 0x75,        7 },   // 'k'
+	{ 0x28,        6 },   // 'l'
+	{ 0x29,        6 },   // 'm'
+	{ 0x2a,        6 },   // 'n'
+	{ 0x7,         5 },   // 'o'
+	{ 0x2b,        6 },   // 'p'
+	{ 0x76,        7 },   // 'q'
+	{ 0x2c,        6 },   // 'r'
+	{ 0x8,         5 },   // 's'
+	{ 0x9,         5 },   // 't'
+	{ 0x2d,        6 },   // 'u'
+	{ 0x77,        7 },   // 'v'
+	{ 0x78,        7 },   // 'w'
+	{ 0x79,        7 },   // 'x'
+	{ 0x7a,        7 },   // 'y'
+	{ 0x7b,        7 },   // 'z'
+	{ 0x7ffe,     15 },   // '{'
+	{ 0x7fc,      11 },   // '|'
+	{ 0x3ffd,     14 },   // '}'
+	{ 0x1ffd,     13 },   // '~'
+	{ 0xffffffc,  28 },   // 127
+	{ 0xfffe6,    20 },   // 128
+	{ 0x3fffd2,   22 },   // 129
+	{ 0xfffe7,    20 },   // 130
+	{ 0xfffe8,    20 },   // 131
+	{ 0x3fffd3,   22 },   // 132
+	{ 0x3fffd4,   22 },   // 133
+	{ 0x3fffd5,   22 },   // 134
+	{ 0x7fffd9,   23 },   // 135
+	{ 0x3fffd6,   22 },   // 136
+	{ 0x7fffda,   23 },   // 137
+	{ 0x7fffdb,   23 },   // 138
+	{ 0x7fffdc,   23 },   // 139
+	{ 0x7fffdd,   23 },   // 140
+	{ 0x7fffde,   23 },   // 141
+	{ 0xffffeb,   24 },   // 142
+	{ 0x7fffdf,   23 },   // 143
+	{ 0xffffec,   24 },   // 144
+	{ 0xffffed,   24 },   // 145
+	{ 0x3fffd7,   22 },   // 146
+	{ 0x7fffe0,   23 },   // 147
+	{ 0xffffee,   24 },   // 148
+	{ 0x7fffe1,   23 },   // 149
+	{ 0x7fffe2,   23 },   // 150
+	{ 0x7fffe3,   23 },   // 151
+	{ 0x7fffe4,   23 },   // 152
+	{ 0x1fffdc,   21 },   // 153
+	{ 0x3fffd8,   22 },   // 154
+	{ 0x7fffe5,   23 },   // 155
+	{ 0x3fffd9,   22 },   // 156
+	{ 0x7fffe6,   23 },   // 157
+	{ 0x7fffe7,   23 },   // 158
+	{ 0xffffef,   24 },   // 159
+	{ 0x3fffda,   22 },   // 160
+	{ 0x1fffdd,   21 },   // 161
+	{ 0xfffe9,    20 },   // 162
+	{ 0x3fffdb,   22 },   // 163
+	{ 0x3fffdc,   22 },   // 164
+	{ 0x7fffe8,   23 },   // 165
+	{ 0x7fffe9,   23 },   // 166
+	{ 0x1fffde,   21 },   // 167
+	{ 0x7fffea,   23 },   // 168
+	{ 0x3fffdd,   22 },   // 169
+	{ 0x3fffde,   22 },   // 170
+	{ 0xfffff0,   24 },   // 171
+	{ 0x1fffdf,   21 },   // 172
+	{ 0x3fffdf,   22 },   // 173
+	{ 0x7fffeb,   23 },   // 174
+	{ 0x7fffec,   23 },   // 175
+	{ 0x1fffe0,   21 },   // 176
+	{ 0x1fffe1,   21 },   // 177
+	{ 0x3fffe0,   22 },   // 178
+	{ 0x1fffe2,   21 },   // 179
+	{ 0x7fffed,   23 },   // 180
+	{ 0x3fffe1,   22 },   // 181
+	{ 0x7fffee,   23 },   // 182
+	{ 0x7fffef,   23 },   // 183
+	{ 0xfffea,    20 },   // 184
+	{ 0x3fffe2,   22 },   // 185
+	{ 0x3fffe3,   22 },   // 186
+	{ 0x3fffe4,   22 },   // 187
+	{ 0x7ffff0,   23 },   // 188
+	{ 0x3fffe5,   22 },   // 189
+	{ 0x3fffe6,   22 },   // 190
+	{ 0x7ffff1,   23 },   // 191
+	{ 0x3ffffe0,  26 },   // 192
+	{ 0x3ffffe1,  26 },   // 193
+	{ 0xfffeb,    20 },   // 194
+	{ 0x7fff1,    19 },   // 195
+	{ 0x3fffe7,   22 },   // 196
+	{ 0x7ffff2,   23 },   // 197
+	{ 0x3fffe8,   22 },   // 198
+	{ 0x1ffffec,  25 },   // 199
+	{ 0x3ffffe2,  26 },   // 200
+	{ 0x3ffffe3,  26 },   // 201
+	{ 0x3ffffe4,  26 },   // 202
+	{ 0x7ffffde,  27 },   // 203
+	{ 0x7ffffdf,  27 },   // 204
+	{ 0x3ffffe5,  26 },   // 205
+	{ 0xfffff1,   24 },   // 206
+	{ 0x1ffffed,  25 },   // 207
+	{ 0x7fff2,    19 },   // 208
+	{ 0x1fffe3,   21 },   // 209
+	{ 0x3ffffe6,  26 },   // 210
+	{ 0x7ffffe0,  27 },   // 211
+	{ 0x7ffffe1,  27 },   // 212
+	{ 0x3ffffe7,  26 },   // 213
+	{ 0x7ffffe2,  27 },   // 214
+	{ 0xfffff2,   24 },   // 215
+	{ 0x1fffe4,   21 },   // 216
+	{ 0x1fffe5,   21 },   // 217
+	{ 0x3ffffe8,  26 },   // 218
+	{ 0x3ffffe9,  26 },   // 219
+	{ 0xffffffd,  28 },   // 220
+	{ 0x7ffffe3,  27 },   // 221
+	{ 0x7ffffe4,  27 },   // 222
+	{ 0x7ffffe5,  27 },   // 223
+	{ 0xfffec,    20 },   // 224
+	{ 0xfffff3,   24 },   // 225
+	{ 0xfffed,    20 },   // 226
+	{ 0x1fffe6,   21 },   // 227
+	{ 0x3fffe9,   22 },   // 228
+	{ 0x1fffe7,   21 },   // 229
+	{ 0x1fffe8,   21 },   // 230
+	{ 0x7ffff3,   23 },   // 231
+	{ 0x3fffea,   22 },   // 232
+	{ 0x3fffeb,   22 },   // 233
+	{ 0x1ffffee,  25 },   // 234
+	{ 0x1ffffef,  25 },   // 235
+	{ 0xfffff4,   24 },   // 236
+	{ 0xfffff5,   24 },   // 237
+	{ 0x3ffffea,  26 },   // 238
+	{ 0x7ffff4,   23 },   // 239
+	{ 0x3ffffeb,  26 },   // 240
+	{ 0x7ffffe6,  27 },   // 241
+	{ 0x3ffffec,  26 },   // 242
+	{ 0x3ffffed,  26 },   // 243
+	{ 0x7ffffe7,  27 },   // 244
+	{ 0x7ffffe8,  27 },   // 245
+	{ 0x7ffffe9,  27 },   // 246
+	{ 0x7ffffea,  27 },   // 247
+	{ 0x7ffffeb,  27 },   // 248
+	{ 0xffffffe,  28 },   // 249
+	{ 0x7ffffec,  27 },   // 250
+	{ 0x7ffffed,  27 },   // 251
+	{ 0x7ffffee,  27 },   // 252
+	{ 0x7ffffef,  27 },   // 253
+	{ 0x7fffff0,  27 },   // 254
+	{ 0x3ffffee,  26 },   // 255
+	{ 0x3fffffff, 30 },   // EOS
+};
+
+ircd::http2::hpack::huffman::huffman()
+{
+	for(size_t i(0); i < 257; ++i)
+		++count[code[i].second];
+
+	for(size_t len(1), off(0); len < 31; off += count[len++])
+		offset[len] = off;
+
+	uint16_t pos[31];
+	std::copy(begin(offset), end(offset), begin(pos));
+	for(size_t i(0); i < 257; ++i)
+	{
+		const auto &len(code[i].second);
+		if(pos[len] == offset[len])
+			first[len] = code[i].first;
+
+		symbol[pos[len]++] = i;
+	}
+}
+
+decltype(ircd::http2::hpack::static_table)
+ircd::http2::hpack::static_table
+{
+	{ ":authority",                   {}                 },
+	{ ":method",                      "GET"              },
+	{ ":method",                      "POST"             },
+	{ ":path",                        "/"                },
+	{ ":path",                        "/index.html"      },
+	{ ":scheme",                      "http"             },
+	{ ":scheme",                      "https"            },
+	{ ":status",                      "200"              },
+	{ ":status",                      "204"              },
+	{ ":status",                      "206"              },
+	{ ":status",                      "304"              },
+	{ ":status",                      "400"              },
+	{ ":status",                      "404"              },
+	{ ":status",                      "500"              },
+	{ "accept-charset",               {}                 },
+	{ "accept-encoding",              "gzip, deflate"    },
+	{ "accept-language",              {}                 },
+	{ "accept-ranges",                {}                 },
+	{ "accept",                       {}                 },
+	{ "access-control-allow-origin",  {}                 },
+	{ "age",                          {}                 },
+	{ "allow",                        {}                 },
+	{ "authorization",                {}                 },
+	{ "cache-control",                {}                 },
+	{ "content-disposition",          {}                 },
+	{ "content-encoding",             {}                 },
+	{ "content-language",             {}                 },
+	{ "content-length",               {}                 },
+	{ "content-location",             {}                 },
+	{ "content-range",                {}                 },
+	{ "content-type",                 {}                 },
+	{ "cookie",                       {}                 },
+	{ "date",                         {}                 },
+	{ "etag",                         {}                 },
+	{ "expect",                       {}                 },
+	{ "expires",                      {}                 },
+	{ "from",                         {}                 },
+	{ "host",                         {}                 },
+	{ "if-match",                     {}                 },
+	{ "if-modified-since",            {}                 },
+	{ "if-none-match",                {}                 },
+	{ "if-range",                     {}                 },
+	{ "if-unmodified-since",          {}                 },
+	{ "last-modified",                {}                 },
+	{ "link",                         {}                 },
+	{ "location",                     {}                 },
+	{ "max-forwards",                 {}                 },
+	{ "proxy-authenticate",           {}                 },
+	{ "proxy-authorization",          {}                 },
+	{ "range",                        {}                 },
+	{ "referer",                      {}                 },
+	{ "refresh",                      {}                 },
+	{ "retry-after",                  {}                 },
+	{ "server",                       {}                 },
+	{ "set-cookie",                   {}                 },
+	{ "strict-transport-security",    {}                 },
+	{ "transfer-encoding",            {}                 },
+	{ "user-agent",                   {}                 },
+	{ "vary",                         {}                 },
+	{ "via",                          {}                 },
+	{ "www-authenticate",             {}                 },
+};
+
+//
+// decoder
+//
+
+void
+ircd::http2::hpack::decoder::operator()(const const_buffer &block,
+                                        const closure &closure)
+{
+	// Huffman coding expands by at most 8/5; the name and value of any one
+	// field are decoded next to each other in this buffer.
+	const unique_buffer<mutable_buffer> buf
+	{
+		size(block) * 8 / 5 + 16
+	};
+
+	const_buffer in{block};
+	while(!empty(in))
+	{
+		const uint8_t &byte(in[0]);
+
+		// Indexed field
+		if(byte & 0x80)
+		{
+			const auto &[name, value]
+			{
+				table[decode(in, 7)]
+			};
+
+			closure(name, value);
+			continue;
+		}
+
+		// Dynamic table size update
+		if((byte & 0xe0) == 0x20)
+		{
+			const size_t max
+			{
+				decode(in, 5)
+			};
+
+			if(unlikely(max > this->max))
+				throw error
+				{
+					error::COMPRESSION_ERROR, "table size %zu exceeds %zu",
+					max,
+					this->max,
+				};
+
+			table.resize(max);
+			continue;
+		}
+
+		// Literal fields; with incremental indexing, without indexing, or
+		// never indexed. The latter two are the same to a decoder.
+		const bool indexing
+		{
+			(byte & 0xc0) == 0x40
+		};
+
+		const size_t index
+		{
+			decode(in, indexing? 6 : 4)
+		};
+
+		mutable_buffer out{buf};
+		const string_view name
+		{
+			index?
+				table[index].first:
+				read_string(in, out)
+		};
+
+		const string_view value
+		{
+			read_string(in, out)
+		};
+
+		closure(name, value);
+		if(indexing)
+			table.add(name, value);
+	}
+}
+
+ircd::string_view
+ircd::http2::hpack::read_string(const_buffer &in,
+                                mutable_buffer &out)
+{
+	if(unlikely(empty(in)))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "truncated string"
+		};
+
+	const bool huff
+	{
+		bool(in[0] & 0x80)
+	};
+
+	const size_t len
+	{
+		decode(in, 7)
+	};
+
+	if(unlikely(len > size(in)))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "string length %zu exceeds block", len
+		};
+
+	const const_buffer str
+	{
+		data(in), len
+	};
+
+	consume(in, len);
+	if(unlikely(!huff && len > size(out)))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "string length %zu exceeds buffer", len
+		};
+
+	const size_t copied
+	{
+		huff?
+			huffman_decode(out, str):
+			copy(out, str)
+	};
+
+	const string_view ret
+	{
+		data(out), copied
+	};
+
+	consume(out, copied);
+	return ret;
+}
+
+//
+// encoder
+//
+
+/// Fields are sent as literals without indexing (by static name reference
+/// when one exists) or fully indexed when the static table has the exact
+/// field. The dynamic table of the peer is never touched, so the encoder
+/// carries no state and any SETTINGS_HEADER_TABLE_SIZE is acceptable.
+size_t
+ircd::http2::hpack::encode(window_buffer &buf,
+                           const string_view &name,
+                           const string_view &value)
+{
+	size_t name_index(0), full_index(0);
+	for(size_t i(0); i < 61 && !full_index; ++i)
+	{
+		if(static_table[i].first != name)
+			continue;
+
+		name_index = name_index?: i + 1;
+		full_index = static_table[i].second == value? i + 1: 0;
+	}
+
+	if(unlikely(buf.remaining() < size(name) + size(value) + 16))
+		throw error
+		{
+			error::INTERNAL_ERROR, "header block too large for buffer"
+		};
+
+	return size(buf([&](const mutable_buffer &out_)
+	{
+		mutable_buffer out{out_};
+		if(full_index)
+		{
+			consume(out, encode(out, 0x80, 7, full_index));
+			return size_t(data(out) - data(out_));
+		}
+
+		consume(out, encode(out, 0x00, 4, name_index));
+		if(!name_index)
+		{
+			consume(out, encode(out, 0x00, 7, size(name)));
+			consume(out, copy(out, name));
+		}
+
+		consume(out, encode(out, 0x00, 7, size(value)));
+		consume(out, copy(out, value));
+		return size_t(data(out) - data(out_));
+	}));
+}
+
+//
+// integer
+//
+
+size_t
+ircd::http2::hpack::encode(const mutable_buffer &out,
+                           const uint8_t &flags,
+                           const uint8_t &prefix,
+                           const size_t &val)
+{
+	assert(size(out) >= 10);
+	const uint8_t mask((1U << prefix) - 1);
+	if(val < mask)
+	{
+		out[0] = flags | val;
+		return 1;
+	}
+
+	size_t i(0), rem(val - mask);
+	out[i++] = flags | mask;
+	for(; rem >= 0x80; rem >>= 7)
+		out[i++] = 0x80 | (rem & 0x7f);
+
+	out[i++] = rem;
+	return i;
+}
+
+size_t
+ircd::http2::hpack::decode(const_buffer &in,
+                           const uint8_t &prefix)
+{
+	if(unlikely(empty(in)))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "truncated integer"
+		};
+
+	const uint8_t mask((1U << prefix) - 1);
+	size_t ret(uint8_t(in[0]) & mask);
+	consume(in, 1);
+	if(ret < mask)
+		return ret;
+
+	for(size_t shift(0); shift <= 28; shift += 7)
+	{
+		if(unlikely(empty(in)))
+			break;
+
+		const uint8_t byte(in[0]);
+		consume(in, 1);
+		ret += size_t(byte & 0x7f) << shift;
+		if(~byte & 0x80)
+			return ret;
+	}
+
+	throw error
+	{
+		error::COMPRESSION_ERROR, "invalid integer"
+	};
+}
+
+//
+// huffman
+//
+
+size_t
+ircd::http2::hpack::huffman_decode(const mutable_buffer &out,
+                                   const const_buffer &in)
+{
+	static const huffman table;
+
+	size_t ret(0);
+	uint32_t code(0), len(0);
+	for(const uint8_t byte : in)
+		for(int bit(7); bit >= 0; --bit)
+		{
+			code = (code << 1) | ((byte >> bit) & 0x01);
+			if(unlikely(++len > 30))
+				throw error
+				{
+					error::COMPRESSION_ERROR, "invalid huffman code"
+				};
+
+			const uint32_t pos(code - table.first[len]);
+			if(pos >= table.count[len])
+				continue;
+
+			const uint16_t &symbol
+			{
+				table.symbol[table.offset[len] + pos]
+			};
+
+			if(unlikely(symbol == 256))
+				throw error
+				{
+					error::COMPRESSION_ERROR, "huffman EOS in string"
+				};
+
+			if(unlikely(ret >= size(out)))
+				throw error
+				{
+					error::COMPRESSION_ERROR, "huffman string exceeds buffer"
+				};
+
+			out[ret++] = symbol;
+			code = 0;
+			len = 0;
+		}
+
+	// Padding is the most significant bits of EOS (all ones) and shorter
+	// than one octet.
+	if(unlikely(len > 7 || code != (1U << len) - 1))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "invalid huffman padding"
+		};
+
+	return ret;
+}
+
+//
+// table
+//
+
+ircd::http2::hpack::entry
+ircd::http2::hpack::table::operator[](const size_t &index)
+const
+{
+	if(likely(index && index <= 61))
+		return static_table[index - 1];
+
+	if(unlikely(!index || index - 62 >= entries.size()))
+		throw error
+		{
+			error::COMPRESSION_ERROR, "invalid table index %zu", index
+		};
+
+	const auto &[name, value]
+	{
+		entries.at(index - 62)
+	};
+
+	return
+	{
+		name, value
+	};
+}
+
+void
+ircd::http2::hpack::table::resize(const size_t &max)
+{
+	this->max = max;
+	while(size > max && !entries.empty())
+	{
+		size -= 32 + entries.back().first.size() + entries.back().second.size();
+		entries.pop_back();
+	}
+}
+
+void
+ircd::http2::hpack::table::add(const string_view &name,
+                               const string_view &value)
+{
+	// The strings are copied first because name may refer to an entry which
+	// is about to be evicted.
+	std::pair<std::string, std::string> entry
+	{
+		name, value
+	};
+
+	const size_t esize
+	{
+		32 + entry.first.size() + entry.second.size()
+	};
+
+	while(!entries.empty() && size + esize > max)
+	{
+		size -= 32 + entries.back().first.size() + entries.back().second.size();
+		entries.pop_back();
+	}
+
+	// An entry larger than the table leaves the table empty.
+	if(esize > max)
+		return;
+
+	size += esize;
+	entries.emplace_front(std::move(entry));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// frame.h
+//
+
+static_assert
+(
+    sizeof(ircd::http2::frame::header) == 9
+);
+
+ircd::http2::frame::header::header(const uint32_t &len,
+                                   const enum type &type,
+                                   const uint8_t &flags,
+                                   const uint32_t &stream_id)
+:len{len}
+,type{type}
+,flags{flags}
+,stream_id{stream_id}
+{
+	assert(len < 16_MiB);
+	assert(stream_id <= 0x7fffffffU);
+}
+
+ircd::http2::frame::header::header(const const_buffer &buf)
+{
+	assert(size(buf) >= sizeof(frame::header));
+	const auto *const b
+	{
+		reinterpret_cast<const uint8_t *>(data(buf))
+	};
+
+	len = (uint32_t(b[0]) << 16) | (uint32_t(b[1]) << 8) | b[2];
+	type = frame::type(b[3]);
+	flags = b[4];
+	stream_id =
+	(
+		(uint32_t(b[5] & 0x7f) << 24) |
+		(uint32_t(b[6]) << 16) |
+		(uint32_t(b[7]) << 8) |
+		uint32_t(b[8])
+	);
+}
+
+ircd::const_buffer
+ircd::http2::frame::header::write(const mutable_buffer &buf)
+const
+{
+	assert(size(buf) >= sizeof(frame::header));
+	auto *const b
+	{
+		reinterpret_cast<uint8_t *>(data(buf))
+	};
+
+	b[0] = len >> 16;
+	b[1] = len >> 8;
+	b[2] = len;
+	b[3] = type;
+	b[4] = flags;
+	b[5] = (stream_id >> 24) & 0x7f;
+	b[6] = stream_id >> 16;
+	b[7] = stream_id >> 8;
+	b[8] = stream_id;
+	return const_buffer
+	{
+		data(buf), sizeof(frame::header)
+	};
+}
+
+ircd::string_view
+ircd::http2::frame::reflect(const type &type)
+{
+	switch(type)
+	{
+		case type::DATA:             return "DATA";
+		case type::HEADERS:          return "HEADERS";
+		case type::PRIORITY:         return "PRIORITY";
+		case type::RST_STREAM:       return "RST_STREAM";
+		case type::SETTINGS:         return "SETTINGS";
+		case type::PUSH_PROMISE:     return "PUSH_PROMISE";
+		case type::PING:             return "PING";
+		case type::GOAWAY:           return "GOAWAY";
+		case type::WINDOW_UPDATE:    return "WINDOW_UPDATE";
+		case type::CONTINUATION:     return "CONTINUATION";
+	}
+
+	return "??????";
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // stream.h
 //
 
-ircd::http2::stream::stream()
-:state
+ircd::http2::stream::stream(const uint32_t &id)
+:id
 {
-	state::IDLE
+	id
+}
+,state
+{
+	id? state::OPEN: state::IDLE
 }
 {
 }
 
+bool
+ircd::http2::stream::closed()
+const
+{
+	return state == state::CLOSED;
+}
+
+bool
+ircd::http2::stream::local_closed()
+const
+{
+	return state == state::HALF_CLOSED_LOCAL || state == state::CLOSED;
+}
+
+bool
+ircd::http2::stream::remote_closed()
+const
+{
+	return state == state::HALF_CLOSED_REMOTE || state == state::CLOSED;
+}
+
 ircd::string_view
 ircd::http2::reflect(const enum stream::state &state)
 {
@@ -81,17 +1813,6 @@ ircd::http2::reflect(const frame::settings::code &code)
 	return "??????";
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-// frame.h
-//
-
-static_assert
-(
-    sizeof(ircd::http2::frame::header) == 9
-);
-
-
 ///////////////////////////////////////////////////////////////////////////////
 //
 // error.h
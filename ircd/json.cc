@@ -16,6 +16,7 @@ namespace ircd::json
 	// Instantiations of the grammars
 	struct parser extern const parser;
 	struct printer extern const printer;
+	struct scanner;
 }
 #pragma GCC visibility pop
 
@@ -2827,6 +2828,122 @@ catch(const expectation_failure<parse_error> &e)
 	throw;
 }
 
+//
+// object::tape
+//
+
+ircd::json::object::tape::tape(const json::object &object)
+{
+	operator()(object);
+}
+
+void
+ircd::json::object::tape::operator()(const json::object &object)
+{
+	this->object = object;
+	members.clear();
+	hashes.clear();
+	for(const auto &member : object)
+	{
+		hashes.emplace_back(name_hash(member.first), members.size());
+		members.emplace_back(member);
+	}
+
+	// Stable so the first of any duplicate keys is found like object::find().
+	std::stable_sort(std::begin(hashes), std::end(hashes), []
+	(const auto &a, const auto &b)
+	{
+		return a.first < b.first;
+	});
+}
+
+ircd::string_view
+ircd::json::object::tape::operator[](const string_view &key)
+const
+{
+	const auto *const member
+	{
+		find(key)
+	};
+
+	return member?
+		member->second:
+		string_view{};
+}
+
+ircd::string_view
+ircd::json::object::tape::get(const string_view &key,
+                              const string_view &def)
+const
+{
+	return get<string_view>(key, def);
+}
+
+bool
+ircd::json::object::tape::has(const string_view &key,
+                              const enum json::type &type)
+const
+{
+	const auto *const member
+	{
+		find(key)
+	};
+
+	return member && json::type(member->second, type);
+}
+
+bool
+ircd::json::object::tape::has(const string_view &key)
+const
+{
+	return find(key) != nullptr;
+}
+
+const ircd::json::object::member *
+ircd::json::object::tape::find(const string_view &key)
+const
+{
+	return _find(name_hash(key), key);
+}
+
+const ircd::json::object::member *
+ircd::json::object::tape::find(const name_hash_t &key)
+const
+{
+	return _find(key);
+}
+
+/// The key string is compared when given, otherwise the hash alone decides
+/// as with object::find(name_hash_t).
+const ircd::json::object::member *
+ircd::json::object::tape::_find(const name_hash_t &hash,
+                                const string_view &key)
+const
+{
+	auto it
+	{
+		std::lower_bound(std::begin(hashes), std::end(hashes), hash, []
+		(const auto &a, const auto &hash)
+		{
+			return a.first < hash;
+		})
+	};
+
+	for(; it != std::end(hashes) && it->first == hash; ++it)
+	{
+		assert(it->second < members.size());
+		const auto &member
+		{
+			members[it->second]
+		};
+
+		if(!key || member.first == key)
+			return &member;
+	}
+
+	return nullptr;
+}
+
 //
 // object::const_iterator
 //
@@ -4797,6 +4914,526 @@ ircd::json::operator==(const value &a, const value &b)
 	};
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// json/scanner
+//
+
+/// Vectorized structural scanner.
+///
+/// Stage one classifies 64 bytes of input at a time into bitmaps of quotes,
+/// backslashes, structural characters, whitespace and control characters;
+/// from these it derives the escaped characters and which bytes are within
+/// strings, carrying state across each 64 byte boundary. Stage two is a state
+/// machine visiting only the positions indexed by stage one: structural
+/// characters outside of strings, the opening quote of each string and the
+/// first character of every other scalar, which is validated in place.
+///
+/// The scanner accepts a subset of what the grammar accepts (e.g. nesting is
+/// limited to 64 levels, numbers to the digits the grammar allows, escapes to
+/// the canonical set); input it doesn't accept is given to the grammar rather
+/// than rejected, so the results of valid() are unchanged (see the console
+/// command 'json check').
+///
+/// This is only a faster acceptance path for valid(). It does not index the
+/// input for later use; json::object and json::array iteration and every
+/// accessor are still driven by the grammar.
+///
+struct ircd::json::scanner
+{
+	enum state :uint8_t;
+	struct masks;
+
+	#if defined(__AVX2__)
+	using block_t = u8x32;
+	#else
+	using block_t = u8x16;
+	#endif
+
+	static constexpr const size_t depth_max {64};
+	static const u64 even_bits;
+
+	const char *const start;
+	const char *const stop;
+	u64 stack {0};                   // is_array bit for each level
+	uint depth {0};
+	state st;
+
+	static bool is_scalar_char(const char &) noexcept;
+	static size_t number(const char *, const char *const &) noexcept;
+	static size_t scalar(const char *, const char *const &) noexcept;
+	static bool escapes(const char *const &, const char *const &, u64) noexcept;
+	static u64 escaped(u64 backslash, u64 &carry) noexcept;
+	static u64 prefix_xor(u64) noexcept;
+	static masks classify(const char *const &) noexcept;
+
+	bool after_value() noexcept;
+	bool open(const bool &array) noexcept;
+	bool close(const bool &array) noexcept;
+	bool value(const char *const &) noexcept;
+	bool token(const char *const &) noexcept;
+	bool chunk(const char *const &, const char *const &, u64 (&carry)[3]) noexcept;
+
+  public:
+	bool operator()() noexcept;
+
+	scanner(const string_view &) noexcept;
+};
+
+enum ircd::json::scanner::state
+:uint8_t
+{
+	VALUE,                           // any value
+	VALUE_OR_END,                    // any value or ']'
+	KEY_OR_END,                      // string or '}'
+	KEY,                             // string
+	NAME_SEP,                        // ':'
+	VALUE_SEP_OR_END,                // ',' or the end of the container
+	DONE,                            // nothing
+};
+
+struct ircd::json::scanner::masks
+{
+	u64 quote {0};
+	u64 backslash {0};
+	u64 structural {0};
+	u64 ws {0};
+	u64 ctrl {0};
+};
+
+decltype(ircd::json::scanner::even_bits)
+ircd::json::scanner::even_bits
+{
+	0x5555555555555555UL
+};
+
+bool
+ircd::json::scan(const string_view &s)
+noexcept
+{
+	scanner scanner
+	{
+		s
+	};
+
+	return scanner();
+}
+
+ircd::json::scanner::scanner(const string_view &s)
+noexcept
+:start{begin(s)}
+,stop{end(s)}
+,st{VALUE}
+{
+}
+
+bool
+ircd::json::scanner::operator()()
+noexcept
+{
+	// The grammar admits no whitespace before the value.
+	if(unlikely(start == stop || isspace(*start)))
+		return false;
+
+	// carry: escaped, in_string, scalar
+	u64 carry[3] {0};
+	const char *p(start);
+	for(; p + 64 <= stop; p += 64)
+		if(!chunk(p, p, carry))
+			return false;
+
+	// The remainder is scanned from a copy padded with whitespace.
+	if(p < stop)
+	{
+		alignas(64) char buf[64];
+		memset(buf, ' ', sizeof(buf));
+		memcpy(buf, p, stop - p);
+		if(!chunk(buf, p, carry))
+			return false;
+	}
+
+	return st == DONE && !carry[1];
+}
+
+/// Scans the 64 bytes at `in`, which is either the input at `at` or a copy
+/// of it; positions are reported in terms of `at`.
+bool
+ircd::json::scanner::chunk(const char *const &in,
+                           const char *const &at,
+                           u64 (&carry)[3])
+noexcept
+{
+	const masks m
+	{
+		classify(in)
+	};
+
+	const u64 escaped
+	{
+		scanner::escaped(m.backslash, carry[0])
+	};
+
+	const u64 quote
+	{
+		m.quote & ~escaped
+	};
+
+	// Includes the opening quote but not the closing quote of each string.
+	const u64 in_string
+	{
+		prefix_xor(quote) ^ carry[1]
+	};
+
+	carry[1] = u64(int64_t(in_string) >> 63);
+
+	// Control characters are only whitespace, outside of strings.
+	if(m.ctrl & (in_string | ~m.ws))
+		return false;
+
+	if(!escapes(at, stop, escaped & in_string))
+		return false;
+
+	const u64 scalar
+	{
+		~(m.ws | m.structural | in_string | quote)
+	};
+
+	const u64 scalar_start
+	{
+		scalar & ~(scalar << 1 | carry[2])
+	};
+
+	carry[2] = scalar >> 63;
+
+	u64 index
+	{
+		(m.structural & ~in_string) | (quote & in_string) | scalar_start
+	};
+
+	for(; index; index &= index - 1)
+		if(!token(at + __builtin_ctzl(index)))
+			return false;
+
+	return true;
+}
+
+bool
+ircd::json::scanner::token(const char *const &p)
+noexcept
+{
+	assert(p < stop);
+	switch(st)
+	{
+		case VALUE_OR_END:
+			if(*p == ']')
+				return close(true);
+
+			[[fallthrough]];
+		case VALUE:
+			return value(p);
+
+		case KEY_OR_END:
+			if(*p == '}')
+				return close(false);
+
+			[[fallthrough]];
+		case KEY:
+			st = NAME_SEP;
+			return *p == '"';
+
+		case NAME_SEP:
+			st = VALUE;
+			return *p == ':';
+
+		case VALUE_SEP_OR_END:
+			if(*p == ']' || *p == '}')
+				return close(*p == ']');
+
+			assert(depth);
+			st = (stack >> (depth - 1)) & 1? VALUE: KEY;
+			return *p == ',';
+
+		case DONE:
+			break;
+	}
+
+	return false;
+}
+
+bool
+ircd::json::scanner::value(const char *const &p)
+noexcept
+{
+	switch(*p)
+	{
+		case '{':
+			return open(false);
+
+		case '[':
+			return open(true);
+
+		case '"':
+			return after_value();
+
+		default:
+			return scalar(p, stop) && after_value();
+	}
+}
+
+bool
+ircd::json::scanner::open(const bool &array)
+noexcept
+{
+	if(unlikely(depth >= depth_max))
+		return false;
+
+	stack &= ~(1UL << depth);
+	stack |= u64(array) << depth;
+	st = array? VALUE_OR_END: KEY_OR_END;
+	++depth;
+	return true;
+}
+
+bool
+ircd::json::scanner::close(const bool &array)
+noexcept
+{
+	if(unlikely(!depth || bool((stack >> (depth - 1)) & 1) != array))
+		return false;
+
+	--depth;
+	return after_value();
+}
+
+bool
+ircd::json::scanner::after_value()
+noexcept
+{
+	st = depth? VALUE_SEP_OR_END: DONE;
+	return true;
+}
+
+/// Every escaped character within a string is one of the canonical escapes;
+/// the four digits of a unicode escape are found in the input itself, as they
+/// may straddle the end of the chunk.
+bool
+ircd::json::scanner::escapes(const char *const &at,
+                             const char *const &stop,
+                             u64 escaped)
+noexcept
+{
+	for(; escaped; escaped &= escaped - 1)
+	{
+		const char *const p
+		{
+			at + __builtin_ctzl(escaped)
+		};
+
+		if(unlikely(p >= stop))
+			return false;
+
+		switch(*p)
+		{
+			case '"':
+			case '\\':
+			case '/':
+			case 'b':
+			case 'f':
+			case 'n':
+			case 'r':
+			case 't':
+				continue;
+
+			case 'u':
+				if(unlikely(p + 5 > stop))
+					return false;
+
+				if(unlikely(!std::all_of(p + 1, p + 5, ::isxdigit)))
+					return false;
+
+				continue;
+
+			default:
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/// Length of the literal or number at p, or zero if there isn't one. The
+/// scalar must be followed by the end of input or a character which ends it.
+size_t
+ircd::json::scanner::scalar(const char *const p,
+                            const char *const &stop)
+noexcept
+{
+	const string_view s
+	{
+		p, stop
+	};
+
+	const size_t len
+	{
+		startswith(s, literal_true)?    size(literal_true):
+		startswith(s, literal_false)?   size(literal_false):
+		startswith(s, literal_null)?    size(literal_null):
+		                                number(p, stop)
+	};
+
+	if(!len || (p + len < stop && is_scalar_char(p[len])))
+		return 0;
+
+	return len;
+}
+
+/// Numbers within the bounds of the grammar; see parser::number.
+size_t
+ircd::json::scanner::number(const char *p,
+                            const char *const &stop)
+noexcept
+{
+	static const auto digits{[]
+	(const char *&p, const char *const &stop, const size_t &max)
+	{
+		const char *const start(p);
+		for(; p < stop && size_t(p - start) < max && isdigit(*p); ++p);
+		return size_t(p - start);
+	}};
+
+	const char *const start(p);
+	p += p < stop && *p == '-';
+	if(p >= stop || !isdigit(*p))
+		return 0;
+
+	if(*p == '0')
+		++p;
+	else
+		digits(p, stop, 19);
+
+	if(p < stop && *p == '.')
+		if(!digits(++p, stop, 18))
+			return 0;
+
+	if(p < stop && (*p == 'e' || *p == 'E'))
+	{
+		++p;
+		p += p < stop && (*p == '+' || *p == '-');
+		if(!digits(p, stop, 4))
+			return 0;
+	}
+
+	return p - start;
+}
+
+bool
+ircd::json::scanner::is_scalar_char(const char &c)
+noexcept
+{
+	switch(c)
+	{
+		case ' ':  case '\t':  case '\n':  case '\r':
+		case '{':  case '}':   case '[':   case ']':
+		case ':':  case ',':   case '"':
+			return false;
+
+		default:
+			return true;
+	}
+}
+
+ircd::json::scanner::masks
+ircd::json::scanner::classify(const char *const &in)
+noexcept
+{
+	masks ret;
+	for(size_t i(0); i < 64; i += sizeof(block_t))
+	{
+		const block_t block
+		(
+			*reinterpret_cast<const simd::unaligned<block_t> *>(in + i)
+		);
+
+		const block_t is_quote
+		(
+			block == '"'
+		);
+
+		const block_t is_backslash
+		(
+			block == '\\'
+		);
+
+		const block_t is_structural
+		(
+			(block == '{') | (block == '}') | (block == '[') | (block == ']') |
+			(block == ':') | (block == ',')
+		);
+
+		const block_t is_ws
+		(
+			(block == ' ') | (block == '\t') | (block == '\n') | (block == '\r')
+		);
+
+		const block_t is_ctrl
+		(
+			block < 0x20
+		);
+
+		ret.quote |= simd::movemask(is_quote) << i;
+		ret.backslash |= simd::movemask(is_backslash) << i;
+		ret.structural |= simd::movemask(is_structural) << i;
+		ret.ws |= simd::movemask(is_ws) << i;
+		ret.ctrl |= simd::movemask(is_ctrl) << i;
+	}
+
+	return ret;
+}
+
+/// Characters preceded by an odd number of backslashes. The carry indicates
+/// the first character of the next chunk is escaped.
+ircd::u64
+ircd::json::scanner::escaped(u64 backslash,
+                             u64 &carry)
+noexcept
+{
+	backslash &= ~carry;
+	const u64 follows_escape
+	{
+		backslash << 1 | carry
+	};
+
+	// Sequences of backslashes beginning on an odd bit are found by adding
+	// their first bit to them; the sum carries out of the sequences.
+	const u64 odd_sequence_starts
+	{
+		backslash & ~even_bits & ~follows_escape
+	};
+
+	u64 sequences_starting_on_even_bits;
+	carry = __builtin_add_overflow(odd_sequence_starts, backslash, &sequences_starting_on_even_bits);
+	const u64 invert_mask
+	{
+		sequences_starting_on_even_bits << 1
+	};
+
+	return (even_bits ^ invert_mask) & follows_escape;
+}
+
+/// Bit i of the result is the parity of bits 0 through i of the input.
+ircd::u64
+ircd::json::scanner::prefix_xor(u64 a)
+noexcept
+{
+	a ^= a << 1;
+	a ^= a << 2;
+	a ^= a << 4;
+	a ^= a << 8;
+	a ^= a << 16;
+	a ^= a << 32;
+	return a;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // json/util.h
@@ -4856,6 +5493,16 @@ catch(const std::exception &e)
 bool
 ircd::json::valid(const string_view &s,
                   std::nothrow_t)
+noexcept
+{
+	if(likely(scan(s)))
+		return true;
+
+	return parse_valid(s);
+}
+
+bool
+ircd::json::parse_valid(const string_view &s)
 noexcept try
 {
 	const char *start(begin(s)), *const stop(end(s));
@@ -4870,6 +5517,9 @@ catch(...)
 void
 ircd::json::valid(const string_view &s)
 {
+	if(likely(scan(s)))
+		return;
+
 	const char *start(begin(s)), *const stop(end(s));
 	const bool ret
 	{
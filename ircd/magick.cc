@@ -29,14 +29,21 @@ namespace ircd::magick
 	template<class R, class F, class... A> static R call(F&&, A&&...);
 	template<class R, class F, class... A> static R callex(F&&, A&&...);
 	template<class F, class... A> static void callpf(F&&, A&&...);
+	static size_t offload_limit() noexcept;
+	static void execute(const std::function<void ()> &);
 
 	extern bool call_ready;
 	extern ctx::dock call_dock;
 	extern ctx::mutex call_mutex;
+	extern size_t jobs_running;
 	extern conf::item<uint64_t> limit_ticks;
 	extern conf::item<uint64_t> limit_cycles;
 	extern conf::item<uint64_t> yield_threshold;
 	extern conf::item<uint64_t> yield_interval;
+	extern conf::item<bool> offload_enable;
+	extern conf::item<size_t> offload_max;
+	extern stats::item<uint64_t> offload_queued;
+	extern stats::item<uint64_t> offload_count;
 	extern log::log log;
 }
 
@@ -89,11 +96,58 @@ ircd::magick::yield_interval
 	{ "default", 768L                         },
 };
 
-// It is likely that we can't have two contexts enter libmagick
-// simultaneously. This race is possible if the progress callback yields
-// and another context starts an operation. It is highly unlikely the lib
-// can handle reentrancy on the same thread. Hitting thread mutexes within
-// magick will also be catastrophic to ircd::ctx.
+decltype(ircd::magick::offload_enable)
+ircd::magick::offload_enable
+{
+	{ "name",    "ircd.magick.offload.enable" },
+	{ "default", true                         },
+	{ "description",
+
+	R"(
+	Execute jobs on the ctx::ole offload threads; the requesting context only
+	waits for the result. When disabled jobs execute on the main thread one
+	at a time, yielding according to ircd.magick.yield.
+	)"}
+};
+
+decltype(ircd::magick::offload_max)
+ircd::magick::offload_max
+{
+	{ "name",    "ircd.magick.offload.max" },
+	{ "default", 0L                        },
+	{ "description",
+
+	R"(
+	Maximum number of jobs executing on offload threads at once. Requests
+	beyond this wait in queue. The offload threads are shared with other
+	users (see ircd.ctx.ole.thread.max); this is bounded by their number.
+	When zero all but one of them are used, leaving one for the rest.
+	)"}
+};
+
+decltype(ircd::magick::offload_queued)
+ircd::magick::offload_queued
+{
+	{ "name", "ircd.magick.offload.queued"                      },
+	{ "desc", "Number of jobs waiting for an offload slot"      },
+};
+
+decltype(ircd::magick::offload_count)
+ircd::magick::offload_count
+{
+	{ "name", "ircd.magick.offload.count"                       },
+	{ "desc", "Number of jobs executed on offload threads"      },
+};
+
+decltype(ircd::magick::jobs_running)
+ircd::magick::jobs_running;
+
+// Jobs executing on the main thread cannot enter libmagick simultaneously.
+// This race is possible if the progress callback yields and another context
+// starts an operation. It is highly unlikely the lib can handle reentrancy on
+// the same thread. Hitting thread mutexes within magick will also be
+// catastrophic to ircd::ctx. Jobs on the offload threads are instead bounded
+// by ircd.magick.offload.max and counted in jobs_running.
 decltype(ircd::magick::call_mutex)
 ircd::magick::call_mutex;
 
@@ -259,7 +313,7 @@ noexcept
 	call_ready = false;
 	call_dock.wait([]
 	{
-		return !call_mutex.locked();
+		return !call_mutex.locked() && !jobs_running;
 	});
 
 	DestroyMagick();
@@ -433,43 +487,53 @@ ircd::magick::crop::crop(const const_buffer &in,
 // transform (internal)
 //
 
+/// The decode, transformation and encode are one job; the output closure is
+/// called afterward on the calling context.
 ircd::magick::transform::transform(const const_buffer &input,
                                    const output &output,
                                    const transformer &transformer)
 {
-	const custom_ptr<ImageInfo> input_info
+	size_t output_size(0);
+	custom_ptr<void> output_data
 	{
-		CloneImageInfo(nullptr),
-		DestroyImageInfo
+		nullptr, handle_free
 	};
 
-	const custom_ptr<ImageInfo> output_info
+	execute([&input, &transformer, &output_size, &output_data]
 	{
-		CloneImageInfo(nullptr),
-		DestroyImageInfo
-	};
+		const custom_ptr<ImageInfo> input_info
+		{
+			CloneImageInfo(nullptr),
+			DestroyImageInfo
+		};
 
-	const custom_ptr<Image> input_image
-	{
-		callex<Image *>(BlobToImage, input_info.get(), data(input), size(input)),
-		DestroyImage // pollock
-	};
+		const custom_ptr<ImageInfo> output_info
+		{
+			CloneImageInfo(nullptr),
+			DestroyImageInfo
+		};
 
-	const custom_ptr<Image> output_image
-	{
-		transformer({*input_info, input_image.get()}),
-		DestroyImage
-	};
+		const custom_ptr<Image> input_image
+		{
+			callex<Image *>(BlobToImage, input_info.get(), data(input), size(input)),
+			DestroyImage // pollock
+		};
 
-	size_t output_size(0);
-	const auto output_data
-	{
-		callex<void *>(ImageToBlob, output_info.get(), output_image.get(), &output_size)
-	};
+		const custom_ptr<Image> output_image
+		{
+			transformer({*input_info, input_image.get()}),
+			DestroyImage
+		};
+
+		output_data.reset
+		(
+			callex<void *>(ImageToBlob, output_info.get(), output_image.get(), &output_size)
+		);
+	});
 
 	const const_buffer result
 	{
-		reinterpret_cast<char *>(output_data), output_size
+		reinterpret_cast<const char *>(output_data.get()), output_size
 	};
 
 	output(result);
@@ -481,28 +545,31 @@ ircd::magick::transform::transform(const const_buffer &input,
 
 ircd::magick::display::display(const const_buffer &input)
 {
-	const custom_ptr<ImageInfo> input_info
+	execute([&input]
 	{
-		CloneImageInfo(nullptr),
-		DestroyImageInfo
-	};
+		const custom_ptr<ImageInfo> input_info
+		{
+			CloneImageInfo(nullptr),
+			DestroyImageInfo
+		};
 
-	const custom_ptr<Image> input_image
-	{
-		callex<Image *>(BlobToImage, input_info.get(), data(input), size(input)),
-		DestroyImage // pollock
-	};
+		const custom_ptr<Image> input_image
+		{
+			callex<Image *>(BlobToImage, input_info.get(), data(input), size(input)),
+			DestroyImage // pollock
+		};
 
-	display
-	{
-		*input_info, *input_image
-	};
+		callpf(DisplayImages, input_info.get(), input_image.get());
+	});
 }
 
 ircd::magick::display::display(const ImageInfo &info,
                                Image &image)
 {
-	callpf(DisplayImages, &info, &image);
+	execute([&info, &image]
+	{
+		callpf(DisplayImages, &info, &image);
+	});
 }
 
 //
@@ -516,17 +583,6 @@ return_t
 ircd::magick::callex(function&& f,
                      args&&... a)
 {
-	if(unlikely(!call_ready))
-		throw error
-		{
-			"Graphics library not ready."
-		};
-
-	const std::lock_guard lock
-	{
-		call_mutex
-	};
-
 	ExceptionInfo ei;
 	GetExceptionInfo(&ei); // initializer
 	const unwind destroy{[&ei]
@@ -540,19 +596,12 @@ ircd::magick::callex(function&& f,
 		f(std::forward<args>(a)..., &ei)
 	};
 
-	const auto their_handler
-	{
-		SetErrorHandler(handle_exception)
-	};
+	// The ExceptionInfo is inspected here rather than through CatchException()
+	// because the latter reaches the error handler through global state which
+	// is not safe with jobs executing on several threads.
+	if(ei.severity >= ErrorException)
+		handle_exception(ei.severity, ei.reason, ei.description);
 
-	const unwind reset{[&their_handler]
-	{
-		SetErrorHandler(their_handler);
-	}};
-
-	// exception comes out of here; if this is not safe we'll have to
-	// convey with a global or inspect ExceptionInfo manually.
-	CatchException(&ei);
 	return ret;
 }
 
@@ -572,6 +621,38 @@ template<class return_t,
 return_t
 ircd::magick::call(function&& f,
                    args&&... a)
+{
+	assert(call_ready);
+	return f(std::forward<args>(a)...);
+}
+
+/// Number of jobs which may execute on offload threads at once; follows the
+/// number of threads.
+size_t
+ircd::magick::offload_limit()
+noexcept
+{
+	const size_t threads
+	{
+		ctx::ole::thread_count()
+	};
+
+	const size_t max
+	{
+		offload_max?
+			std::min(size_t(offload_max), threads):
+			threads - 1
+	};
+
+	return std::max(max, 1UL);
+}
+
+/// All calls into the library are made within a job given to this function.
+/// With offload enabled the job waits for one of the offload slots and then
+/// executes on an offload thread while this context waits. Otherwise it is
+/// executed here, one at a time.
+void
+ircd::magick::execute(const std::function<void ()> &job)
 {
 	if(unlikely(!call_ready))
 		throw error
@@ -579,13 +660,53 @@ ircd::magick::call(function&& f,
 			"Graphics library not ready."
 		};
 
-	const std::lock_guard lock
+	if(!offload_enable)
 	{
-		call_mutex
+		const std::lock_guard lock
+		{
+			call_mutex
+		};
+
+		job();
+		return;
+	}
+
+	{
+		const scope_count queued
+		{
+			static_cast<uint64_t &>(offload_queued)
+		};
+
+		call_dock.wait([]
+		{
+			return jobs_running < offload_limit() || !call_ready;
+		});
+	}
+
+	if(unlikely(!call_ready))
+		throw error
+		{
+			"Graphics library not ready."
+		};
+
+	++jobs_running;
+	const unwind running{[]
+	{
+		assert(jobs_running > 0);
+		--jobs_running;
+		call_dock.notify_all();
+	}};
+
+	static const ctx::ole::opts opts
+	{
+		"magick"
 	};
 
-	assert(call_ready);
-	return f(std::forward<args>(a)...);
+	++offload_count;
+	ctx::offload
+	{
+		opts, job
+	};
 }
 
 //
@@ -628,7 +749,9 @@ noexcept try
 	// and monotonically increases across jobs as well.
 	const auto cycles_sample
 	{
-		ctx::this_ctx::cycles()
+		ctx::is_main_thread()?
+			ctx::this_ctx::cycles():
+			prof::cycles()
 	};
 
 	// Detect if this is a new job. Tick is usually zero for a new job, but for
@@ -744,6 +867,10 @@ ircd::magick::check_yield(job &job)
 		magick::yield_threshold
 	};
 
+	// Jobs on offload threads have no context to yield.
+	if(!ctx::is_main_thread())
+		return false;
+
 	// This job is too small to conduct any yields.
 	if(likely(job.ticks < yield_threshold))
 		return false;
@@ -800,7 +927,7 @@ ircd::magick::job_init(const string_view &text,
 		job::state.description, lstrip(text, "[] ")
 	};
 
-	log::debug
+	if(ctx::is_main_thread()) log::debug
 	{
 		log, "job:%lu started; ticks:%lu :%s",
 		job::cur.id,
@@ -949,7 +1076,9 @@ ircd::magick::handle_exception(const ExceptionType type,
 		description,
 	}};
 
-	log::derror
+	// Off the main thread the exception is propagated to the waiting context
+	// and reported there.
+	if(ctx::is_main_thread()) log::derror
 	{
 		log, "%s %s",
 		loghead(job::cur),
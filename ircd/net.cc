@@ -1407,6 +1407,9 @@ ircd::net::socket::handshake(const open_opts &opts,
 	if(opts.send_sni && server_name(opts))
 		openssl::server_name(*this, server_name(opts));
 
+	if(!empty(opts.alpn))
+		openssl::alpn(*this, opts.alpn);
+
 	ssl.set_verify_callback(std::move(verify_handler));
 	ssl.async_handshake(handshake_type::client, ios::handle(desc_handshake, std::move(handshake_handler)));
 }
@@ -2330,6 +2333,10 @@ noexcept try
 	if(!ec)
 		blocking(*this, false);
 
+	// Record any protocol the remote selected from our offer.
+	if(!ec)
+		strlcpy(alpn, openssl::alpn(*this));
+
 	// This is the end of the asynchronous call chain; the user is called
 	// back with or without error here.
 	call_user(callback, ec);
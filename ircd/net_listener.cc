@@ -245,6 +245,19 @@ ircd::net::acceptor::timeout
 	{ "default",  12000L                      },
 };
 
+decltype(ircd::net::acceptor::alpn_h2)
+ircd::net::acceptor::alpn_h2
+{
+	{ "name",     "ircd.net.acceptor.alpn.h2" },
+	{ "default",  true                        },
+	{ "description",
+
+	R"(
+	Select HTTP/2 when it is offered by the client during the TLS handshake.
+	When false, or when not offered, connections proceed with HTTP/1.1.
+	)"}
+};
+
 /// The number of simultaneous handshakes we conduct across all clients.
 decltype(ircd::net::acceptor::handshaking_max)
 ircd::net::acceptor::handshaking_max
@@ -853,13 +866,23 @@ ircd::net::acceptor::handle_alpn(socket &socket,
 	}
 	#endif IRCD_NET_ACCEPTOR_DEBUG_ALPN
 
-	//NOTE: proto == "h2" condition goes here
-	for(const auto &proto : in)
-		if(proto == "http/1.1")
-		{
-			strlcpy(socket.alpn, proto);
-			return proto;
-		}
+	static const string_view preference[]
+	{
+		"h2", "http/1.1"
+	};
+
+	for(const auto &want : preference)
+	{
+		if(want == "h2" && !bool(alpn_h2))
+			continue;
+
+		for(const auto &proto : in)
+			if(proto == want)
+			{
+				strlcpy(socket.alpn, proto);
+				return proto;
+			}
+	}
 
 	return {};
 }
@@ -888,7 +911,7 @@ noexcept try
 	while(i < inlen && p < PROTOS_MAX)
 	{
 		const uint8_t &len(in[i++]);
-		if(unlikely(!len || i + len >= inlen))
+		if(unlikely(!len || i + len > inlen))
 			break;
 
 		protos[p++] = ircd::string_view
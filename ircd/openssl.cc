@@ -96,6 +96,47 @@ ircd::openssl::server_name(const SSL &ssl)
 	return ::SSL_get_servername(&ssl, type);
 }
 
+//
+// ALPN
+//
+
+void
+ircd::openssl::alpn(SSL &ssl,
+                    const vector_view<const string_view> &protos)
+{
+	uint8_t buf[256];
+	size_t len(0);
+	for(const auto &proto : protos)
+	{
+		assert(!empty(proto) && size(proto) <= 255);
+		if(len + 1 + size(proto) > sizeof(buf))
+			break;
+
+		buf[len++] = size(proto);
+		memcpy(buf + len, data(proto), size(proto));
+		len += size(proto);
+	}
+
+	// Unlike most of the API this returns zero on success.
+	if(unlikely(::SSL_set_alpn_protos(&ssl, buf, len) != 0))
+		throw error
+		{
+			"Failed to set %zu ALPN protocols", protos.size()
+		};
+}
+
+ircd::string_view
+ircd::openssl::alpn(const SSL &ssl)
+{
+	const uint8_t *proto(nullptr);
+	uint len(0);
+	::SSL_get0_alpn_selected(&ssl, &proto, &len);
+	return string_view
+	{
+		reinterpret_cast<const char *>(proto), len
+	};
+}
+
 //
 // Cipher suite
 //
@@ -523,14 +523,21 @@ try
 			seconds(default_timeout)
 	};
 
+	// The socket's timer is shared by every stream of an HTTP/2 connection;
+	// each stream carries its own timer instead (see client.cc).
 	const net::scope_timeout timeout
 	{
-		*client.sock, method_timeout, [this, &client]
-		(const bool &timed_out)
-		{
-			if(timed_out)
-				this->handle_timeout(client);
-		}
+		!client.stream?
+			net::scope_timeout
+			{
+				*client.sock, method_timeout, [this, &client]
+				(const bool &timed_out)
+				{
+					if(timed_out)
+						this->handle_timeout(client);
+				}
+			}:
+			net::scope_timeout{}
 	};
 
 	// Content that hasn't yet arrived is remaining
@@ -956,6 +963,8 @@ try
 	if(empty(chunk) && ignore_empty)
 		return 0UL;
 
+	// HTTP/2 frames the content itself; the chunk is written bare and the
+	// stream is ended when the handler returns.
 	char headbuf[32];
 	const const_buffer iov[]
 	{
@@ -969,17 +978,24 @@ try
 		http::response::chunk::terminator,
 	};
 
+	const vector_view<const const_buffer> bufs
+	{
+		c->stream?
+			vector_view<const const_buffer>(iov + 1, 1):
+			vector_view<const const_buffer>(iov)
+	};
+
 	const size_t wrote
 	{
 		this->wrote
 	};
 
-	this->wrote += c->write_all(iov);
+	this->wrote += c->write_all(bufs);
 	finished |= empty(chunk);
 	count++;
 
 	assert(this->wrote >= wrote);
-	assert(this->wrote >= 2 || !finished);
+	assert(this->wrote >= 2 || !finished || c->stream);
 	return this->wrote - wrote;
 }
 catch(...)
@@ -521,6 +521,46 @@ ircd::server::cancel(request &request)
 	return true;
 }
 
+/// Hold off reading the response of the request until it's unpaused. The
+/// remote is then held off by the flow control of the transport. This may be
+/// called from the progress callback. Links using HTTP/2 are always reading
+/// and are not held.
+bool
+ircd::server::pause(request &request,
+                    const bool &paused)
+{
+	if(!request.tag)
+		return false;
+
+	auto &tag
+	{
+		*request.tag
+	};
+
+	const bool was
+	{
+		std::exchange(tag.state.paused, paused)
+	};
+
+	if(paused || !was)
+		return true;
+
+	// Rearm the read on the link receiving the tag.
+	for(auto &[name, peer] : peers)
+		for(auto &link : peer->links)
+		{
+			if(link.queue.empty() || &link.queue.front() != &tag)
+				continue;
+
+			if(link.ready() && !link.finished())
+				link.wait_readable();
+
+			return true;
+		}
+
+	return true;
+}
+
 [[GCC::stack_protect]]
 void
 ircd::server::submit(const hostport &hostport,
@@ -2091,9 +2131,111 @@ ircd::server::link::tag_commit_max_default
 	{ "default",  3L                                }
 };
 
+decltype(ircd::server::link::h2_enable)
+ircd::server::link::h2_enable
+{
+	{ "name",     "ircd.server.link.h2.enable" },
+	{ "default",  true                         },
+	{ "description",
+
+	R"(
+	Offer HTTP/2 to remote servers by ALPN. When the remote selects it, the
+	requests to that peer are multiplexed as streams over one connection
+	rather than pipelined over several. Affects new connections only.
+	)"}
+};
+
+decltype(ircd::server::link::h2_tag_commit_max)
+ircd::server::link::h2_tag_commit_max
+{
+	{ "name",     "ircd.server.link.h2.tag_commit_max" },
+	{ "default",  64L                                  },
+	{ "description",
+
+	R"(
+	Maximum number of requests in flight on an HTTP/2 link. The remote's
+	SETTINGS_MAX_CONCURRENT_STREAMS further limits this when it is smaller.
+	)"}
+};
+
+decltype(ircd::server::link::h2_stack_size)
+ircd::server::link::h2_stack_size
+{
+	{ "name",     "ircd.server.link.h2.stack.size" },
+	{ "default",  long(128_KiB)                    },
+};
+
 decltype(ircd::server::link::ids)
 ircd::server::link::ids;
 
+/// HTTP/2 state of a link which negotiated "h2" by ALPN. Tags are sent as
+/// streams on the one connection and complete in any order, so a slow
+/// response no longer holds up those behind it. The asynchronous read/write
+/// machinery of the link is unused; http2::conn blocks on the socket and on
+/// flow control, so a writer and a reader context drive the connection.
+///
+/// The contexts hold a reference to this object and reach the link through
+/// the link pointer, which is nulled when the link is destroyed. Neither may
+/// hold a tag across a yield: the user may cancel the request and the peer
+/// may purge the queue in the meantime, so tags are found again by id. Only
+/// the writer removes streams, which keeps its references to them valid.
+///
+/// Responses are given to the tag as an HTTP/1.1 message so the existing
+/// grammars are reused; content without a length is fed in chunked encoding.
+struct ircd::server::link::h2
+:http2::conn
+{
+	struct stream;
+	using tag_iterator = std::list<tag>::iterator;
+
+	server::link *link;
+	std::map<uint32_t, stream> active;       // streams by id
+	std::string block;                       // header block being received
+	uint32_t continuation {0};               // stream awaiting CONTINUATION
+	bool continuation_end {false};           // END_STREAM of that HEADERS
+	bool draining {false};                   // remote sent GOAWAY
+	uint32_t next_id {1};                    // next stream to open
+	unique_buffer<mutable_buffer> scratch;   // content copied out of the tag
+	ctx::dock work;                          // notified for the writer
+
+	bool alive() const;
+	tag_iterator find_tag(const uint64_t &id);
+	void finish_tag(tag_iterator);
+
+	// receiving
+	void complete(stream &, tag_iterator);
+	void fail(stream &, std::exception_ptr);
+	void feed(stream &, const const_buffer &);
+	void end_remote(stream &);
+	void handle_data(stream &, const const_buffer &, const bool &end_stream);
+	void handle_head(const uint32_t &id, const bool &end_stream);
+	void handle_goaway();
+	void handle_frame(const http2::frame::header &, const const_buffer &);
+	void reader();
+
+	// transmitting
+	bool pending();
+	bool collect();
+	bool reset();
+	void submit(tag &);
+	void writer(std::shared_ptr<h2>);
+
+	static void start(server::link &);
+
+	h2(server::link &);
+};
+
+struct ircd::server::link::h2::stream
+:http2::stream
+{
+	uint64_t tag {0};                        // tag::state::id; 0 when finished
+	bool headed {false};                     // response head was fed to the tag
+	bool chunked {false};                    // content is fed as chunked encoding
+	bool reset {false};                      // RST_STREAM is to be sent
+
+	using http2::stream::stream;
+};
+
 ircd::string_view
 ircd::server::loghead(const link &link)
 {
@@ -2149,6 +2291,14 @@ noexcept
 {
 	assert(!busy());
 	assert(!opened());
+
+	// The contexts of an HTTP/2 link may outlive it; they find it gone.
+	if(h2)
+	{
+		h2->link = nullptr;
+		h2->close();
+		h2->work.notify_all();
+	}
 }
 
 void
@@ -2247,6 +2397,15 @@ ircd::server::link::cleanup_canceled()
 		it = queue.erase(it);
 	}
 
+	// Streams of canceled tags are reset individually by an HTTP/2 link.
+	if(h2)
+	{
+		if(dead)
+			h2->work.notify_all();
+
+		return;
+	}
+
 	// If every committed tag in the pipe is canceled we can close this link
 	// to quickly disperse any queued tags to another link or simply kill this
 	// link if it's timing out.
@@ -2277,6 +2436,15 @@ ircd::server::link::open(const net::open_opts &open_opts)
 		std::bind(&link::handle_open, this, ph::_1)
 	};
 
+	static const string_view alpn[]
+	{
+		"h2", "http/1.1"
+	};
+
+	net::open_opts opts{open_opts};
+	if(h2_enable)
+		opts.alpn = alpn;
+
 	op_init = true;
 	op_open = true;
 	const unwind_exceptional unhandled{[this]
@@ -2285,7 +2453,7 @@ ircd::server::link::open(const net::open_opts &open_opts)
 		op_open = false;
 	}};
 
-	socket = net::open(open_opts, std::move(handler));
+	socket = net::open(opts, std::move(handler));
 	op_open = false;
 
 	if(finished())
@@ -2305,7 +2473,9 @@ ircd::server::link::handle_open(std::exception_ptr eptr)
 	op_init = false;
 	synack_ts = time<seconds>();
 
-	if(!eptr && !op_fini)
+	if(!eptr && !op_fini && string_view(socket->alpn) == "h2")
+		h2::start(*this);
+	else if(!eptr && !op_fini)
 		wait_writable();
 
 	if(peer)
@@ -2325,6 +2495,13 @@ ircd::server::link::close(const net::close_opts &close_opts)
 	if(tag_count() && peer)
 		peer->disperse(*this);
 
+	// Wake the contexts of an HTTP/2 link so they observe op_fini.
+	if(h2)
+	{
+		h2->work.notify_all();
+		h2->dock.notify_all();
+	}
+
 	auto handler
 	{
 		std::bind(&link::handle_close, this, ph::_1)
@@ -2360,6 +2537,12 @@ ircd::server::link::wait_writable()
 	if(op_write || unlikely(op_fini))
 		return;
 
+	if(h2)
+	{
+		h2->work.notify_all();
+		return;
+	}
+
 	auto handler
 	{
 		std::bind(&link::handle_writable, this, ph::_1)
@@ -2547,6 +2730,14 @@ ircd::server::link::wait_readable()
 	if(op_read || op_fini)
 		return;
 
+	// The reader context of an HTTP/2 link is always reading.
+	if(h2)
+		return;
+
+	// The user is holding off the response being received; see pause().
+	if(!queue.empty() && queue.front().state.paused)
+		return;
+
 	assert(ready());
 	op_read = true;
 	const unwind_exceptional unhandled{[this]
@@ -2969,7 +3160,18 @@ size_t
 ircd::server::link::tag_commit_max()
 const
 {
-	return tag_commit_max_default;
+	if(!h2)
+		return tag_commit_max_default;
+
+	// Zero is the protocol's default here, which is unlimited.
+	const size_t remote_max
+	{
+		h2->remote[http2::settings::code::MAX_CONCURRENT_STREAMS]
+	};
+
+	return remote_max?
+		std::min(size_t(h2_tag_commit_max), remote_max):
+		size_t(h2_tag_commit_max);
 }
 
 size_t
@@ -2991,6 +3193,740 @@ const
 	});
 }
 
+//
+// link::h2
+//
+
+ircd::server::link::h2::h2(server::link &link)
+:http2::conn
+{
+	link.socket
+}
+,link
+{
+	&link
+}
+,scratch
+{
+	16_KiB
+}
+{
+}
+
+void
+ircd::server::link::h2::start(server::link &link)
+{
+	assert(!link.h2);
+	link.h2 = std::make_shared<struct h2>(link);
+	log::debug
+	{
+		log, "%s negotiated h2",
+		loghead(link),
+	};
+
+	context
+	{
+		"server.h2",
+		size_t(h2_stack_size),
+		context::DETACH,
+		[h2(link.h2)]
+		{
+			h2->writer(h2);
+		}
+	};
+}
+
+/// Sends the connection preface and then services the queue. Streams are
+/// started in the order of the queue as concurrency allows; the content of
+/// each is sent in full before starting the next.
+void
+ircd::server::link::h2::writer(std::shared_ptr<h2> self)
+try
+{
+	{
+		const std::lock_guard lock
+		{
+			write_mutex
+		};
+
+		net::write_all(*sock, const_buffer{http2::connection_preface});
+	}
+
+	write_settings();
+	if(!alive())
+		return;
+
+	context
+	{
+		"server.h2",
+		size_t(h2_stack_size),
+		context::DETACH,
+		[self(std::move(self))]
+		{
+			self->reader();
+		}
+	};
+
+	while(alive())
+	{
+		work.wait([this]
+		{
+			return pending();
+		});
+
+		if(!alive())
+			break;
+
+		if(collect())
+			continue;
+
+		if(reset())
+			continue;
+
+		auto it(begin(link->queue));
+		while(it != end(link->queue))
+		{
+			auto &tag{*it};
+			if((tag.abandoned() || tag.canceled()) && !tag.committed())
+			{
+				it = link->queue.erase(it);
+				continue;
+			}
+
+			if(!tag.committed())
+				break;
+
+			++it;
+		}
+
+		if(it != end(link->queue))
+			submit(*it);
+	}
+}
+catch(const std::exception &e)
+{
+	if(alive())
+		link->peer->handle_error(*link, std::current_exception());
+}
+
+bool
+ircd::server::link::h2::pending()
+{
+	if(!alive())
+		return true;
+
+	for(const auto &[id, stream] : active)
+	{
+		if(stream.closed() && !stream.tag)
+			return true;
+
+		if(stream.reset && !stream.closed())
+			return true;
+
+		if(!stream.tag)
+			continue;
+
+		const auto it(find_tag(stream.tag));
+		if(it == end(link->queue) || !it->request || it->canceled())
+			return true;
+	}
+
+	if(draining || active.size() >= link->tag_commit_max())
+		return false;
+
+	return std::any_of(begin(link->queue), end(link->queue), []
+	(const auto &tag)
+	{
+		return !tag.committed();
+	});
+}
+
+/// Removes finished streams. Does not yield.
+bool
+ircd::server::link::h2::collect()
+{
+	size_t ret(0);
+	for(auto it(begin(active)); it != end(active); )
+	{
+		auto &stream(it->second);
+		if(!stream.closed() || stream.tag)
+		{
+			++it;
+			continue;
+		}
+
+		del(stream);
+		it = active.erase(it);
+		++ret;
+	}
+
+	return ret;
+}
+
+/// Resets one stream which is no longer wanted: either the request was
+/// canceled by the user, or the tag is gone while the stream is still open.
+bool
+ircd::server::link::h2::reset()
+{
+	for(auto &[id, stream] : active)
+	{
+		if(stream.closed() || (!stream.tag && !stream.reset))
+			continue;
+
+		const auto it(find_tag(stream.tag));
+		const bool wanted
+		{
+			!stream.reset &&
+			it != end(link->queue) && it->request && !it->canceled()
+		};
+
+		if(wanted)
+			continue;
+
+		const uint64_t tag_id(stream.tag);
+		stream.tag = 0;
+		write_rst_stream(stream, http2::error::CANCEL);
+		if(!alive())
+			return true;
+
+		const auto jt(find_tag(tag_id));
+		if(jt != end(link->queue))
+			finish_tag(jt);
+
+		return true;
+	}
+
+	return false;
+}
+
+/// Starts the tag on a new stream. The head and each piece of content are
+/// accounted as written to the tag before yielding so that a cancellation
+/// in the meantime takes the committed path, and the content is copied out
+/// first since the user's buffer may be freed by that.
+void
+ircd::server::link::h2::submit(tag &tag)
+{
+	const uint32_t id(next_id);
+	next_id += 2;
+	auto &stream
+	{
+		active.emplace(std::piecewise_construct, std::make_tuple(id), std::make_tuple(id)).first->second
+	};
+
+	stream.tag = tag.state.id;
+	add(stream);
+
+	log::debug
+	{
+		log, "%s starting on tag:%lu stream:%u %zu of %zu: wt:%zu [%s]",
+		loghead(*link),
+		tag.state.id,
+		id,
+		active.size(),
+		link->tag_count(),
+		tag.write_size(),
+		tag.request?
+			loghead(*tag.request):
+			"<no attached request>"_sv
+	};
+
+	const const_buffer head
+	{
+		tag.make_write_head_buffer()
+	};
+
+	const bool content
+	{
+		tag.write_size() > size(head)
+	};
+
+	tag.wrote_buffer(head);
+	link->peer->write_bytes += size(head);
+	write_head(stream, head, !content);
+	while(alive() && !stream.local_closed())
+	{
+		dock.wait([this, &stream]
+		{
+			return !alive() || stream.local_closed() || (send_window > 0 && stream.send_window > 0);
+		});
+
+		if(!alive() || stream.local_closed())
+			break;
+
+		const auto it(find_tag(stream.tag));
+		if(it == end(link->queue) || !it->request || !it->write_remaining())
+		{
+			stream.reset = true;
+			break;
+		}
+
+		const const_buffer buf
+		{
+			it->make_write_buffer()
+		};
+
+		const size_t len
+		{
+			std::min
+			({
+				size(buf),
+				size(scratch),
+				size_t(send_window),
+				size_t(stream.send_window),
+				size_t(remote[http2::settings::code::MAX_FRAME_SIZE]),
+			})
+		};
+
+		const const_buffer piece
+		{
+			data(scratch), copy(scratch, const_buffer{buf, len})
+		};
+
+		it->wrote_buffer(const_buffer{buf, len});
+		link->peer->write_bytes += len;
+		link->write_ts = time<seconds>();
+		write_data(stream, {&piece, 1}, !it->write_remaining());
+	}
+}
+
+void
+ircd::server::link::h2::reader()
+try
+{
+	while(alive())
+	{
+		http2::frame::header header;
+		const const_buffer payload
+		{
+			read(header)
+		};
+
+		if(!alive())
+			break;
+
+		link->read_ts = time<seconds>();
+		link->peer->read_bytes += sizeof(header) + size(payload);
+		if(unlikely(continuation))
+			if(header.type != http2::frame::type::CONTINUATION || header.stream_id != continuation)
+				throw http2::error
+				{
+					http2::error::PROTOCOL_ERROR, "expected CONTINUATION of stream %u",
+					continuation,
+				};
+
+		// Connection frames may write a reply and yield.
+		if(handle(header, payload))
+		{
+			if(alive() && goaway != -1U && !draining)
+				handle_goaway();
+
+			continue;
+		}
+
+		if(!alive())
+			break;
+
+		handle_frame(header, payload);
+	}
+}
+catch(const http2::error &e)
+{
+	const auto eptr(std::current_exception());
+	if(alive()) try
+	{
+		write_goaway(e.code);
+	}
+	catch(...) {}
+
+	if(alive())
+		link->peer->handle_error(*link, eptr);
+}
+catch(const std::system_error &e)
+{
+	if(alive())
+		link->peer->handle_error(*link, e);
+}
+catch(const std::exception &e)
+{
+	if(alive())
+		link->peer->handle_error(*link, std::current_exception());
+}
+
+/// Frames for streams. Nothing here yields.
+void
+ircd::server::link::h2::handle_frame(const http2::frame::header &header,
+                                     const const_buffer &payload)
+{
+	using http2::frame;
+	using http2::error;
+
+	const auto it
+	{
+		active.find(header.stream_id)
+	};
+
+	stream *const stream
+	{
+		it != end(active)? &it->second: nullptr
+	};
+
+	switch(header.type)
+	{
+		case frame::type::HEADERS:
+		{
+			if(unlikely(~header.stream_id & 1 || header.stream_id >= next_id))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "HEADERS for stream %u not opened",
+					uint(header.stream_id),
+				};
+
+			const const_buffer fragment
+			{
+				http2::conn::payload(header, payload)
+			};
+
+			block.assign(data(fragment), size(fragment));
+			if(~header.flags & frame::flag::END_HEADERS)
+			{
+				continuation = header.stream_id;
+				continuation_end = header.flags & frame::flag::END_STREAM;
+				return;
+			}
+
+			handle_head(header.stream_id, header.flags & frame::flag::END_STREAM);
+			return;
+		}
+
+		case frame::type::CONTINUATION:
+		{
+			if(unlikely(!continuation))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "unexpected CONTINUATION on stream %u",
+					uint(header.stream_id),
+				};
+
+			if(unlikely(size(block) + size(payload) > size_t(http2::conn::head_max) * 2))
+				throw error
+				{
+					error::ENHANCE_YOUR_CALM, "header block on stream %u too large",
+					uint(header.stream_id),
+				};
+
+			block.append(data(payload), size(payload));
+			if(~header.flags & frame::flag::END_HEADERS)
+				return;
+
+			continuation = 0;
+			handle_head(header.stream_id, continuation_end);
+			return;
+		}
+
+		case frame::type::DATA:
+		{
+			// Flow control was accounted by the conn; DATA for a stream which
+			// we've finished with is dropped.
+			if(!stream)
+				return;
+
+			if(!stream->tag)
+				return header.flags & frame::flag::END_STREAM?
+					end_remote(*stream):
+					void();
+
+			if(unlikely(!stream->headed))
+				throw error
+				{
+					error::PROTOCOL_ERROR, "DATA before HEADERS on stream %u",
+					uint(header.stream_id),
+				};
+
+			handle_data(*stream, http2::conn::payload(header, payload), header.flags & frame::flag::END_STREAM);
+			return;
+		}
+
+		case frame::type::RST_STREAM:
+		{
+			if(!stream)
+				return;
+
+			stream->state = http2::stream::state::CLOSED;
+			if(stream->tag)
+				fail(*stream, make_exception_ptr<error>
+				(
+					"Stream %u reset by remote", uint(header.stream_id)
+				));
+
+			work.notify_all();
+			return;
+		}
+
+		case frame::type::PUSH_PROMISE:
+			throw error
+			{
+				error::PROTOCOL_ERROR, "PUSH_PROMISE was disabled"
+			};
+
+		default:
+			return;
+	}
+}
+
+/// The header block is complete. It is decoded even when the stream is gone
+/// to keep the decoder's table in sync with the remote's encoder.
+void
+ircd::server::link::h2::handle_head(const uint32_t &id,
+                                    const bool &end_stream)
+{
+	const auto it
+	{
+		active.find(id)
+	};
+
+	http2::stream discard;
+	auto *const stream
+	{
+		it != end(active) && it->second.tag? &it->second: nullptr
+	};
+
+	const bool valid
+	{
+		read_head(stream? *stream: discard, string_view(block))
+	};
+
+	block.clear();
+	if(!stream && it != end(active) && end_stream)
+		end_remote(it->second);
+
+	if(!stream)
+		return;
+
+	if(!valid)
+		return fail(*stream, make_exception_ptr<http2::error>
+		(
+			"Invalid response head on stream %u", id
+		));
+
+	// Trailers are ignored but they may end the stream.
+	if(stream->headed)
+		return end_stream?
+			handle_data(*stream, {}, true):
+			void();
+
+	// Informational heads precede the response.
+	if(startswith(token(stream->head, ' ', 1), '1'))
+		return end_stream?
+			fail(*stream, make_exception_ptr<http2::error>("No response on stream %u", id)):
+			void();
+
+	bool has_length(false);
+	tokens(stream->head, "\r\n", [&has_length]
+	(const string_view &line)
+	{
+		has_length |= iequals(split(line, ':').first, "content-length"_sv);
+	});
+
+	std::string head(std::move(stream->head));
+	stream->head = {};
+	stream->chunked = !has_length && !end_stream;
+	if(!has_length && end_stream)
+		head.append("content-length: 0\r\n");
+
+	if(stream->chunked)
+		head.append("transfer-encoding: chunked\r\n");
+
+	head.append("\r\n");
+	stream->headed = true;
+	feed(*stream, string_view(head));
+	if(end_stream)
+		handle_data(*stream, {}, true);
+}
+
+void
+ircd::server::link::h2::handle_data(stream &stream,
+                                    const const_buffer &content,
+                                    const bool &end_stream)
+{
+	if(!empty(content) && stream.chunked)
+	{
+		char buf[24];
+		feed(stream, string_view(fmt::sprintf{buf, "%zx\r\n", size(content)}));
+		feed(stream, content);
+		feed(stream, "\r\n"_sv);
+	}
+	else if(!empty(content))
+		feed(stream, content);
+
+	if(!end_stream)
+		return;
+
+	end_remote(stream);
+	if(stream.chunked)
+		feed(stream, "0\r\n\r\n"_sv);
+
+	if(stream.tag)
+		fail(stream, make_exception_ptr<http2::error>
+		(
+			"Stream %u ended before the response was complete", stream.id
+		));
+}
+
+void
+ircd::server::link::h2::end_remote(stream &stream)
+{
+	stream.state = stream.local_closed()?
+		http2::stream::state::CLOSED:
+		http2::stream::state::HALF_CLOSED_REMOTE;
+
+	work.notify_all();
+}
+
+/// Gives data to the tag the way link::process_read_next() does with data
+/// read off the socket: copied into the buffer the tag asks for.
+void
+ircd::server::link::h2::feed(stream &stream,
+                             const const_buffer &buf)
+try
+{
+	if(!stream.tag)
+		return;
+
+	const auto it(find_tag(stream.tag));
+	if(it == end(link->queue) || !it->request || it->canceled())
+	{
+		stream.reset = !stream.closed();
+		work.notify_all();
+		return;
+	}
+
+	auto &tag{*it};
+	bool done{false};
+	const_buffer src{buf};
+	while(!empty(src) && !done)
+	{
+		const mutable_buffer dst
+		{
+			tag.make_read_buffer()
+		};
+
+		if(unlikely(empty(dst)))
+			throw buffer_overrun
+			{
+				"Buffer is insufficient to receive the HTTP response."
+			};
+
+		const size_t copied
+		{
+			copy(dst, src)
+		};
+
+		consume(src, copied);
+		tag.read_buffer(const_buffer{dst, copied}, done, *link);
+	}
+
+	if(done)
+		complete(stream, it);
+}
+catch(const std::exception &e)
+{
+	fail(stream, std::current_exception());
+}
+
+void
+ircd::server::link::h2::complete(stream &stream,
+                                 tag_iterator it)
+{
+	// A stream the remote has not yet ended is reset in case it never does.
+	assert(stream.tag == it->state.id);
+	stream.tag = 0;
+	stream.reset = !stream.remote_closed();
+	link->peer->handle_tag_done(*link, *it);
+	++link->tag_done;
+	finish_tag(it);
+}
+
+void
+ircd::server::link::h2::fail(stream &stream,
+                             std::exception_ptr eptr)
+{
+	const auto it(find_tag(stream.tag));
+	stream.tag = 0;
+	stream.reset = !stream.closed();
+	work.notify_all();
+	if(it == end(link->queue))
+		return;
+
+	log::derror
+	{
+		log, "%s tag:%lu stream:%u :%s",
+		loghead(*link),
+		it->state.id,
+		stream.id,
+		what(eptr),
+	};
+
+	it->set_exception(std::move(eptr));
+	finish_tag(it);
+}
+
+/// Streams beyond the last one the remote will process are failed; the
+/// uncommitted tags go to another link and this one closes when done.
+void
+ircd::server::link::h2::handle_goaway()
+{
+	assert(!draining);
+	draining = true;
+	link->exclude = true;
+	log::dwarning
+	{
+		log, "%s GOAWAY last stream:%u active:%zu",
+		loghead(*link),
+		goaway,
+		active.size(),
+	};
+
+	for(auto &[id, stream] : active)
+		if(id > goaway && stream.tag)
+			fail(stream, make_exception_ptr<unavailable>
+			(
+				"Stream %u refused by GOAWAY from remote", id
+			));
+
+	if(!alive())
+		return;
+
+	link->peer->disperse_uncommitted(*link);
+	if(link->queue.empty())
+		link->close();
+}
+
+void
+ircd::server::link::h2::finish_tag(tag_iterator it)
+{
+	link->queue.erase(it);
+	work.notify_all();
+	if(link->queue.empty() && !link->op_fini)
+		link->peer->handle_link_done(*link);
+}
+
+ircd::server::link::h2::tag_iterator
+ircd::server::link::h2::find_tag(const uint64_t &id)
+{
+	return std::find_if(begin(link->queue), end(link->queue), [&id]
+	(const auto &tag)
+	{
+		return id && tag.state.id == id;
+	});
+}
+
+bool
+ircd::server::link::h2::alive()
+const
+{
+	return link && !link->op_fini;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // server/tag.h
@@ -3483,7 +4419,7 @@ ircd::server::tag::read_head(const const_buffer &buffer,
 
 	// Alternatively branch for a feature that allows dynamic allocation of
 	// the content buffer if the user did not specify any buffer.
-	const bool dynamic
+	bool dynamic
 	{
 		!contiguous && empty(req.in.content)
 	};
@@ -3535,6 +4471,15 @@ ircd::server::tag::read_head(const const_buffer &buffer,
 	// will return anything beyond this message as overrun and indicate done.
 	if(head.transfer_encoding == "chunked")
 	{
+		// A content window cannot frame the chunk heads; the chunks are
+		// received into dynamic buffers instead.
+		assert(req.opt);
+		if(req.opt->content_window && !contiguous && !dynamic)
+		{
+			req.in.content = {};
+			dynamic = true;
+		}
+
 		if(dynamic)
 		{
 			assert(req.opt);
@@ -3656,9 +4601,13 @@ ircd::server::tag::read_content(const const_buffer &buffer,
 	assert(state.content_read <= state.content_length);
 
 	// Invoke the user's optional progress callback; this function
-	// should be marked noexcept for the time being.
+	// should be marked noexcept for the time being. The second argument is
+	// bounded by the content buffer, i.e. the window in window mode.
 	if(req.in.progress)
-		req.in.progress(buffer, const_buffer{content, state.content_read});
+		req.in.progress(buffer, const_buffer
+		{
+			content, std::min(state.content_read, size(content))
+		});
 
 	// Finished with content
 	if(state.content_read == size(content) + content_overflow())
@@ -3680,7 +4629,7 @@ ircd::server::content_completed(tag &tag,
 
 	assert(req.opt);
 	assert(tag.state.content_read == tag.state.content_length);
-	if(tag.content_overflow() && !req.opt->truncate_content)
+	if(tag.content_overflow() && !req.opt->truncate_content && !req.opt->content_window)
 	{
 		assert(tag.state.content_read > size(content));
 		tag.set_exception<buffer_overrun>
@@ -4201,7 +5150,7 @@ ircd::server::chunk_dynamic_content_completed(tag &tag,
 
 	assert(state.chunk_read == 0);
 	assert(req.opt);
-	if(req.opt->contiguous_content && !req.in.chunks.empty())
+	if(req.opt->contiguous_content && !req.opt->content_window && !req.in.chunks.empty())
 		chunk_dynamic_contiguous_copy(state, req);
 
 	assert(!done);
@@ -4280,7 +5229,7 @@ const
 		state.chunk_length?
 			make_read_chunk_content_buffer():
 
-		state.content_read >= size(request->in.content)?
+		state.content_read >= size(request->in.content) && !request->opt->content_window?
 			make_read_discard_buffer():
 
 		make_read_content_buffer()
@@ -4321,9 +5270,16 @@ const
 	assert(request);
 	const auto &req{*request};
 	const auto &content{req.in.content};
+	const size_t offset
+	{
+		req.opt->content_window && !empty(content)?
+			state.content_read % size(content):
+			state.content_read
+	};
+
 	const mutable_buffer buffer
 	{
-		content + state.content_read
+		content + offset
 	};
 
 	if(unlikely(empty(buffer)))
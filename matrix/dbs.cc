@@ -133,12 +133,18 @@ ircd::m::dbs::init::init(const string_view &servername,
 	event_sender = db::domain{*events, desc::event_sender.name};
 	event_type = db::domain{*events, desc::event_type.name};
 	event_state = db::domain{*events, desc::event_state.name};
+	event_term = db::domain{*events, desc::event_term.name};
+	event_chain = db::column{*events, desc::event_chain.name};
+	chain_event = db::domain{*events, desc::chain_event.name};
 	room_head = db::domain{*events, desc::room_head.name};
 	room_events = db::domain{*events, desc::room_events.name};
 	room_type = db::domain{*events, desc::room_type.name};
+	room_count = db::domain{*events, desc::room_count.name};
+	room_stats = db::domain{*events, desc::room_stats.name};
 	room_joined = db::domain{*events, desc::room_joined.name};
 	room_state = db::domain{*events, desc::room_state.name};
 	room_state_space = db::domain{*events, desc::room_state_space.name};
+	user_touch = db::domain{*events, desc::user_touch.name};
 }
 
 /// Shuts down the m::dbs subsystem; closes the events database. The extern
@@ -349,6 +355,12 @@ ircd::m::dbs::_index_event(db::txn &txn,
 	if(opts.appendix.test(appendix::EVENT_STATE))
 		_index_event_state(txn, event, opts);
 
+	if(opts.appendix.test(appendix::EVENT_TERM) && json::get<"room_id"_>(event))
+		_index_event_term(txn, event, opts);
+
+	if(opts.appendix.test(appendix::EVENT_CHAIN) && defined(json::get<"state_key"_>(event)))
+		_index_event_chain(txn, event, opts);
+
 	if(opts.appendix.test(appendix::EVENT_REFS) && opts.event_refs.any())
 		_index_event_refs(txn, event, opts);
 
@@ -379,6 +391,12 @@ ircd::m::dbs::_prefetch_event(const event &event,
 	if(opts.appendix.test(appendix::EVENT_STATE))
 		;//ret += _prefetch_event_state(txn, event, opts);
 
+	if(opts.appendix.test(appendix::EVENT_TERM))
+		;//ret += _prefetch_event_term(txn, event, opts);
+
+	if(opts.appendix.test(appendix::EVENT_CHAIN))
+		;//ret += _prefetch_event_chain(txn, event, opts);
+
 	if(opts.appendix.test(appendix::EVENT_REFS) && opts.event_refs.any())
 		ret += _prefetch_event_refs(event, opts);
 
@@ -401,12 +419,19 @@ ircd::m::dbs::_index_room(db::txn &txn,
 	if(opts.appendix.test(appendix::ROOM_TYPE))
 		_index_room_type(txn, event, opts);
 
+	if(opts.appendix.test(appendix::ROOM_COUNT))
+		_index_room_count(txn, event, opts);
+
 	if(opts.appendix.test(appendix::ROOM_HEAD))
 		_index_room_head(txn, event, opts);
 
 	if(opts.appendix.test(appendix::ROOM_HEAD_RESOLVE))
 		_index_room_head_resolve(txn, event, opts);
 
+	// Precedes ROOM_STATE to find the state being replaced.
+	if(opts.appendix.test(appendix::ROOM_STATS))
+		_index_room_stats(txn, event, opts);
+
 	if(defined(json::get<"state_key"_>(event)))
 	{
 		if(opts.appendix.test(appendix::ROOM_STATE))
@@ -419,6 +444,9 @@ ircd::m::dbs::_index_room(db::txn &txn,
 			_index_room_joined(txn, event, opts);
 	}
 
+	if(opts.appendix.test(appendix::USER_TOUCH) && user_touch_enable)
+		_index_user_touch(txn, event, opts);
+
 	if(opts.appendix.test(appendix::ROOM_REDACT) && json::get<"type"_>(event) == "m.room.redaction")
 		_index_room_redact(txn, event, opts);
 }
@@ -442,6 +470,9 @@ ircd::m::dbs::_prefetch_room(const event &event,
 	if(opts.appendix.test(appendix::ROOM_HEAD_RESOLVE))
 		;//ret += _prefetch_room_head_resolve(event, opts);
 
+	if(opts.appendix.test(appendix::ROOM_STATS))
+		;//ret += _prefetch_room_stats(event, opts);
+
 	if(defined(json::get<"state_key"_>(event)))
 	{
 		if(opts.appendix.test(appendix::ROOM_STATE))
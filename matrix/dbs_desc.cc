@@ -505,6 +505,18 @@ ircd::m::dbs::desc::events
 	// Mapping of event states, indexed for application features.
 	event_state,
 
+	// term | room_id, event_idx => frequency
+	// Inverted index of the terms in the content.body of events.
+	event_term,
+
+	// event_idx => chain, seq, (chain, seq)...
+	// Chain cover labels of the auth graph.
+	event_chain,
+
+	// chain | seq => event_idx
+	// Events of each chain of the auth graph in order.
+	chain_event,
+
 	// (room_id, (depth, event_idx))
 	// Sequence of all events for a room, ever.
 	room_events,
@@ -513,6 +525,14 @@ ircd::m::dbs::desc::events
 	// Sequence of all events by type for a room.
 	room_type,
 
+	// (room_id, type, event_idx) => (rank)
+	// Running count of events for a room, and of some types in a room.
+	room_count,
+
+	// (room_id, (counter, host)) => (int64)
+	// Counters for a room maintained by merge.
+	room_stats,
+
 	// (room_id, (origin, user_id))
 	// Sequence of all PRESENTLY JOINED joined for a room.
 	room_joined,
@@ -529,6 +549,10 @@ ircd::m::dbs::desc::events
 	// Mapping of all current head events for a room.
 	room_head,
 
+	// (user_id, room_id) => (event_idx)
+	// Last event concerning a room for each of its local users.
+	user_touch,
+
 	//
 	// These columns are legacy; they have been dropped from the schema.
 	//
@@ -0,0 +1,566 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static bool _event_chain_tip(const chain_pos &, const write_opts &);
+	static void _index_event_chain_set(db::txn &, const event &, const write_opts &); //query
+	static void _index_event_chain_del(db::txn &, const event &, const write_opts &); //query
+	static bool chain_event__cmp_less(const string_view &a, const string_view &b);
+}
+
+decltype(ircd::m::dbs::event_chain)
+ircd::m::dbs::event_chain;
+
+decltype(ircd::m::dbs::chain_event)
+ircd::m::dbs::chain_event;
+
+//
+// event_chain
+//
+
+decltype(ircd::m::dbs::desc::event_chain__comp)
+ircd::m::dbs::desc::event_chain__comp
+{
+	{ "name",     "ircd.m.dbs._event_chain.comp" },
+	{ "default",  "default"                      },
+};
+
+decltype(ircd::m::dbs::desc::event_chain__block__size)
+ircd::m::dbs::desc::event_chain__block__size
+{
+	{ "name",     "ircd.m.dbs._event_chain.block.size" },
+	{ "default",  512L                                 },
+};
+
+decltype(ircd::m::dbs::desc::event_chain__meta_block__size)
+ircd::m::dbs::desc::event_chain__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._event_chain.meta_block.size" },
+	{ "default",  512L                                      },
+};
+
+decltype(ircd::m::dbs::desc::event_chain__cache__size)
+ircd::m::dbs::desc::event_chain__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_chain.cache.size" },
+		{ "default",  long(16_MiB)                         },
+	}, []
+	{
+		const size_t &value{event_chain__cache__size};
+		db::capacity(db::cache(dbs::event_chain), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::event_chain__cache_comp__size)
+ircd::m::dbs::desc::event_chain__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_chain.cache_comp.size" },
+		{ "default",  long(0_MiB)                               },
+	}, []
+	{
+		const size_t &value{event_chain__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::event_chain), value);
+	}
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::event_chain
+{
+	// name
+	"_event_chain",
+
+	// explanation
+	R"(Chain cover labels of the auth graph.
+
+	event_idx => chain, seq, (chain, seq)...
+
+	Every state event is placed on a chain at some seq. An event extends the
+	chain of one of its auth_events when that event is the chain's tip;
+	otherwise it starts a new chain identified by its own event_idx. Every
+	event on a chain is therefor in the auth chain of every event after it
+	on that chain.
+
+	Following the event's own position, the value lists the greatest seq of
+	each chain found in the event's auth chain. An event A is in the auth
+	chain of B when A's seq is at most the seq listed by B for A's chain;
+	the auth chain of B is all events of the listed chains up to the listed
+	seq's (see: _chain_event). State events whose auth_events are not all
+	labeled are not labeled either; readers fall back to a graph traversal.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(uint64_t), typeid(string_view)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	{},
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(event_chain__block__size),
+
+	// meta_block size
+	size_t(event_chain__meta_block__size),
+
+	// compression
+	string_view{event_chain__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// chain_event
+//
+
+decltype(ircd::m::dbs::desc::chain_event__comp)
+ircd::m::dbs::desc::chain_event__comp
+{
+	{ "name",     "ircd.m.dbs._chain_event.comp" },
+	{ "default",  "default"                      },
+};
+
+decltype(ircd::m::dbs::desc::chain_event__block__size)
+ircd::m::dbs::desc::chain_event__block__size
+{
+	{ "name",     "ircd.m.dbs._chain_event.block.size" },
+	{ "default",  512L                                 },
+};
+
+decltype(ircd::m::dbs::desc::chain_event__meta_block__size)
+ircd::m::dbs::desc::chain_event__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._chain_event.meta_block.size" },
+	{ "default",  512L                                      },
+};
+
+decltype(ircd::m::dbs::desc::chain_event__cache__size)
+ircd::m::dbs::desc::chain_event__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._chain_event.cache.size" },
+		{ "default",  long(16_MiB)                         },
+	}, []
+	{
+		const size_t &value{chain_event__cache__size};
+		db::capacity(db::cache(dbs::chain_event), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::chain_event__cache_comp__size)
+ircd::m::dbs::desc::chain_event__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._chain_event.cache_comp.size" },
+		{ "default",  long(0_MiB)                               },
+	}, []
+	{
+		const size_t &value{chain_event__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::chain_event), value);
+	}
+};
+
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::chain_event__pfx
+{
+	"_chain_event",
+	[](const string_view &key)
+	{
+		return size(key) >= sizeof(uint64_t) * 2;
+	},
+
+	[](const string_view &key)
+	{
+		assert(size(key) >= sizeof(uint64_t));
+		return string_view
+		{
+			data(key), data(key) + sizeof(uint64_t)
+		};
+	}
+};
+
+const ircd::db::comparator
+ircd::m::dbs::desc::chain_event__cmp
+{
+	"_chain_event",
+	chain_event__cmp_less,
+	db::cmp_string_view::equal,
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::chain_event
+{
+	// name
+	"_chain_event",
+
+	// explanation
+	R"(Events of each chain of the auth graph in order.
+
+	chain | seq => event_idx
+
+	Inverse of the position held in _event_chain. The prefix transform is in
+	effect; the events of a chain up to some seq are found with one forward
+	iteration of the chain.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(uint64_t), typeid(uint64_t)
+	},
+
+	// options
+	{},
+
+	// comparator
+	chain_event__cmp,
+
+	// prefix transform
+	chain_event__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	true,
+
+	// block size
+	size_t(chain_event__block__size),
+
+	// meta_block size
+	size_t(chain_event__meta_block__size),
+
+	// compression
+	string_view{chain_event__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// indexer
+//
+
+void
+ircd::m::dbs::_index_event_chain(db::txn &txn,
+                                 const event &event,
+                                 const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::EVENT_CHAIN));
+	assert(defined(json::get<"state_key"_>(event)));
+	assert(opts.event_idx);
+
+	if(opts.op == db::op::SET)
+		_index_event_chain_set(txn, event, opts);
+
+	if(opts.op == db::op::DELETE)
+		_index_event_chain_del(txn, event, opts);
+}
+
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_event_chain_set(db::txn &txn,
+                                     const event &event,
+                                     const write_opts &opts)
+{
+	// Labels are never moved once assigned; reindexing leaves them as-is.
+	if(event_chain_get(opts.event_idx, [](const auto &, const auto &) {}, &opts))
+		return;
+
+	const event::auth auth
+	{
+		event
+	};
+
+	event::id auth_ids[auth.MAX];
+	const auto &auth_id
+	{
+		auth.ids(auth_ids)
+	};
+
+	event::idx auth_idx[auth.MAX] {0};
+	const auto &found
+	{
+		find_event_idx(auth_idx, auth_id, opts)
+	};
+
+	// The labels are only correct over the whole auth graph; an event which
+	// can't be placed is left for the readers' fallback.
+	if(found < auth_id.size())
+		return;
+
+	chain_pos self {0, 0};
+	std::map<uint64_t, uint64_t> reach;
+	for(size_t i(0); i < auth_id.size(); ++i)
+	{
+		const auto labeled
+		{
+			event_chain_get(auth_idx[i], [&opts, &self, &reach]
+			(const chain_pos &pos, const vector_view<const chain_pos> &labels)
+			{
+				for(const auto &[chain, seq] : labels)
+					reach[chain] = std::max(reach[chain], seq);
+
+				reach[pos.first] = std::max(reach[pos.first], pos.second);
+
+				// Extend the longest chain this event can be appended to.
+				if(pos.second + 1 > self.second && _event_chain_tip(pos, opts))
+					self = { pos.first, pos.second + 1 };
+			}, &opts)
+		};
+
+		if(!labeled)
+			return;
+	}
+
+	if(!self.first)
+		self = { opts.event_idx, 1UL };
+
+	std::vector<chain_pos> val;
+	val.reserve(1 + reach.size());
+	val.emplace_back(self);
+	for(const auto &pos : reach)
+		val.emplace_back(pos);
+
+	db::txn::append
+	{
+		txn, dbs::event_chain,
+		{
+			db::op::SET,
+			byte_view<string_view>(opts.event_idx),
+			string_view
+			{
+				reinterpret_cast<const char *>(val.data()),
+				val.size() * sizeof(chain_pos)
+			},
+		}
+	};
+
+	char buf[EVENT_CHAIN_KEY_MAX_SIZE];
+	db::txn::append
+	{
+		txn, dbs::chain_event,
+		{
+			db::op::SET,
+			chain_event_key(buf, self.first, self.second),
+			byte_view<string_view>(opts.event_idx),
+		}
+	};
+}
+
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_event_chain_del(db::txn &txn,
+                                     const event &event,
+                                     const write_opts &opts)
+{
+	chain_pos self {0, 0};
+	event_chain_get(opts.event_idx, [&self]
+	(const chain_pos &pos, const auto &)
+	{
+		self = pos;
+	}, &opts);
+
+	if(!self.first)
+		return;
+
+	db::txn::append
+	{
+		txn, dbs::event_chain,
+		{
+			db::op::DELETE,
+			byte_view<string_view>(opts.event_idx),
+		}
+	};
+
+	char buf[EVENT_CHAIN_KEY_MAX_SIZE];
+	db::txn::append
+	{
+		txn, dbs::chain_event,
+		{
+			db::op::DELETE,
+			chain_event_key(buf, self.first, self.second),
+		}
+	};
+}
+
+/// Whether nothing follows the position on its chain. The answer holds until
+/// the transaction commits; see write_opts::interpose.
+bool
+ircd::m::dbs::_event_chain_tip(const chain_pos &pos,
+                               const write_opts &opts)
+{
+	char buf[EVENT_CHAIN_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		chain_event_key(buf, pos.first, pos.second + 1)
+	};
+
+	if(opts.interpose)
+		if(opts.interpose->has(db::op::SET, "_chain_event", key))
+			return false;
+
+	if(!opts.allow_queries)
+		return false;
+
+	return !db::has(dbs::chain_event, key);
+}
+
+//
+// util
+//
+
+bool
+ircd::m::dbs::event_chain_get(const event::idx &event_idx,
+                              const event_chain_closure &closure,
+                              const write_opts *const opts)
+{
+	const auto reclosure{[&closure]
+	(const string_view &val)
+	{
+		assert(size(val) % sizeof(chain_pos) == 0);
+		assert(size(val) >= sizeof(chain_pos));
+		const auto *const pos
+		{
+			reinterpret_cast<const chain_pos *>(data(val))
+		};
+
+		const size_t count
+		{
+			size(val) / sizeof(chain_pos)
+		};
+
+		closure(pos[0], vector_view<const chain_pos>(pos + 1, pos + count));
+	}};
+
+	const string_view &key
+	{
+		byte_view<string_view>(event_idx)
+	};
+
+	if(opts && opts->interpose)
+		if(opts->interpose->get(db::op::SET, "_event_chain", key, reclosure))
+			return true;
+
+	if(opts && !opts->allow_queries)
+		return false;
+
+	return event_chain(key, std::nothrow, reclosure);
+}
+
+bool
+ircd::m::dbs::chain_event__cmp_less(const string_view &a,
+                                    const string_view &b)
+{
+	static const size_t half(sizeof(uint64_t));
+
+	assert(size(a) >= half);
+	assert(size(b) >= half);
+	const uint64_t *const key[2]
+	{
+		reinterpret_cast<const uint64_t *>(data(a)),
+		reinterpret_cast<const uint64_t *>(data(b)),
+	};
+
+	return
+		key[0][0] < key[1][0]?   true:
+		key[0][0] > key[1][0]?   false:
+		size(a) < size(b)?       true:
+		size(a) > size(b)?       false:
+		size(a) == half?         false:
+		key[0][1] < key[1][1]?   true:
+		                         false;
+}
+
+//
+// key
+//
+
+uint64_t
+ircd::m::dbs::chain_event_key(const string_view &amalgam)
+{
+	return byte_view<uint64_t>{amalgam};
+}
+
+ircd::string_view
+ircd::m::dbs::chain_event_key(const mutable_buffer &out,
+                              const uint64_t &chain)
+{
+	assert(size(out) >= sizeof(uint64_t));
+	uint64_t *const &key
+	{
+		reinterpret_cast<uint64_t *>(data(out))
+	};
+
+	key[0] = chain;
+	return string_view
+	{
+		data(out), data(out) + sizeof(uint64_t)
+	};
+}
+
+ircd::string_view
+ircd::m::dbs::chain_event_key(const mutable_buffer &out,
+                              const uint64_t &chain,
+                              const uint64_t &seq)
+{
+	assert(size(out) >= EVENT_CHAIN_KEY_MAX_SIZE);
+	uint64_t *const &key
+	{
+		reinterpret_cast<uint64_t *>(data(out))
+	};
+
+	key[0] = chain;
+	key[1] = seq;
+	return string_view
+	{
+		data(out), data(out) + EVENT_CHAIN_KEY_MAX_SIZE
+	};
+}
@@ -122,6 +122,9 @@ ircd::m::dbs::desc::event_json
 	// compaction priority algorithm
 	"Universal"s,
 
+	// merge operator
+	{},
+
 	// target_file_size
 	{
 		2_GiB,   // base
@@ -0,0 +1,369 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+decltype(ircd::m::dbs::event_term)
+ircd::m::dbs::event_term;
+
+decltype(ircd::m::dbs::desc::event_term__comp)
+ircd::m::dbs::desc::event_term__comp
+{
+	{ "name",     "ircd.m.dbs._event_term.comp" },
+	{ "default",  "default"                     },
+};
+
+decltype(ircd::m::dbs::desc::event_term__block__size)
+ircd::m::dbs::desc::event_term__block__size
+{
+	{ "name",     "ircd.m.dbs._event_term.block.size" },
+	{ "default",  long(4_KiB)                         },
+};
+
+decltype(ircd::m::dbs::desc::event_term__meta_block__size)
+ircd::m::dbs::desc::event_term__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._event_term.meta_block.size" },
+	{ "default",  long(4_KiB)                              },
+};
+
+decltype(ircd::m::dbs::desc::event_term__cache__size)
+ircd::m::dbs::desc::event_term__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_term.cache.size" },
+		{ "default",  long(32_MiB)                        },
+	}, []
+	{
+		const size_t &value{event_term__cache__size};
+		db::capacity(db::cache(dbs::event_term), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::event_term__cache_comp__size)
+ircd::m::dbs::desc::event_term__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_term.cache_comp.size" },
+		{ "default",  long(0_MiB)                              },
+	}, []
+	{
+		const size_t &value{event_term__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::event_term), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::event_term__terms__max)
+ircd::m::dbs::desc::event_term__terms__max
+{
+	{ "name",     "ircd.m.dbs._event_term.terms.max" },
+	{ "default",  128L                               },
+	{ "description",
+
+	R"(
+	Maximum number of distinct terms indexed for any one event. Terms beyond
+	this limit are not indexed; this bounds the write amplification of very
+	large message bodies. Hard limit is 256.
+	)"}
+};
+
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::event_term__pfx
+{
+	"_event_term",
+
+	[](const string_view &key)
+	{
+		return has(key, '\0');
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::event_term
+{
+	// name
+	"_event_term",
+
+	// explanation
+	R"(Inverted index of terms found in the body of events.
+
+	term | room_id, ~event_idx => frequency
+
+	The content.body of every event is tokenized and each distinct term is
+	recorded with the room and event it was found in. The term forms the
+	prefix domain; within each domain the postings are ordered by room and
+	then by event_idx descending (newest first), allowing posting lists of
+	several terms to be intersected by seeking rather than scanning. The
+	value is a 16-bit count of the occurrences of the term in the body.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(uint16_t)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	event_term__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(event_term__block__size),
+
+	// meta_block size
+	size_t(event_term__meta_block__size),
+
+	// compression
+	string_view{event_term__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// indexer
+//
+
+void
+ircd::m::dbs::_index_event_term(db::txn &txn,
+                                const event &event,
+                                const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::EVENT_TERM));
+	assert(json::get<"room_id"_>(event));
+	assert(opts.event_idx);
+
+	const json::string &body
+	{
+		json::get<"content"_>(event).get("body")
+	};
+
+	if(empty(body))
+		return;
+
+	const auto &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	event_term_for_each(body, [&txn, &opts, &room_id]
+	(const string_view &term, const uint16_t &freq)
+	{
+		thread_local char buf[EVENT_TERM_KEY_MAX_SIZE];
+		const string_view &key
+		{
+			event_term_key(buf, term, room_id, opts.event_idx)
+		};
+
+		db::txn::append
+		{
+			txn, dbs::event_term,
+			{
+				opts.op,
+				key,
+				value_required(opts.op)?
+					byte_view<string_view>(freq):
+					string_view{},
+			}
+		};
+
+		return true;
+	});
+}
+
+//
+// tokenizer
+//
+
+/// Terms are runs of ASCII alphanumerics or any non-ASCII bytes (so UTF-8
+/// sequences stay intact); everything else separates terms. JSON escapes in
+/// the input are treated as separators. ASCII is folded to lowercase. Terms
+/// shorter than two bytes are ignored and long terms are truncated. The input
+/// is expected in its JSON-escaped form as found in the event.
+bool
+ircd::m::dbs::event_term_for_each(const string_view &text,
+                                  const event_term_closure &closure)
+{
+	static const size_t terms_max
+	{
+		256
+	};
+
+	struct term
+	{
+		uint8_t len;
+		uint16_t freq;
+		char buf[EVENT_TERM_MAX_SIZE];
+	};
+
+	thread_local term terms[terms_max];
+	const size_t max
+	{
+		std::min(size_t(desc::event_term__terms__max), terms_max)
+	};
+
+	// The thread_local table is consumed by the closure in the same
+	// context slice; nothing here or in the closure may yield.
+	const ctx::critical_assertion ca;
+
+	size_t count(0);
+	const auto add{[&count, &max]
+	(const string_view &word)
+	{
+		if(size(word) < 2)
+			return;
+
+		char lower[EVENT_TERM_MAX_SIZE];
+		const string_view &norm
+		{
+			tolower(lower, trunc(word, EVENT_TERM_MAX_SIZE))
+		};
+
+		for(size_t i(0); i < count; ++i)
+			if(string_view(terms[i].buf, terms[i].len) == norm)
+			{
+				terms[i].freq += terms[i].freq < UINT16_MAX;
+				return;
+			}
+
+		if(count >= max)
+			return;
+
+		auto &t(terms[count++]);
+		t.len = size(norm);
+		std::copy(begin(norm), end(norm), t.buf);
+		t.freq = 1;
+	}};
+
+	const auto is_word{[](const char &c)
+	{
+		return (uint8_t(c) & 0x80) || std::isalnum(uint8_t(c));
+	}};
+
+	const char *start(nullptr);
+	for(size_t i(0); i < size(text); ++i)
+	{
+		const char &c(text[i]);
+		if(is_word(c))
+		{
+			start = start?: text.data() + i;
+			continue;
+		}
+
+		if(start)
+			add(string_view(start, text.data() + i));
+
+		start = nullptr;
+		if(c == '\\')
+			i += text.at(std::min(i + 1, size(text) - 1)) == 'u'? 5 : 1;
+	}
+
+	if(start)
+		add(string_view(start, text.data() + size(text)));
+
+	for(size_t i(0); i < count; ++i)
+		if(!closure(string_view(terms[i].buf, terms[i].len), terms[i].freq))
+			return false;
+
+	return true;
+}
+
+//
+// key
+//
+
+std::tuple<ircd::string_view, ircd::m::event::idx>
+ircd::m::dbs::event_term_key(const string_view &amalgam)
+{
+	assert(size(amalgam) > 1 + 1 + sizeof(event::idx));
+	assert(amalgam.front() == '\0');
+	const auto &room_id
+	{
+		amalgam.substr(1, size(amalgam) - 1 - 1 - sizeof(event::idx))
+	};
+
+	const auto &key
+	{
+		amalgam.substr(size(amalgam) - sizeof(event::idx))
+	};
+
+	assert(amalgam[size(amalgam) - sizeof(event::idx) - 1] == '\0');
+	return
+	{
+		room_id, ~ntoh(byte_view<event::idx>(key))
+	};
+}
+
+ircd::string_view
+ircd::m::dbs::event_term_key(const mutable_buffer &out_,
+                             const string_view &term)
+{
+	assert(size(out_) >= EVENT_TERM_MAX_SIZE + 1);
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, trunc(term, EVENT_TERM_MAX_SIZE)));
+	consume(out, copy(out, '\0'));
+	return { data(out_), data(out) };
+}
+
+/// The event_idx is stored big-endian and inverted so the bytewise comparator
+/// orders the postings of each room from newest to oldest. An event_idx of
+/// zero generates a key for the start of the room's postings.
+ircd::string_view
+ircd::m::dbs::event_term_key(const mutable_buffer &out_,
+                             const string_view &term,
+                             const id::room &room_id,
+                             const event::idx &event_idx)
+{
+	assert(size(out_) >= EVENT_TERM_KEY_MAX_SIZE);
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, trunc(term, EVENT_TERM_MAX_SIZE)));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+
+	if(!event_idx)
+		return { data(out_), data(out) };
+
+	const event::idx val
+	{
+		hton(~event_idx)
+	};
+
+	consume(out, copy(out, byte_view<string_view>(val)));
+	return { data(out_), data(out) };
+}
@@ -0,0 +1,454 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static void _index_room_count_set(db::txn &, const id::room &, const string_view &type, const write_opts &);
+	static void _index_room_count_del(db::txn &, const id::room &, const string_view &type, const write_opts &);
+	static void _index_room_count_purge(db::txn &, const id::room &, const write_opts &);
+	static size_t room_count__pfx_len(const string_view &key);
+}
+
+decltype(ircd::m::dbs::room_count)
+ircd::m::dbs::room_count;
+
+decltype(ircd::m::dbs::desc::room_count__comp)
+ircd::m::dbs::desc::room_count__comp
+{
+	{ "name",     "ircd.m.dbs._room_count.comp" },
+	{ "default",  "default"                     },
+};
+
+decltype(ircd::m::dbs::desc::room_count__block__size)
+ircd::m::dbs::desc::room_count__block__size
+{
+	{ "name",     "ircd.m.dbs._room_count.block.size" },
+	{ "default",  long(4_KiB)                         },
+};
+
+decltype(ircd::m::dbs::desc::room_count__meta_block__size)
+ircd::m::dbs::desc::room_count__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._room_count.meta_block.size" },
+	{ "default",  long(4_KiB)                              },
+};
+
+decltype(ircd::m::dbs::desc::room_count__cache__size)
+ircd::m::dbs::desc::room_count__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_count.cache.size" },
+		{ "default",  long(16_MiB)                        },
+	}, []
+	{
+		const size_t &value{room_count__cache__size};
+		db::capacity(db::cache(dbs::room_count), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_count__cache_comp__size)
+ircd::m::dbs::desc::room_count__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_count.cache_comp.size" },
+		{ "default",  long(0_MiB)                              },
+	}, []
+	{
+		const size_t &value{room_count__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::room_count), value);
+	}
+};
+
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::room_count__pfx
+{
+	"_room_count",
+
+	[](const string_view &key)
+	{
+		return room_count__pfx_len(key) != 0;
+	},
+
+	[](const string_view &key)
+	{
+		return key.substr(0, room_count__pfx_len(key));
+	}
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::room_count
+{
+	// name
+	"_room_count",
+
+	// explanation
+	R"(Running count of the events in a room, and of some types in a room.
+
+	[room_id | type | ~event_idx] => rank
+	[room_id | type] => count
+
+	Each event writes its rank, the number of events counted for the room up
+	to and including itself. The number of events between two event_idx is
+	then the difference of two ranks, found with one seek each rather than by
+	iterating the room. The rank for the room as a whole has an empty type.
+	Some types are also counted on their own, i.e. the notifications found in
+	a user's room. The keys of each domain are ordered by descending event_idx
+	so a seek lands on the nearest event at or below the sought event_idx. The
+	bare prefix holds the latest count and is what the next event increments.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(uint64_t)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	room_count__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(room_count__block__size),
+
+	// meta_block size
+	size_t(room_count__meta_block__size),
+
+	// compression
+	string_view{room_count__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+/// Length of the room_id \0 type \0 prefix of a key; zero when the key is
+/// not prefixed. The event_idx following the prefix may contain any byte.
+size_t
+ircd::m::dbs::room_count__pfx_len(const string_view &key)
+{
+	const auto room_end
+	{
+		key.find('\0')
+	};
+
+	if(room_end == key.npos)
+		return 0;
+
+	const auto type_end
+	{
+		key.find('\0', room_end + 1)
+	};
+
+	if(type_end == key.npos)
+		return 0;
+
+	return type_end + 1;
+}
+
+//
+// indexer
+//
+
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_room_count(db::txn &txn,
+                                const event &event,
+                                const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::ROOM_COUNT));
+	assert(json::get<"room_id"_>(event));
+	assert(opts.event_idx);
+
+	const m::room::id &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	// Notifications in a user's room are counted by their type, which is
+	// specific to the room being notified for.
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	const bool notification
+	{
+		startswith(type, m::user::notifications::type_prefix)
+		&& has(type, '!')
+		&& json::get<"sender"_>(event)
+		&& m::user::room::is(room_id, at<"sender"_>(event))
+	};
+
+	if(opts.op == db::op::SET)
+	{
+		_index_room_count_set(txn, room_id, string_view{}, opts);
+		if(notification)
+			_index_room_count_set(txn, room_id, type, opts);
+	}
+
+	// A deleted event's rank is removed but the ranks counted over it remain.
+	// The counts themselves are removed along with the room's create event.
+	if(opts.op == db::op::DELETE)
+	{
+		_index_room_count_del(txn, room_id, string_view{}, opts);
+		if(notification)
+			_index_room_count_del(txn, room_id, type, opts);
+
+		if(type == "m.room.create")
+			_index_room_count_purge(txn, room_id, opts);
+	}
+}
+
+/// Increments the count; the count read holds until the transaction
+/// commits, see write_opts::interpose.
+void
+ircd::m::dbs::_index_room_count_set(db::txn &txn,
+                                    const id::room &room_id,
+                                    const string_view &type,
+                                    const write_opts &opts)
+{
+	char buf[ROOM_COUNT_KEY_MAX_SIZE];
+	const string_view &head_key
+	{
+		room_count_key(buf, room_id, type)
+	};
+
+	bool found {false};
+	uint64_t count {0};
+	const auto closure{[&found, &count]
+	(const string_view &val)
+	{
+		count = byte_view<uint64_t>(val);
+		found = true;
+	}};
+
+	if(opts.interpose)
+		opts.interpose->get(db::op::SET, "_room_count", head_key, closure);
+
+	// Without the prior count the ranks would restart; leaving the event out
+	// only costs the reader its fallback.
+	if(!found && !opts.allow_queries)
+		return;
+
+	if(!found)
+		room_count(head_key, std::nothrow, closure);
+
+	const uint64_t rank
+	{
+		count + 1
+	};
+
+	db::txn::append
+	{
+		txn, room_count,
+		{
+			db::op::SET,
+			head_key,
+			byte_view<string_view>{rank},
+		}
+	};
+
+	char rank_buf[ROOM_COUNT_KEY_MAX_SIZE];
+	db::txn::append
+	{
+		txn, room_count,
+		{
+			db::op::SET,
+			room_count_key(rank_buf, room_id, type, opts.event_idx),
+			byte_view<string_view>{rank},
+		}
+	};
+}
+
+void
+ircd::m::dbs::_index_room_count_del(db::txn &txn,
+                                    const id::room &room_id,
+                                    const string_view &type,
+                                    const write_opts &opts)
+{
+	char buf[ROOM_COUNT_KEY_MAX_SIZE];
+	db::txn::append
+	{
+		txn, room_count,
+		{
+			db::op::DELETE,
+			room_count_key(buf, room_id, type, opts.event_idx),
+		}
+	};
+}
+
+/// Deletes the counts and any remaining ranks of every type in the room.
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_room_count_purge(db::txn &txn,
+                                      const id::room &room_id,
+                                      const write_opts &opts)
+{
+	if(!opts.allow_queries)
+		return;
+
+	char buf[ROOM_COUNT_KEY_MAX_SIZE];
+	mutable_buffer out{buf};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	const string_view prefix
+	{
+		buf, data(out)
+	};
+
+	for(auto it(room_count.lower_bound(prefix)); bool(it); ++it)
+	{
+		if(!startswith(it->first, prefix))
+			break;
+
+		db::txn::append
+		{
+			txn, room_count,
+			{
+				db::op::DELETE,
+				it->first,
+			}
+		};
+	}
+}
+
+//
+// util
+//
+
+/// Number of events in the (a, b] range of event_idx counted for the room and
+/// type. False when the index can't answer, i.e. nothing at or below `a` was
+/// counted, which is the case for history from before the index existed.
+bool
+ircd::m::dbs::room_count_range(size_t &ret,
+                               const id::room &room_id,
+                               const string_view &type,
+                               const event::idx_range &range)
+{
+	const auto &[a, b]
+	{
+		range
+	};
+
+	assert(a <= b);
+	uint64_t rank[2] {0, 0};
+	if(!room_count_rank(rank[0], room_id, type, a))
+		return false;
+
+	if(!room_count_rank(rank[1], room_id, type, b))
+		return false;
+
+	assert(rank[1] >= rank[0]);
+	ret = rank[1] - rank[0];
+	return true;
+}
+
+/// Rank of the nearest event at or below the event_idx counted for the room
+/// and type. False when there is none.
+bool
+ircd::m::dbs::room_count_rank(uint64_t &ret,
+                              const id::room &room_id,
+                              const string_view &type,
+                              const event::idx &event_idx)
+{
+	char buf[ROOM_COUNT_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		room_count_key(buf, room_id, type, event_idx)
+	};
+
+	auto it
+	{
+		room_count.begin(key)
+	};
+
+	if(!it)
+		return false;
+
+	assert(size(it->first) == sizeof(event::idx));
+	assert(room_count_key(it->first) <= event_idx);
+	ret = byte_view<uint64_t>(it->second);
+	return true;
+}
+
+//
+// key
+//
+
+ircd::event::idx
+ircd::m::dbs::room_count_key(const string_view &amalgam)
+{
+	assert(size(amalgam) == sizeof(event::idx));
+	const uint64_t val
+	{
+		byte_view<uint64_t>(amalgam)
+	};
+
+	return ~ntoh(val);
+}
+
+ircd::string_view
+ircd::m::dbs::room_count_key(const mutable_buffer &out_,
+                             const id::room &room_id,
+                             const string_view &type)
+{
+	assert(size(out_) >= ROOM_COUNT_KEY_MAX_SIZE);
+	assert(!has(type, '\0'));
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, type));
+	consume(out, copy(out, '\0'));
+	return { data(out_), data(out) };
+}
+
+ircd::string_view
+ircd::m::dbs::room_count_key(const mutable_buffer &out_,
+                             const id::room &room_id,
+                             const string_view &type,
+                             const event::idx &event_idx)
+{
+	assert(size(out_) >= ROOM_COUNT_KEY_MAX_SIZE);
+
+	mutable_buffer out{out_};
+	consume(out, size(room_count_key(out, room_id, type)));
+
+	// Descending, in byte order, for the default comparator.
+	const uint64_t val
+	{
+		hton<uint64_t>(~event_idx)
+	};
+
+	consume(out, copy(out, byte_view<string_view>(val)));
+	return { data(out_), data(out) };
+}
@@ -0,0 +1,526 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static void _index_room_stats_add(db::txn &, const id::room &, const string_view &name, const string_view &host, const int64_t &);
+	static void _index_room_stats_member(db::txn &, const event &, const write_opts &);
+	static string_view _room_stats_membership(const mutable_buffer &, const event::idx &, const write_opts &);
+	static event::idx _room_stats_present(const id::room &, const string_view &state_key, const write_opts &);
+	static size_t _room_stats_json(const db::txn &, const write_opts &);
+	static std::string room_stats__merge(const string_view &key, const db::merge_delta &);
+}
+
+decltype(ircd::m::dbs::room_stats)
+ircd::m::dbs::room_stats;
+
+decltype(ircd::m::dbs::desc::room_stats__comp)
+ircd::m::dbs::desc::room_stats__comp
+{
+	{ "name",     "ircd.m.dbs._room_stats.comp" },
+	{ "default",  "default"                     },
+};
+
+decltype(ircd::m::dbs::desc::room_stats__block__size)
+ircd::m::dbs::desc::room_stats__block__size
+{
+	{ "name",     "ircd.m.dbs._room_stats.block.size" },
+	{ "default",  512L                                },
+};
+
+decltype(ircd::m::dbs::desc::room_stats__meta_block__size)
+ircd::m::dbs::desc::room_stats__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._room_stats.meta_block.size" },
+	{ "default",  512L                                     },
+};
+
+decltype(ircd::m::dbs::desc::room_stats__cache__size)
+ircd::m::dbs::desc::room_stats__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_stats.cache.size" },
+		{ "default",  long(8_MiB)                         },
+	}, []
+	{
+		const size_t &value{room_stats__cache__size};
+		db::capacity(db::cache(dbs::room_stats), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_stats__cache_comp__size)
+ircd::m::dbs::desc::room_stats__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_stats.cache_comp.size" },
+		{ "default",  long(0_MiB)                              },
+	}, []
+	{
+		const size_t &value{room_stats__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::room_stats), value);
+	}
+};
+
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::room_stats__pfx
+{
+	"_room_stats",
+
+	[](const string_view &key)
+	{
+		return has(key, '\0');
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::room_stats
+{
+	// name
+	"_room_stats",
+
+	// explanation
+	R"(Counters for a room maintained by merging deltas.
+
+	[room_id | counter] => int64
+	[room_id | counter, host] => int64
+	[room_id] => event_idx
+
+	Each write to the room merges a signed delta into its counters rather
+	than reading and rewriting them: the number of events, the bytes of their
+	JSON, and the number of members in the present state by membership, also
+	by the host of the member. The bare room_id is written with the room's
+	create event; counters without it began after the room did and are not
+	complete. That can be remedied with m::room::stats::rebuild.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(int64_t)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	room_stats__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(room_stats__block__size),
+
+	// meta_block size
+	size_t(room_stats__meta_block__size),
+
+	// compression
+	string_view{room_stats__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+
+	// merge operator
+	room_stats__merge,
+};
+
+std::string
+ircd::m::dbs::room_stats__merge(const string_view &key,
+                                const db::merge_delta &delta)
+{
+	const auto &[exist, update]
+	{
+		delta
+	};
+
+	if(unlikely(size(exist) != sizeof(int64_t) || size(update) != sizeof(int64_t)))
+		throw db::error
+		{
+			"Cannot merge room_stats counter of %zu bytes with %zu bytes",
+			size(exist),
+			size(update),
+		};
+
+	const int64_t val
+	{
+		int64_t(byte_view<int64_t>(exist)) + int64_t(byte_view<int64_t>(update))
+	};
+
+	return std::string
+	{
+		byte_view<string_view>(val)
+	};
+}
+
+//
+// indexer
+//
+
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_room_stats(db::txn &txn,
+                                const event &event,
+                                const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::ROOM_STATS));
+	assert(json::get<"room_id"_>(event));
+	assert(opts.event_idx);
+
+	if(opts.op != db::op::SET && opts.op != db::op::DELETE)
+		return;
+
+	const m::room::id &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	const int64_t sign
+	{
+		opts.op == db::op::SET? 1L: -1L
+	};
+
+	// Counters which follow the room from its creation are complete.
+	const bool create
+	{
+		opts.op == db::op::SET
+		&& type == "m.room.create"
+		&& opts.appendix.test(appendix::ROOM_EVENTS)
+	};
+
+	if(create)
+	{
+		char buf[ROOM_STATS_KEY_MAX_SIZE];
+		db::txn::append
+		{
+			txn, room_stats,
+			{
+				db::op::SET,
+				room_stats_key(buf, room_id),
+				byte_view<string_view>{opts.event_idx},
+			}
+		};
+	}
+
+	// Each counter follows the index it counts, so re-indexing one of them
+	// doesn't move the others.
+	if(opts.appendix.test(appendix::ROOM_EVENTS))
+		_index_room_stats_add(txn, room_id, "events", {}, sign);
+
+	if(opts.appendix.test(appendix::EVENT_JSON))
+		if(const auto bytes{_room_stats_json(txn, opts)}; bytes)
+			_index_room_stats_add(txn, room_id, "json", {}, sign * int64_t(bytes));
+
+	const bool member
+	{
+		type == "m.room.member"
+		&& defined(json::get<"state_key"_>(event))
+		&& opts.appendix.test(appendix::ROOM_STATE)
+	};
+
+	if(member)
+		_index_room_stats_member(txn, event, opts);
+}
+
+/// Members are counted by the membership of their present state. A write to
+/// the present state moves the member from the counter of the state being
+/// replaced, which is found in the interposed transaction or else queried.
+void
+ircd::m::dbs::_index_room_stats_member(db::txn &txn,
+                                       const event &event,
+                                       const write_opts &opts)
+{
+	const m::room::id &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	const string_view &state_key
+	{
+		at<"state_key"_>(event)
+	};
+
+	const string_view &host
+	{
+		valid(id::USER, state_key)?
+			m::user::id(state_key).host():
+			string_view{}
+	};
+
+	const event::idx present
+	{
+		_room_stats_present(room_id, state_key, opts)
+	};
+
+	char name_buf[2][ROOM_STATS_NAME_MAX_SIZE];
+	const string_view name
+	{
+		room_stats_member(name_buf[0], m::membership(event))
+	};
+
+	// Only the present state is uncounted when it's deleted.
+	if(opts.op == db::op::DELETE)
+	{
+		if(present != opts.event_idx || !name)
+			return;
+
+		_index_room_stats_add(txn, room_id, name, {}, -1L);
+		if(host)
+			_index_room_stats_add(txn, room_id, name, host, -1L);
+
+		return;
+	}
+
+	// Rewriting the present state moves nothing.
+	if(present == opts.event_idx)
+		return;
+
+	char membership_buf[ROOM_STATS_NAME_MAX_SIZE];
+	const string_view prior
+	{
+		present?
+			room_stats_member(name_buf[1], _room_stats_membership(membership_buf, present, opts)):
+			string_view{}
+	};
+
+	if(prior == name)
+		return;
+
+	if(prior)
+	{
+		_index_room_stats_add(txn, room_id, prior, {}, -1L);
+		if(host)
+			_index_room_stats_add(txn, room_id, prior, host, -1L);
+	}
+
+	if(name)
+	{
+		_index_room_stats_add(txn, room_id, name, {}, 1L);
+		if(host)
+			_index_room_stats_add(txn, room_id, name, host, 1L);
+	}
+}
+
+void
+ircd::m::dbs::_index_room_stats_add(db::txn &txn,
+                                    const id::room &room_id,
+                                    const string_view &name,
+                                    const string_view &host,
+                                    const int64_t &delta)
+{
+	char buf[ROOM_STATS_KEY_MAX_SIZE];
+	db::txn::append
+	{
+		txn, room_stats,
+		{
+			db::op::MERGE,
+			room_stats_key(buf, room_id, name, host),
+			byte_view<string_view>{delta},
+		}
+	};
+}
+
+/// Bytes of the event's JSON written to (or found for deletion from) the
+/// event_json column by this transaction.
+size_t
+ircd::m::dbs::_room_stats_json(const db::txn &txn,
+                               const write_opts &opts)
+{
+	const string_view &key
+	{
+		byte_view<string_view>(opts.event_idx)
+	};
+
+	size_t ret(0);
+	if(opts.op == db::op::SET)
+		txn.get(db::op::SET, "_event_json", key, [&ret]
+		(const string_view &val)
+		{
+			ret = size(val);
+		});
+	else if(opts.allow_queries)
+		ret = db::bytes_value(event_json, key);
+
+	return ret;
+}
+
+/// The event_idx of the present member state for the state_key, or zero.
+ircd::m::event::idx
+ircd::m::dbs::_room_stats_present(const id::room &room_id,
+                                  const string_view &state_key,
+                                  const write_opts &opts)
+{
+	char buf[ROOM_STATE_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		room_state_key(buf, room_id, "m.room.member", state_key)
+	};
+
+	event::idx ret(0);
+	const auto closure{[&ret]
+	(const string_view &val)
+	{
+		ret = byte_view<event::idx>(val);
+	}};
+
+	// The last write to the key in the interposed transaction supersedes the
+	// database, including a deletion.
+	bool found {false};
+	if(opts.interpose)
+		db::for_each(*opts.interpose, db::delta_closure{[&key, &found, &ret]
+		(const db::delta &delta)
+		{
+			if(std::get<db::delta::COL>(delta) != "_room_state")
+				return;
+
+			if(std::get<db::delta::KEY>(delta) != key)
+				return;
+
+			found = true;
+			ret = std::get<db::delta::OP>(delta) == db::op::SET?
+				event::idx(byte_view<event::idx>(std::get<db::delta::VAL>(delta))):
+				0UL;
+		}});
+
+	if(!found && opts.allow_queries)
+		room_state(key, std::nothrow, closure);
+
+	return ret;
+}
+
+ircd::string_view
+ircd::m::dbs::_room_stats_membership(const mutable_buffer &buf,
+                                     const event::idx &event_idx,
+                                     const write_opts &opts)
+{
+	string_view ret;
+	const auto closure{[&buf, &ret]
+	(const json::object &content)
+	{
+		const json::string &membership
+		{
+			content["membership"]
+		};
+
+		ret = strlcpy(buf, membership);
+	}};
+
+	if(opts.interpose)
+		if(opts.interpose->get(db::op::SET, "content", byte_view<string_view>(event_idx), closure))
+			return ret;
+
+	if(opts.allow_queries)
+		m::get(std::nothrow, event_idx, "content", closure);
+
+	return ret;
+}
+
+//
+// key
+//
+
+ircd::string_view
+ircd::m::dbs::room_stats_member(const mutable_buffer &out,
+                                const string_view &membership)
+{
+	static const string_view prefix
+	{
+		"member."
+	};
+
+	if(!membership || size(prefix) + size(membership) > size(out) || has(membership, '\0'))
+		return {};
+
+	mutable_buffer buf{out};
+	consume(buf, copy(buf, prefix));
+	consume(buf, copy(buf, membership));
+	return { data(out), data(buf) };
+}
+
+std::tuple<ircd::string_view, ircd::string_view>
+ircd::m::dbs::room_stats_key(const string_view &amalgam)
+{
+	const auto &key
+	{
+		lstrip(amalgam, '\0')
+	};
+
+	const auto &[name, host]
+	{
+		split(key, '\0')
+	};
+
+	return
+	{
+		name, host
+	};
+}
+
+ircd::string_view
+ircd::m::dbs::room_stats_key(const mutable_buffer &out_,
+                             const id::room &room_id)
+{
+	assert(size(out_) >= ROOM_STATS_KEY_MAX_SIZE);
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	return { data(out_), data(out) };
+}
+
+ircd::string_view
+ircd::m::dbs::room_stats_key(const mutable_buffer &out_,
+                             const id::room &room_id,
+                             const string_view &name,
+                             const string_view &host)
+{
+	assert(size(out_) >= ROOM_STATS_KEY_MAX_SIZE);
+	assert(size(name) <= ROOM_STATS_NAME_MAX_SIZE);
+	assert(!empty(name));
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, name));
+	if(host)
+	{
+		consume(out, copy(out, '\0'));
+		consume(out, copy(out, trunc(host, rfc3986::DOMAIN_BUFSIZE - 1)));
+	}
+
+	return { data(out_), data(out) };
+}
@@ -0,0 +1,340 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static void _index_user_touch_set(db::txn &, const id::user &, const id::room &, const write_opts &);
+	static string_view _user_touch_target(const event &);
+}
+
+decltype(ircd::m::dbs::user_touch)
+ircd::m::dbs::user_touch;
+
+decltype(ircd::m::dbs::user_touch_enable)
+ircd::m::dbs::user_touch_enable
+{
+	{ "name",     "ircd.client.sync.rooms.touched.enable" },
+	{ "default",  false                                   },
+	{ "description",
+
+	R"(
+	Use the user_touch index to skip the rooms without any event since the
+	client's last sync during a polylog sync. Existing history must first be
+	indexed with the `user rooms touched rebuild` console command.
+
+	The index is only maintained while this is enabled. Every event in a
+	room then writes one row for each local member joined to that room, so
+	rooms with many local members amplify each write accordingly. Run the
+	rebuild again after it was disabled for a while.
+	)"}
+};
+
+decltype(ircd::m::dbs::desc::user_touch__comp)
+ircd::m::dbs::desc::user_touch__comp
+{
+	{ "name",     "ircd.m.dbs._user_touch.comp" },
+	{ "default",  "default"                     },
+};
+
+decltype(ircd::m::dbs::desc::user_touch__block__size)
+ircd::m::dbs::desc::user_touch__block__size
+{
+	{ "name",     "ircd.m.dbs._user_touch.block.size" },
+	{ "default",  long(4_KiB)                         },
+};
+
+decltype(ircd::m::dbs::desc::user_touch__meta_block__size)
+ircd::m::dbs::desc::user_touch__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._user_touch.meta_block.size" },
+	{ "default",  long(4_KiB)                              },
+};
+
+decltype(ircd::m::dbs::desc::user_touch__cache__size)
+ircd::m::dbs::desc::user_touch__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._user_touch.cache.size" },
+		{ "default",  long(16_MiB)                        },
+	}, []
+	{
+		const size_t &value{user_touch__cache__size};
+		db::capacity(db::cache(dbs::user_touch), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::user_touch__cache_comp__size)
+ircd::m::dbs::desc::user_touch__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._user_touch.cache_comp.size" },
+		{ "default",  long(0_MiB)                              },
+	}, []
+	{
+		const size_t &value{user_touch__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::user_touch), value);
+	}
+};
+
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::user_touch__pfx
+{
+	"_user_touch",
+
+	[](const string_view &key)
+	{
+		return has(key, '\0');
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+const ircd::db::descriptor
+ircd::m::dbs::desc::user_touch
+{
+	// name
+	"_user_touch",
+
+	// explanation
+	R"(The last event concerning a room for each of its local users.
+
+	[user_id | room_id] => event_idx
+
+	Every event in a room overwrites the entry of each local member joined to
+	that room with its event_idx. Membership events also touch their local
+	target, and events in a user's room which concern some other room (account
+	data, tags, read markers) touch that room for the user. The entries of one
+	user form the prefix domain ordered by room_id, so the rooms which changed
+	since some point can be found with one scan of the user's rows rather than
+	probing each of the user's rooms.
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(uint64_t)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	user_touch__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	0,
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(user_touch__block__size),
+
+	// meta_block size
+	size_t(user_touch__meta_block__size),
+
+	// compression
+	string_view{user_touch__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// indexer
+//
+
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_user_touch(db::txn &txn,
+                                const event &event,
+                                const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::USER_TOUCH));
+	assert(json::get<"room_id"_>(event));
+	assert(opts.event_idx);
+
+	// The index only moves forward. An entry left behind by a deletion is at
+	// worst a false positive for the reader, which costs it one visit.
+	if(opts.op != db::op::SET)
+		return;
+
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	if(type == "org.matrix.dummy_event")
+		return;
+
+	const m::room::id &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	const m::user::id &sender
+	{
+		at<"sender"_>(event)
+	};
+
+	// Events in a user's room are private to that user; some of them concern
+	// another room on the user's behalf. The room's members are not touched.
+	if(my(sender) && m::user::room::is(room_id, sender))
+	{
+		const string_view &target
+		{
+			_user_touch_target(event)
+		};
+
+		if(valid(id::ROOM, target))
+			_index_user_touch_set(txn, sender, target, opts);
+
+		return;
+	}
+
+	// The target of a membership is touched regardless of whether they are
+	// (still) joined, i.e. invites, leaves and bans, and the join itself,
+	// which is not yet found in room_joined below.
+	const string_view &state_key
+	{
+		json::get<"state_key"_>(event)
+	};
+
+	const bool member_target
+	{
+		type == "m.room.member"
+		&& valid(id::USER, state_key)
+		&& my(m::user::id(state_key))
+	};
+
+	if(member_target)
+		_index_user_touch_set(txn, state_key, room_id, opts);
+
+	if(!opts.allow_queries)
+		return;
+
+	const m::room::members members
+	{
+		room_id
+	};
+
+	members.for_each("join", my_host(), [&txn, &opts, &room_id, &state_key, &member_target]
+	(const id::user &user_id)
+	{
+		if(!member_target || user_id != state_key)
+			_index_user_touch_set(txn, user_id, room_id, opts);
+
+		return true;
+	});
+}
+
+void
+ircd::m::dbs::_index_user_touch_set(db::txn &txn,
+                                    const id::user &user_id,
+                                    const id::room &room_id,
+                                    const write_opts &opts)
+{
+	char buf[USER_TOUCH_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		user_touch_key(buf, user_id, room_id)
+	};
+
+	db::txn::append
+	{
+		txn, user_touch,
+		{
+			db::op::SET,
+			key,
+			byte_view<string_view>{opts.event_idx},
+		}
+	};
+}
+
+/// The room concerned by an event found in a user's room, or empty.
+ircd::string_view
+ircd::m::dbs::_user_touch_target(const event &event)
+{
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	if(startswith(type, m::user::room_account_data::type_prefix))
+		return lstrip(type, m::user::room_account_data::type_prefix);
+
+	if(startswith(type, m::user::room_tags::type_prefix))
+		return lstrip(type, m::user::room_tags::type_prefix);
+
+	if(type == "ircd.read")
+		return json::get<"state_key"_>(event);
+
+	return {};
+}
+
+//
+// key
+//
+
+ircd::string_view
+ircd::m::dbs::user_touch_key(const string_view &amalgam)
+{
+	const auto &room_id
+	{
+		split(amalgam, '\0').second
+	};
+
+	assert(!empty(room_id));
+	return room_id;
+}
+
+ircd::string_view
+ircd::m::dbs::user_touch_key(const mutable_buffer &out_,
+                             const id::user &user_id)
+{
+	assert(size(out_) >= id::MAX_SIZE + 1);
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, user_id));
+	consume(out, copy(out, '\0'));
+	return { data(out_), data(out) };
+}
+
+ircd::string_view
+ircd::m::dbs::user_touch_key(const mutable_buffer &out_,
+                             const id::user &user_id,
+                             const id::room &room_id)
+{
+	assert(size(out_) >= USER_TOUCH_KEY_MAX_SIZE);
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, user_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, room_id));
+	return { data(out_), data(out) };
+}
@@ -11,6 +11,9 @@
 namespace ircd::m
 {
 	static json::object make_hashes(const mutable_buffer &out, const sha256::buf &hash);
+
+	extern conf::item<size_t> verify_offload_min;
+	extern conf::item<size_t> verify_offload_concurrency;
 }
 
 /// The maximum size of an event we will create. This may also be used in
@@ -27,6 +30,34 @@ decltype(ircd::m::event::buf)
 thread_local
 ircd::m::event::buf;
 
+decltype(ircd::m::verify_offload_min)
+ircd::m::verify_offload_min
+{
+	{ "name",     "ircd.m.event.verify.offload.min" },
+	{ "default",  8L                                },
+	{ "description",
+
+	R"(
+	Minimum number of signatures in a batch verification before the work is
+	offloaded to the ctx::ole worker threads rather than conducted on the
+	main thread. Zero disables offloading.
+	)"}
+};
+
+decltype(ircd::m::verify_offload_concurrency)
+ircd::m::verify_offload_concurrency
+{
+	{ "name",     "ircd.m.event.verify.offload.concurrency" },
+	{ "default",  4L                                        },
+	{ "description",
+
+	R"(
+	Number of ctx::ole worker threads a batch verification is divided among.
+	This is bounded by the number of offload threads; raising it beyond
+	ircd.ctx.ole.thread.max has no effect unless that is raised as well.
+	)"}
+};
+
 bool
 ircd::m::check_id(const event &event)
 noexcept
@@ -503,6 +534,164 @@ ircd::m::event::sign(const string_view &event,
 
 	return sig;
 }
+
+/// Batch signature verification. The signing keys and preimages for up to
+/// 64 events are gathered on this thread (io/yield for keys) and the ed25519
+/// verifications are then conducted in parallel on the ctx::ole worker
+/// threads while this context yields. The returned bitmask indicates the
+/// events which were positively verified; a zero bit means the event was
+/// either masked, failed, or could not be verified here (i.e. missing key).
+/// Callers should fall back to the singular verify() for a zero bit to
+/// obtain the authoritative result or error.
+uint64_t
+ircd::m::verify(const vector_view<const event> &events,
+                const uint64_t &mask)
+{
+	struct job
+	{
+		ed25519::pk pk;
+		ed25519::sig sig;
+		const_buffer preimage;
+		bool valid {false};
+	};
+
+	const size_t count
+	{
+		std::min(events.size(), 64UL)
+	};
+
+	size_t reserve(0);
+	for(size_t i(0); i < count; ++i)
+		if(mask & (1UL << i))
+			reserve += json::serialized(events[i]);
+
+	const unique_mutable_buffer buf
+	{
+		reserve
+	};
+
+	std::vector<job> jobs(count);
+	window_buffer wb{buf};
+	for(size_t i(0); i < count; ++i) try
+	{
+		if(~mask & (1UL << i))
+			continue;
+
+		const auto &event
+		{
+			events[i]
+		};
+
+		const string_view &origin
+		{
+			at<"origin"_>(event)
+		};
+
+		const json::object &origin_sigs
+		{
+			at<"signatures"_>(event).at(origin)
+		};
+
+		// Take the first signature with a key we have; any other case is
+		// left for the singular verify() to sort out.
+		const m::node::keys node_keys
+		{
+			origin
+		};
+
+		bool found(false);
+		auto &job(jobs[i]);
+		for(const auto &[keyid, sig] : origin_sigs)
+		{
+			found = node_keys.get(json::string(keyid), [&job](const ed25519::pk &pk)
+			{
+				job.pk = pk;
+			});
+
+			if(!found)
+				continue;
+
+			job.sig = ed25519::sig{[&sig](auto&& buf)
+			{
+				b64::decode(buf, json::string(sig));
+			}};
+
+			break;
+		}
+
+		if(!found)
+			continue;
+
+		const m::event essential
+		{
+			m::essential(event, event::buf[3])
+		};
+
+		job.preimage = wb([&essential](const mutable_buffer &buf) -> const_buffer
+		{
+			return stringify(mutable_buffer{buf}, essential);
+		});
+	}
+	catch(const ctx::interrupted &)
+	{
+		throw;
+	}
+	catch(const std::exception &e)
+	{
+		log::derror
+		{
+			log, "Batch verify %s :%s",
+			string_view{events[i].event_id},
+			e.what(),
+		};
+
+		jobs[i].preimage = {};
+	}
+
+	std::atomic<size_t> next {0};
+	const auto worker{[&jobs, &next]
+	{
+		for(size_t i(next++); i < jobs.size(); i = next++)
+			if(!empty(jobs[i].preimage))
+				jobs[i].valid = jobs[i].pk.verify(jobs[i].preimage, jobs[i].sig);
+	}};
+
+	const size_t queued
+	{
+		size_t(std::count_if(begin(jobs), end(jobs), [](const auto &job)
+		{
+			return !empty(job.preimage);
+		}))
+	};
+
+	const bool offload
+	{
+		size_t(verify_offload_min)
+		&& queued >= size_t(verify_offload_min)
+	};
+
+	if(offload)
+	{
+		ctx::ole::opts opts;
+		opts.name = "m.verify";
+		opts.concurrency = std::clamp
+		(
+			std::min(size_t(verify_offload_concurrency), ctx::ole::thread_count()), 1UL, queued
+		);
+		ctx::offload
+		{
+			opts, worker
+		};
+	}
+	else worker();
+
+	uint64_t ret(0);
+	for(size_t i(0); i < count; ++i)
+		ret |= uint64_t(jobs[i].valid) << i;
+
+	return ret;
+}
+
 bool
 ircd::m::verify(const event &event)
 {
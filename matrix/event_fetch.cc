@@ -433,3 +433,253 @@ ircd::m::event::fetch::opts::opts()
 noexcept
 {
 }
+
+//
+// event::fetch::batch
+//
+
+ircd::m::event::fetch::batch::batch(const opts &opts)
+:fopts
+{
+	&opts
+}
+{
+}
+
+ircd::m::event::fetch::batch::batch(const vector_view<const event::idx> &idx,
+                                    const opts &opts)
+:batch
+{
+	opts
+}
+{
+	operator()(idx);
+}
+
+size_t
+ircd::m::event::fetch::batch::operator()(const vector_view<const event::idx> &in)
+{
+	// Keys are queried in order for locality in the tables.
+	idx.assign(begin(in), end(in));
+	idx.erase(std::remove(begin(idx), end(idx), 0UL), end(idx));
+	std::sort(begin(idx), end(idx));
+	idx.erase(std::unique(begin(idx), end(idx)), end(idx));
+
+	events.assign(idx.size(), m::event{});
+	valid.assign(idx.size(), false);
+	buf.clear();
+
+	assert(fopts);
+	if(should_seek_json(*fopts))
+		query_json();
+	else
+		query_row();
+
+	return count();
+}
+
+size_t
+ircd::m::event::fetch::batch::count()
+const
+{
+	return std::count(begin(valid), end(valid), true);
+}
+
+bool
+ircd::m::event::fetch::batch::for_each(const closure &closure)
+const
+{
+	for(size_t i(0); i < idx.size(); ++i)
+		if(valid[i])
+			if(!closure(idx[i], events[i]))
+				return false;
+
+	return true;
+}
+
+const ircd::m::event *
+ircd::m::event::fetch::batch::find(const event::idx &event_idx)
+const
+{
+	const auto it
+	{
+		std::lower_bound(begin(idx), end(idx), event_idx)
+	};
+
+	if(it == end(idx) || *it != event_idx)
+		return nullptr;
+
+	const auto pos
+	{
+		std::distance(begin(idx), it)
+	};
+
+	return valid[pos]?
+		std::addressof(events[pos]):
+		nullptr;
+}
+
+[[gnu::visibility("hidden")]]
+void
+ircd::m::event::fetch::batch::query_json()
+{
+	const size_t num
+	{
+		idx.size()
+	};
+
+	// The event_id is not found in the JSON of events in newer room versions;
+	// it is queried alongside rather than once for each event afterward.
+	auto &event_id_column
+	{
+		dbs::event_column.at(json::indexof<m::event, "event_id"_>())
+	};
+
+	val.assign(num * 2, {-1UL, 0UL});
+	query(dbs::event_json, val.data());
+	query(event_id_column, val.data() + num);
+
+	// Views of the buffer are only made once it's no longer growing.
+	for(size_t i(0); i < num; ++i) try
+	{
+		if(val[i].first == -1UL)
+			continue;
+
+		const json::object source
+		{
+			value(val[i])
+		};
+
+		const string_view event_id
+		{
+			val[num + i].first != -1UL?
+				value(val[num + i]):
+				json::string(source.get("event_id"))
+		};
+
+		events[i] =
+		{
+			source, event_id, event::keys{fopts->keys}
+		};
+
+		valid[i] = true;
+	}
+	catch(const json::parse_error &e)
+	{
+		log::critical
+		{
+			m::log, "Fetching event:%lu JSON from local database :%s",
+			idx[i],
+			e.what(),
+		};
+	}
+}
+
+[[gnu::visibility("hidden")]]
+void
+ircd::m::event::fetch::batch::query_row()
+{
+	const size_t num
+	{
+		idx.size()
+	};
+
+	val.assign(num * event::size(), {-1UL, 0UL});
+	for(size_t i(0); i < event::size(); ++i)
+		if(fopts->keys.test(i))
+			if(dbs::event_column.at(i))
+				query(dbs::event_column.at(i), val.data() + num * i);
+
+	for(size_t i(0); i < event::size(); ++i)
+	{
+		if(!fopts->keys.test(i) || !dbs::event_column.at(i))
+			continue;
+
+		auto &column
+		{
+			dbs::event_column.at(i)
+		};
+
+		const bool is_string
+		{
+			describe(column).type.second == typeid(string_view)
+		};
+
+		for(size_t j(0); j < num; ++j)
+		{
+			const auto &pos
+			{
+				val[num * i + j]
+			};
+
+			if(pos.first == -1UL)
+				continue;
+
+			if(is_string)
+				json::set(events[j], db::name(column), value(pos));
+			else
+				json::set(events[j], db::name(column), byte_view<string_view>{value(pos)});
+
+			valid[j] = true;
+		}
+	}
+
+	for(size_t j(0); j < num; ++j)
+		if(valid[j] && !empty(json::get<"event_id"_>(events[j])))
+			events[j].event_id = event::id
+			{
+				json::get<"event_id"_>(events[j])
+			};
+}
+
+/// Parallel queries of the column for every idx; the position of each value
+/// found in the buffer is written to the corresponding element of out.
+[[gnu::visibility("hidden")]]
+size_t
+ircd::m::event::fetch::batch::query(db::column &column,
+                                    std::pair<size_t, size_t> *const &out)
+{
+	static const size_t batch_max
+	{
+		64
+	};
+
+	size_t ret(0);
+	for(size_t i(0); i < idx.size(); i += batch_max)
+	{
+		const size_t num
+		{
+			std::min(idx.size() - i, batch_max)
+		};
+
+		string_view key[num];
+		for(size_t j(0); j < num; ++j)
+			key[j] = fetch::key(&idx[i + j]);
+
+		const vector_view<const string_view> keys
+		(
+			key, num
+		);
+
+		ret += db::read(column, keys, [this, &out, &i]
+		(const size_t &j, const string_view &value)
+		{
+			out[i + j] = { buf.size(), ircd::size(value) };
+			buf.append(ircd::data(value), ircd::size(value));
+		}, fopts->gopts);
+	}
+
+	return ret;
+}
+
+ircd::string_view
+ircd::m::event::fetch::batch::value(const std::pair<size_t, size_t> &pos)
+const
+{
+	assert(pos.first != -1UL);
+	assert(pos.first + pos.second <= buf.size());
+	return string_view
+	{
+		buf.data() + pos.first, pos.second
+	};
+}
@@ -177,18 +177,31 @@ try
 		split(json::get<"key"_>(cond), '.')
 	};
 
+	const json::object::tape *tape
+	{
+		top == "content"?
+			opts.content:
+			nullptr
+	};
+
 	string_view value
 	{
-		json::get(event, top, json::object{})
+		tape?
+			string_view{tape->object}:
+			json::get(event, top, json::object{})
 	};
 
-	tokens(path, ".", [&value]
+	tokens(path, ".", [&value, &tape]
 	(const string_view &key)
 	{
 		if(!json::type(value, json::OBJECT))
 			return false;
 
-		value = json::object(value)[key];
+		value = tape?
+			(*tape)[key]:
+			json::object(value)[key];
+
+		tape = nullptr;
 		if(likely(!json::type(value, json::STRING)))
 			return true;
 
@@ -239,7 +252,9 @@ try
 
 	const json::string &body
 	{
-		content["body"]
+		opts.content?
+			(*opts.content)["body"]:
+			content["body"]
 	};
 
 	if(has(body, opts.user_id))
@@ -247,7 +262,9 @@ try
 
 	const json::string &formatted_body
 	{
-		content["formatted_body"]
+		opts.content?
+			(*opts.content)["formatted_body"]:
+			content["formatted_body"]
 	};
 
 	if(has(formatted_body, opts.user_id))
@@ -318,12 +335,17 @@ try
 
 	const json::string &body
 	{
-		content["body"]
+		opts.content?
+			(*opts.content)["body"]:
+			content["body"]
 	};
 
 	if(!body)
 		return false;
 
+	if(opts.displayname)
+		return !opts.displayname->empty() && has(body, *opts.displayname);
+
 	assert(opts.user_id);
 	if(unlikely(!opts.user_id))
 		return false;
@@ -16,6 +16,10 @@ namespace ircd::m
 	static void check_room_auth_rule_3(const m::event &, room::auth::hookdata &);
 	static void check_room_auth_rule_2(const m::event &, room::auth::hookdata &);
 
+	static bool room_auth_chain_reach(const event::idx &, std::map<uint64_t, uint64_t> &);
+	static bool room_auth_chain_bfs(const event::idx &, const room::auth::chain::closure &);
+
+	extern conf::item<size_t> room_auth_chain_rebuild_commit;
 	extern hook::site<room::auth::hookdata &> room_auth_hook;
 }
 
@@ -26,6 +30,13 @@ ircd::m::room_auth_hook
 	{ "exceptions",    true        },
 };
 
+decltype(ircd::m::room_auth_chain_rebuild_commit)
+ircd::m::room_auth_chain_rebuild_commit
+{
+	{ "name",     "ircd.m.room.auth.chain.rebuild.commit" },
+	{ "default",  512L                                    },
+};
+
 //
 // generate
 //
@@ -823,6 +834,30 @@ const
 	return ret;
 }
 
+bool
+ircd::m::room::auth::chain::has(const event::idx &event_idx)
+const
+{
+	dbs::chain_pos pos {0, 0};
+	dbs::event_chain_get(event_idx, [&pos]
+	(const dbs::chain_pos &self, const auto &)
+	{
+		pos = self;
+	});
+
+	std::map<uint64_t, uint64_t> reach;
+	if(pos.first && room_auth_chain_reach(idx, reach))
+	{
+		const auto it(reach.find(pos.first));
+		return it != end(reach) && pos.second <= it->second;
+	}
+
+	return !for_each([&event_idx](const auto &idx)
+	{
+		return idx != event_idx;
+	});
+}
+
 bool
 ircd::m::room::auth::chain::has(const string_view &type)
 const
@@ -846,6 +881,184 @@ const
 bool
 ircd::m::room::auth::chain::for_each(const closure &closure)
 const
+{
+	std::map<uint64_t, uint64_t> reach;
+	if(!room_auth_chain_reach(idx, reach))
+		return room_auth_chain_bfs(idx, closure);
+
+	// All events on each chain up to the greatest seq reached are in the
+	// auth chain; a chain is a prefix scan of _chain_event.
+	std::vector<event::idx> ae;
+	for(const auto &[chain, seq] : reach)
+	{
+		char buf[dbs::EVENT_CHAIN_KEY_MAX_SIZE];
+		for(auto it(dbs::chain_event.begin(dbs::chain_event_key(buf, chain))); it; ++it)
+		{
+			if(dbs::chain_event_key(it->first) > seq)
+				break;
+
+			ae.emplace_back(byte_view<event::idx>(it->second));
+		}
+	}
+
+	std::sort(begin(ae), end(ae));
+	ae.erase(std::unique(begin(ae), end(ae)), end(ae));
+	for(const auto &idx : ae)
+		if(!closure(idx))
+			return false;
+
+	return true;
+}
+
+size_t
+ircd::m::room::auth::chain::rebuild()
+{
+	static const event::fetch::opts fopts
+	{
+		event::keys::include {"room_id", "state_key", "auth_events"}
+	};
+
+	static const m::events::range range
+	{
+		0, -1UL, &fopts
+	};
+
+	// Live evals label their events against the chain tips committed to the
+	// database, so each batch is labeled and committed while the evals are
+	// held off; otherwise both could extend the same tip. The scan itself
+	// only collects the state events and runs concurrently.
+	std::vector<event::idx> batch;
+	batch.reserve(size_t(room_auth_chain_rebuild_commit));
+	const auto commit{[&batch]
+	{
+		const vm::sequence::hold hold;
+		db::txn txn
+		{
+			*m::dbs::events
+		};
+
+		// Events are labeled in the order they were written, so every auth
+		// event has been labeled (or pends in txn) before the events it auths.
+		dbs::write_opts wopts;
+		wopts.appendix.reset();
+		wopts.appendix.set(dbs::appendix::EVENT_CHAIN);
+		wopts.interpose = &txn;
+
+		m::event::fetch event
+		{
+			fopts
+		};
+
+		for(const auto &event_idx : batch)
+		{
+			if(!seek(std::nothrow, event, event_idx))
+				continue;
+
+			wopts.event_idx = event_idx;
+			dbs::write(txn, event, wopts);
+		}
+
+		txn();
+		batch.clear();
+	}};
+
+	size_t ret(0);
+	m::events::for_each(range, [&batch, &commit, &ret]
+	(const event::idx &event_idx, const m::event &event)
+	{
+		if(!json::get<"room_id"_>(event))
+			return true;
+
+		if(!defined(json::get<"state_key"_>(event)))
+			return true;
+
+		batch.emplace_back(event_idx);
+		++ret;
+
+		if(ret % size_t(room_auth_chain_rebuild_commit) == 0UL)
+		{
+			log::info
+			{
+				log, "Auth chain index rebuild events %zu of %zu num:%zu",
+				event_idx,
+				vm::sequence::retired,
+				ret,
+			};
+
+			commit();
+		}
+
+		return true;
+	});
+
+	if(!batch.empty())
+		commit();
+
+	log::notice
+	{
+		log, "Auth chain index rebuild complete events:%zu",
+		ret,
+	};
+
+	return ret;
+}
+
+/// Greatest seq of each chain in the auth chain of the event. Events which
+/// aren't labeled themselves (i.e. non-state events) are answered from their
+/// auth_events. False when any of those is not labeled.
+bool
+ircd::m::room_auth_chain_reach(const event::idx &idx,
+                               std::map<uint64_t, uint64_t> &reach)
+{
+	const auto merge{[&reach]
+	(const dbs::chain_pos &pos, const vector_view<const dbs::chain_pos> &labels)
+	{
+		for(const auto &[chain, seq] : labels)
+			reach[chain] = std::max(reach[chain], seq);
+	}};
+
+	if(dbs::event_chain_get(idx, merge))
+		return true;
+
+	const m::event::fetch event
+	{
+		std::nothrow, idx
+	};
+
+	if(!event.valid)
+		return false;
+
+	const event::auth auth{event};
+	event::idx auth_idxs[auth.MAX];
+	const auto &auth_idx
+	{
+		auth.idxs(auth_idxs)
+	};
+
+	for(const auto &ref : auth_idx)
+	{
+		const auto labeled
+		{
+			ref && dbs::event_chain_get(ref, [&reach, &merge]
+			(const dbs::chain_pos &pos, const vector_view<const dbs::chain_pos> &labels)
+			{
+				merge(pos, labels);
+				reach[pos.first] = std::max(reach[pos.first], pos.second);
+			})
+		};
+
+		if(!labeled)
+			return false;
+	}
+
+	return true;
+}
+
+/// Traversal of the auth graph; taken for events the chain index can't
+/// answer for.
+bool
+ircd::m::room_auth_chain_bfs(const event::idx &idx,
+                             const room::auth::chain::closure &closure)
 {
 	m::event::fetch e, a;
 	std::set<event::idx> ae;
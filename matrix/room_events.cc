@@ -143,12 +143,18 @@ ircd::m::room::events::count(const m::room &room,
 		range
 	};
 
+	// The counted index answers with two seeks when it covers `a`; history
+	// from before the index existed falls back to iterating the room.
+	size_t ret{0};
+	assert(a <= b);
+	if(a < b && dbs::room_count_range(ret, room.room_id, string_view{}, {a, b - 1}))
+		return ret;
+
 	m::room::events it
 	{
 		room
 	};
 
-	assert(a <= b);
 	it.seek_idx(a);
 	if(!it && !exists(room))
 		throw m::NOT_FOUND
@@ -165,7 +171,6 @@ ircd::m::room::events::count(const m::room &room,
 			string_view{room.room_id}
 		};
 
-	size_t ret{0};
 	// Hit the iterator once first otherwise the count will always increment
 	// to `1` erroneously when it ought to show `0`.
 	for(++it; it && it.event_idx() < b; ++it, ++ret);
@@ -54,6 +54,9 @@ ircd::m::room::members::count(const string_view &membership,
 const
 {
 	size_t ret{0};
+	if(membership && room::stats::members(ret, room, membership, host))
+		return ret;
+
 	for_each(membership, host, closure{[&ret]
 	(const user::id &user_id)
 	{
@@ -937,11 +937,15 @@ ircd::m::room::state::rebuild::rebuild(const room::id &room_id)
 	opts.appendix.reset();
 	opts.appendix.set(dbs::appendix::ROOM_STATE);
 	opts.appendix.set(dbs::appendix::ROOM_JOINED);
+	opts.appendix.set(dbs::appendix::ROOM_STATS);
 	db::txn txn
 	{
 		*m::dbs::events
 	};
 
+	// The member counters see the deletions made below.
+	opts.interpose = &txn;
+
 	m::event::fetch event;
 	ssize_t added(0), deleted(0);
 	present_state.for_each([&opts, &txn, &deleted, &event]
@@ -8,6 +8,205 @@
 // copyright notice and this permission notice is present in all copies. The
 // full license for this software is available in the LICENSE file.
 
+//
+// stats::rebuild
+//
+
+ircd::m::room::stats::rebuild::rebuild(const room::id &room_id)
+{
+	// Evals merge their deltas into the counters replaced here, so they're
+	// held off from the recount until its result is committed.
+	const vm::sequence::hold hold;
+
+	db::txn txn
+	{
+		*dbs::events
+	};
+
+	// Existing counters are dropped; any not recounted below were stale.
+	char buf[dbs::ROOM_STATS_KEY_MAX_SIZE];
+	for(auto it(dbs::room_stats.begin(dbs::room_stats_key(buf, room_id))); it; ++it)
+	{
+		const auto &[name, host]
+		{
+			dbs::room_stats_key(it->first)
+		};
+
+		db::txn::append
+		{
+			txn, dbs::room_stats,
+			{
+				db::op::DELETE,
+				name?
+					dbs::room_stats_key(buf, room_id, name, host):
+					dbs::room_stats_key(buf, room_id),
+			}
+		};
+	}
+
+	static const db::gopts gopts
+	{
+		db::get::NO_CACHE
+	};
+
+	int64_t events(0), json(0);
+	for(m::room::events it(room_id); it; --it, ++events)
+	{
+		const byte_view<string_view> key
+		{
+			it.event_idx()
+		};
+
+		json += db::bytes_value(dbs::event_json, key, gopts);
+	}
+
+	std::map<std::pair<std::string, std::string>, int64_t> members;
+	const m::room::state state
+	{
+		room_id
+	};
+
+	state.for_each("m.room.member", [&members]
+	(const string_view &type, const string_view &state_key, const event::idx &event_idx)
+	{
+		char name_buf[dbs::ROOM_STATS_NAME_MAX_SIZE];
+		char membership_buf[dbs::ROOM_STATS_NAME_MAX_SIZE];
+		const string_view name
+		{
+			dbs::room_stats_member(name_buf, m::membership(membership_buf, event_idx))
+		};
+
+		if(!name)
+			return true;
+
+		++members[{std::string(name), std::string{}}];
+		if(valid(id::USER, state_key))
+			++members[{std::string(name), std::string(m::user::id(state_key).host())}];
+
+		return true;
+	});
+
+	const auto set{[&txn, &buf, &room_id]
+	(const string_view &name, const string_view &host, const int64_t &val)
+	{
+		db::txn::append
+		{
+			txn, dbs::room_stats,
+			{
+				db::op::SET,
+				dbs::room_stats_key(buf, room_id, name, host),
+				byte_view<string_view>{val},
+			}
+		};
+	}};
+
+	set("events", {}, events);
+	set("json", {}, json);
+	for(const auto &[key, val] : members)
+		set(key.first, key.second, val);
+
+	const event::idx create_idx
+	{
+		m::room(room_id).get(std::nothrow, "m.room.create", "")
+	};
+
+	db::txn::append
+	{
+		txn, dbs::room_stats,
+		{
+			db::op::SET,
+			dbs::room_stats_key(buf, room_id),
+			byte_view<string_view>{create_idx},
+		}
+	};
+
+	log::info
+	{
+		log, "Counters of %s rebuilt with events:%ld json:%ld members:%zu",
+		string_view{room_id},
+		events,
+		json,
+		members.size(),
+	};
+
+	txn();
+}
+
+//
+// stats
+//
+
+/// Whether the counters of the room are known to be complete; counters are
+/// only used for the present state.
+bool
+ircd::m::room::stats::complete(const m::room &room)
+{
+	if(!m::room::state(room).present())
+		return false;
+
+	char buf[dbs::ROOM_STATS_KEY_MAX_SIZE];
+	return db::has(dbs::room_stats, dbs::room_stats_key(buf, room.room_id));
+}
+
+/// A counter of the room. False when the counters are not complete. A
+/// counter which was never written is zero.
+bool
+ircd::m::room::stats::get(int64_t &ret,
+                          const m::room &room,
+                          const string_view &name,
+                          const string_view &host)
+{
+	if(!complete(room))
+		return false;
+
+	char buf[dbs::ROOM_STATS_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		dbs::room_stats_key(buf, room.room_id, name, host)
+	};
+
+	ret = 0;
+	dbs::room_stats(key, std::nothrow, [&ret]
+	(const string_view &val)
+	{
+		ret = byte_view<int64_t>(val);
+	});
+
+	return true;
+}
+
+bool
+ircd::m::room::stats::members(size_t &ret,
+                              const m::room &room,
+                              const string_view &membership,
+                              const string_view &host)
+{
+	char buf[dbs::ROOM_STATS_NAME_MAX_SIZE];
+	const string_view name
+	{
+		dbs::room_stats_member(buf, membership)
+	};
+
+	int64_t counted;
+	if(!name || !get(counted, room, name, host))
+		return false;
+
+	ret = std::max(counted, 0L);
+	return true;
+}
+
+size_t
+ircd::m::room::stats::events(const m::room &room)
+{
+	int64_t counted;
+	if(get(counted, room, "events"))
+		return std::max(counted, 0L);
+
+	size_t ret(0);
+	for(m::room::events it(room); it; --it, ++ret);
+	return ret;
+}
+
 size_t
 __attribute__((noreturn))
 ircd::m::room::stats::bytes_total(const m::room &room)
@@ -31,6 +230,10 @@ ircd::m::room::stats::bytes_total_compressed(const m::room &room)
 size_t
 ircd::m::room::stats::bytes_json(const m::room &room)
 {
+	int64_t counted;
+	if(get(counted, room, "json"))
+		return std::max(counted, 0L);
+
 	size_t ret(0);
 	for(m::room::events it(room); it; --it)
 	{
@@ -0,0 +1,218 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::search
+{
+	static bool _room_equal(const string_view &amalgam, const room::id &);
+
+	extern conf::item<size_t> terms_max;
+	extern conf::item<size_t> rebuild_commit;
+}
+
+decltype(ircd::m::search::terms_max)
+ircd::m::search::terms_max
+{
+	{ "name",     "ircd.m.search.terms.max" },
+	{ "default",  8L                        },
+	{ "description",
+
+	R"(
+	Maximum number of terms taken from a search string. Terms beyond this
+	limit are ignored by the query.
+	)"}
+};
+
+decltype(ircd::m::search::rebuild_commit)
+ircd::m::search::rebuild_commit
+{
+	{ "name",     "ircd.m.search.rebuild.commit" },
+	{ "default",  65536L                         },
+};
+
+void
+ircd::m::search::rebuild()
+{
+	static const event::fetch::opts fopts
+	{
+		event::keys::include {"room_id", "content"}
+	};
+
+	static const m::events::range range
+	{
+		0, -1UL, &fopts
+	};
+
+	db::txn txn
+	{
+		*m::dbs::events
+	};
+
+	dbs::write_opts wopts;
+	wopts.appendix.reset();
+	wopts.appendix.set(dbs::appendix::EVENT_TERM);
+
+	size_t ret(0);
+	m::events::for_each(range, [&txn, &wopts, &ret]
+	(const event::idx &event_idx, const m::event &event)
+	{
+		if(!json::get<"room_id"_>(event))
+			return true;
+
+		wopts.event_idx = event_idx;
+		dbs::write(txn, event, wopts);
+		++ret;
+
+		if(ret % size_t(rebuild_commit) == 0UL)
+		{
+			log::info
+			{
+				log, "Search term index rebuild events %zu of %zu num:%zu txn:%zu %s",
+				event_idx,
+				vm::sequence::retired,
+				ret,
+				txn.size(),
+				pretty(iec(txn.bytes())),
+			};
+
+			txn();
+			txn.clear();
+		}
+
+		return true;
+	});
+
+	txn();
+
+	log::notice
+	{
+		log, "Search term index rebuild complete events:%zu",
+		ret,
+	};
+}
+
+/// Posting lists for each term are intersected by leapfrogging: the greatest
+/// key among the iterators becomes the target and every lagging iterator
+/// seeks directly to it. Only keys present in all lists are presented, so the
+/// cost is bounded by the size of the shortest posting list rather than the
+/// history of the room(s).
+bool
+ircd::m::search::for_each(const string_view &search_term,
+                          const room::id &room_id,
+                          const closure &closure)
+{
+	static const size_t max_terms
+	{
+		16
+	};
+
+	const size_t max
+	{
+		std::clamp(size_t(terms_max), 1UL, max_terms)
+	};
+
+	size_t terms(0);
+	string_view term[max_terms];
+	char termbuf[max_terms][dbs::EVENT_TERM_MAX_SIZE];
+	dbs::event_term_for_each(search_term, [&terms, &term, &termbuf, &max]
+	(const string_view &_term, const uint16_t &freq)
+	{
+		term[terms] = strncpy(termbuf[terms], _term, sizeof(termbuf[terms]));
+		return ++terms < max;
+	});
+
+	if(!terms)
+		return true;
+
+	char keybuf[dbs::EVENT_TERM_KEY_MAX_SIZE];
+	std::vector<db::domain::const_iterator> it;
+	it.reserve(terms);
+	for(size_t i(0); i < terms; ++i)
+	{
+		const string_view &key
+		{
+			room_id?
+				dbs::event_term_key(keybuf, term[i], room_id):
+				dbs::event_term_key(keybuf, term[i])
+		};
+
+		it.emplace_back(dbs::event_term.begin(key));
+		if(!it.back())
+			return true;
+	}
+
+	const auto seek{[&term, &keybuf]
+	(auto &it, const size_t &i, const string_view &target)
+	{
+		mutable_buffer buf{keybuf};
+		consume(buf, copy(buf, term[i]));
+		consume(buf, copy(buf, target));
+		return db::seek(it, string_view{keybuf, data(buf)});
+	}};
+
+	char hibuf[dbs::EVENT_TERM_KEY_MAX_SIZE];
+	string_view hi
+	{
+		strncpy(hibuf, it[0]->first, sizeof(hibuf))
+	};
+
+	for(size_t i(1), agree(1);; ++i)
+	{
+		if(room_id && !_room_equal(hi, room_id))
+			return true;
+
+		if(agree < terms)
+		{
+			const auto j(i % terms);
+			if(it[j]->first < hi && !seek(it[j], j, hi))
+				return true;
+
+			if(it[j]->first == hi)
+				++agree;
+			else
+			{
+				hi = strncpy(hibuf, it[j]->first, sizeof(hibuf));
+				agree = 1;
+			}
+
+			continue;
+		}
+
+		long rank(0);
+		for(size_t j(0); j < terms; ++j)
+			rank += byte_view<uint16_t>(it[j]->second);
+
+		const auto &[_room_id, event_idx]
+		{
+			dbs::event_term_key(hi)
+		};
+
+		if(!closure(m::room::id{_room_id}, event_idx, rank))
+			return false;
+
+		if(!++it[0])
+			return true;
+
+		hi = strncpy(hibuf, it[0]->first, sizeof(hibuf));
+		agree = 1;
+		i = 0;
+	}
+}
+
+bool
+ircd::m::search::_room_equal(const string_view &amalgam,
+                             const room::id &room_id)
+{
+	const auto &[_room_id, _]
+	{
+		dbs::event_term_key(amalgam)
+	};
+
+	return _room_id == room_id;
+}
@@ -69,6 +69,9 @@ ircd::m::user::notifications::count(const opts &opts)
 const
 {
 	size_t ret(0);
+	if(opts.room_id && opts.only && count_indexed(ret, opts))
+		return ret;
+
 	for_each(opts, closure_meta{[&ret]
 	(const auto &, const auto &)
 	{
@@ -79,6 +82,32 @@ const
 	return ret;
 }
 
+/// Notifications specific to a room are counted by the room_count index in
+/// the user's room; false when it can't answer for the range.
+bool
+ircd::m::user::notifications::count_indexed(size_t &ret,
+                                            const opts &opts)
+const
+{
+	const user::room user_room
+	{
+		user
+	};
+
+	char type_buf[event::TYPE_MAX_SIZE];
+	const auto type
+	{
+		make_type(type_buf, opts)
+	};
+
+	const event::idx_range range
+	{
+		opts.to, opts.from?: -1UL
+	};
+
+	return dbs::room_count_range(ret, user_room.room_id, type, range);
+}
+
 bool
 ircd::m::user::notifications::for_each(const opts &opts,
                                        const closure &closure)
@@ -110,3 +110,94 @@ const
 		return true;
 	});
 }
+
+bool
+ircd::m::user::rooms::for_each_touched(const event::idx &since,
+                                       const closure_touched &closure)
+const
+{
+	char buf[dbs::USER_TOUCH_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		dbs::user_touch_key(buf, user)
+	};
+
+	for(auto it(dbs::user_touch.begin(key)); it; ++it)
+	{
+		const event::idx event_idx
+		{
+			byte_view<event::idx>(it->second)
+		};
+
+		if(event_idx < since)
+			continue;
+
+		const m::room::id &room_id
+		{
+			dbs::user_touch_key(it->first)
+		};
+
+		if(!closure(room_id, event_idx))
+			return false;
+	}
+
+	return true;
+}
+
+size_t
+ircd::m::user::rooms::rebuild_touched()
+{
+	db::txn txn
+	{
+		*dbs::events
+	};
+
+	m::users::opts opts;
+	opts.hostpart = origin(my());
+
+	size_t ret(0);
+	m::users::for_each(opts, [&txn, &ret]
+	(const m::user &user)
+	{
+		const m::user::rooms rooms
+		{
+			user
+		};
+
+		rooms.for_each([&txn, &user, &ret]
+		(const m::room &room, const string_view &membership)
+		{
+			const event::idx event_idx
+			{
+				m::head_idx(std::nothrow, room)
+			};
+
+			if(!event_idx)
+				return;
+
+			char buf[dbs::USER_TOUCH_KEY_MAX_SIZE];
+			db::txn::append
+			{
+				txn, dbs::user_touch,
+				{
+					db::op::SET,
+					dbs::user_touch_key(buf, user, room.room_id),
+					byte_view<string_view>{event_idx},
+				}
+			};
+
+			++ret;
+		});
+
+		if(txn.size() >= 65536)
+		{
+			txn();
+			txn.clear();
+		}
+
+		return true;
+	});
+
+	txn();
+	return ret;
+}
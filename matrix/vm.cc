@@ -194,6 +194,34 @@ ircd::m::vm::sequence::committed;
 decltype(ircd::m::vm::sequence::uncommitted)
 ircd::m::vm::sequence::uncommitted;
 
+decltype(ircd::m::vm::sequence::committing)
+ircd::m::vm::sequence::committing;
+
+decltype(ircd::m::vm::sequence::held)
+ircd::m::vm::sequence::held;
+
+ircd::m::vm::sequence::hold::hold()
+{
+	sequence::dock.wait([]
+	{
+		return !held;
+	});
+
+	held = true;
+	sequence::dock.wait([]
+	{
+		return !committing;
+	});
+}
+
+ircd::m::vm::sequence::hold::~hold()
+noexcept
+{
+	assert(held);
+	held = false;
+	sequence::dock.notify_all();
+}
+
 uint64_t
 ircd::m::vm::sequence::min()
 {
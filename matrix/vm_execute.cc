@@ -17,6 +17,8 @@ namespace ircd::m::vm
 	static void emption_check(eval &, const event &);
 	static size_t calc_txn_reserve(const opts &, const event &);
 	static void write_commit(eval &);
+	static bool write_group_conflict(const eval &);
+	static void write_group(eval &);
 	static void write_append(eval &, const event &, const bool &);
 	static fault execute_edu(eval &, const event &);
 	static fault execute_pdu(eval &, const event &);
@@ -41,6 +43,19 @@ namespace ircd::m::vm
 	extern conf::item<bool> log_commit_debug;
 	extern conf::item<bool> log_accept_debug;
 	extern conf::item<bool> log_accept_info;
+	extern conf::item<bool> write_group_enable;
+	extern conf::item<size_t> write_group_max;
+	extern conf::item<microseconds> write_group_window;
+
+	extern stats::item<uint64_t> write_group_commits;
+	extern stats::item<uint64_t> write_group_evals;
+	extern stats::item<uint64_t> write_group_size_last;
+	extern stats::item<uint64_t> write_group_size_max;
+	extern stats::item<microseconds> write_group_latency_last;
+	extern stats::item<microseconds> write_group_latency_total;
+
+	static std::vector<eval *> write_group_queue;
+	static size_t write_group_blocked;
 }
 
 decltype(ircd::m::vm::log_commit_debug)
@@ -64,6 +79,77 @@ ircd::m::vm::log_accept_info
 	{ "default",  false                       },
 };
 
+decltype(ircd::m::vm::write_group_enable)
+ircd::m::vm::write_group_enable
+{
+	{ "name",     "ircd.m.vm.write.group.enable" },
+	{ "default",  false                          },
+	{ "description",
+
+	R"(
+	Enables group commit. Evals reaching the WRITE phase within the window
+	are merged into a single database transaction and retired together. The
+	sequence order is preserved; evals depending on an unwritten eval in the
+	group (i.e. in the same room) force the group to be written first.
+	)"}
+};
+
+decltype(ircd::m::vm::write_group_max)
+ircd::m::vm::write_group_max
+{
+	{ "name",     "ircd.m.vm.write.group.max" },
+	{ "default",  64L                         },
+};
+
+decltype(ircd::m::vm::write_group_window)
+ircd::m::vm::write_group_window
+{
+	{ "name",     "ircd.m.vm.write.group.window" },
+	{ "default",  2500L                          },
+};
+
+decltype(ircd::m::vm::write_group_commits)
+ircd::m::vm::write_group_commits
+{
+	{ "name", "ircd.m.vm.write.group.commits" },
+	{ "desc", "Number of group transactions written to the events database" },
+};
+
+decltype(ircd::m::vm::write_group_evals)
+ircd::m::vm::write_group_evals
+{
+	{ "name", "ircd.m.vm.write.group.evals" },
+	{ "desc", "Number of evals retired by group transactions" },
+};
+
+decltype(ircd::m::vm::write_group_size_last)
+ircd::m::vm::write_group_size_last
+{
+	{ "name", "ircd.m.vm.write.group.size.last" },
+	{ "desc", "Number of evals in the last group transaction" },
+};
+
+decltype(ircd::m::vm::write_group_size_max)
+ircd::m::vm::write_group_size_max
+{
+	{ "name", "ircd.m.vm.write.group.size.max" },
+	{ "desc", "Largest number of evals in any group transaction" },
+};
+
+decltype(ircd::m::vm::write_group_latency_last)
+ircd::m::vm::write_group_latency_last
+{
+	{ "name", "ircd.m.vm.write.group.latency.last" },
+	{ "desc", "Time from the first eval entering the group until written" },
+};
+
+decltype(ircd::m::vm::write_group_latency_total)
+ircd::m::vm::write_group_latency_total
+{
+	{ "name", "ircd.m.vm.write.group.latency.total" },
+	{ "desc", "Accumulated time from group formation until written" },
+};
+
 decltype(ircd::m::vm::issue_hook)
 ircd::m::vm::issue_hook
 {
@@ -251,6 +337,22 @@ ircd::m::vm::execute(eval &eval,
 				0UL
 		};
 
+		// Bitset indicating which events had their signatures verified by
+		// the batch; the others undergo the VERIFY phase individually.
+		const bool batch_verify
+		{
+			opts.phase[phase::VERIFY]
+			&& opts.mverify
+			&& j > 1
+		};
+
+		const uint64_t verified
+		{
+			batch_verify?
+				m::verify(vector_view<const event>(events.data() + i, j), ~existing):
+				0UL
+		};
+
 		for(k = 0; k < j; ++k, ++eval.evaluated) try
 		{
 			const bool exists
@@ -263,6 +365,11 @@ ircd::m::vm::execute(eval &eval,
 				events[i + k]
 			};
 
+			const scope_restore eval_verified
+			{
+				eval.verified, bool(verified & (1UL << k))
+			};
+
 			const auto fault
 			{
 				!exists?
@@ -859,7 +966,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 			eval.phase, phase::VERIFY
 		};
 
-		if(!verify(event))
+		if(!eval.verified && !verify(event))
 			throw m::BAD_SIGNATURE
 			{
 				"Signature verification failed."
@@ -1010,15 +1117,38 @@ ircd::m::vm::execute_pdu(eval &eval,
 		eval.phase, phase::COMMIT
 	};
 
-	// Wait until this is the lowest sequence number
+	// Wait until this is the lowest sequence number; also held here while
+	// maintenance has the indexes (see sequence::hold).
 	sequence::dock.wait([&eval, &parent_post]
 	{
 		return false
 		|| parent_post
-		|| eval::seqnext(sequence::committed) == &eval
+		|| (eval::seqnext(sequence::committed) == &eval && !sequence::held)
 		;
 	});
 
+	// Counted until this function returns after the eval has retired.
+	const scope_count committing
+	{
+		sequence::committing
+	};
+
+	// When group commit holds prior evals which have not yet been written,
+	// any eval which might observe their effects has to wait for the group.
+	if(!parent_post && write_group_conflict(eval))
+	{
+		const scope_count blocked
+		{
+			write_group_blocked
+		};
+
+		sequence::dock.notify_all();
+		sequence::dock.wait([&eval]
+		{
+			return !write_group_conflict(eval);
+		});
+	}
+
 	// Reevaluation of auth against the present state of the room.
 	if(likely(opts.phase[phase::AUTH_PRES] && authenticate))
 	{
@@ -1079,7 +1209,10 @@ ircd::m::vm::execute_pdu(eval &eval,
 			eval.phase, phase::WRITE
 		};
 
-		write_commit(eval);
+		if(bool(write_group_enable) && !eval.room_internal)
+			write_group(eval);
+		else
+			write_commit(eval);
 	}
 
 	// Wait for sequencing only if this is the stack base, otherwise we'll
@@ -1176,6 +1309,130 @@ ircd::m::vm::write_commit(eval &eval)
 	#endif
 }
 
+/// Group commit. The first eval to enter becomes the leader and waits a short
+/// window for subsequent evals to join; their transactions are then appended
+/// to the leader's and written once. Followers wait for the leader and are
+/// retired in sequence order afterward as usual.
+void
+ircd::m::vm::write_group(eval &eval)
+{
+	assert(eval.txn);
+	const ctx::uninterruptible::nothrow ui;
+	write_group_queue.emplace_back(&eval);
+	sequence::dock.notify_all();
+
+	const bool leader
+	{
+		write_group_queue.front() == &eval
+	};
+
+	if(!leader)
+	{
+		sequence::dock.wait([&eval]
+		{
+			return !std::count(begin(write_group_queue), end(write_group_queue), &eval);
+		});
+
+		if(unlikely(eval.txn->state != db::txn::state::COMMITTED))
+			throw error
+			{
+				fault::GENERAL, "Group transaction was not committed."
+			};
+
+		return;
+	}
+
+	const ircd::timer timer;
+	const auto deadline
+	{
+		now<system_point>() + microseconds(write_group_window)
+	};
+
+	// Wait for more evals unless nothing else is in flight to join us, or
+	// a later eval is blocked on the effects of this group.
+	sequence::dock.wait_until(deadline, []
+	{
+		return false
+		|| write_group_blocked
+		|| write_group_queue.size() >= size_t(write_group_max)
+		|| write_group_queue.size() >= sequence::pending
+		;
+	});
+
+	const unwind release{[]
+	{
+		write_group_queue.clear();
+		sequence::dock.notify_all();
+	}};
+
+	assert(write_group_queue.front() == &eval);
+	auto &txn
+	{
+		*eval.txn
+	};
+
+	std::for_each(begin(write_group_queue) + 1, end(write_group_queue), [&txn]
+	(const auto *const &follower)
+	{
+		assert(follower->txn);
+		db::txn::append
+		{
+			txn, *follower->txn
+		};
+	});
+
+	write_commit(eval);
+	for(auto *const &follower : write_group_queue)
+		follower->txn->state = db::txn::state::COMMITTED;
+
+	const auto elapsed
+	{
+		timer.at<microseconds>()
+	};
+
+	const auto count
+	{
+		write_group_queue.size()
+	};
+
+	++write_group_commits;
+	write_group_evals += count;
+	write_group_size_last = count;
+	write_group_size_max = std::max(uint64_t(write_group_size_max), uint64_t(count));
+	write_group_latency_last = elapsed;
+	static_cast<microseconds &>(write_group_latency_total) += elapsed;
+
+	if(count > 1)
+		log::debug
+		{
+			log, "%s group wrote %zu evals %zu cells in %zu bytes in %ld$us",
+			loghead(eval),
+			count,
+			txn.size(),
+			txn.bytes(),
+			elapsed.count(),
+		};
+}
+
+/// True when the eval must wait for the pending group transaction to be
+/// written before it can observe the database; conservatively this is any
+/// eval in a room also held by the group, or any internal room eval.
+bool
+ircd::m::vm::write_group_conflict(const eval &eval)
+{
+	if(likely(write_group_queue.empty()))
+		return false;
+
+	if(eval.room_internal)
+		return true;
+
+	return std::any_of(begin(write_group_queue), end(write_group_queue), [&eval]
+	(const auto *const &pending)
+	{
+		return pending->room_id == eval.room_id;
+	});
+}
+
 void
 ircd::m::vm::write_append(eval &eval,
                           const event &event,
@@ -138,38 +138,59 @@ get__messages(client &client,
 		room
 	};
 
-	for(; it; page.dir == 'b'? --it : ++it)
+	// Events are fetched together for each window of the iteration; a window
+	// covers what remains to satisfy the limit and one more event, which
+	// becomes the end token when the limit is reached.
+	bool more {false};
+	m::event::fetch::batch events;
+	std::vector<m::event::idx> window;
+	window.reserve(page.limit + 1);
+	while(it && !more)
 	{
-		const m::event &event
+		window.clear();
+		for(; it && window.size() <= page.limit - hit; page.dir == 'b'? --it : ++it)
+			window.emplace_back(it.event_idx());
+
+		events(window);
+		for(size_t i(0); i < window.size(); ++i)
 		{
-			*it
-		};
+			const m::event *const event
+			{
+				events.find(window[i])
+			};
 
-		end = event.event_id;
-		if(hit >= page.limit || miss >= size_t(max_filter_miss))
-			break;
+			if(!event)
+				continue;
 
-		const bool ok
-		{
-			(empty(filter_json) || match(filter, event))
+			end = event->event_id;
+			if(hit >= page.limit || miss >= size_t(max_filter_miss))
+			{
+				more = true;
+				break;
+			}
 
-			&& visible(event, request.user_id)
+			const bool ok
+			{
+				(empty(filter_json) || match(filter, *event))
 
-			&& _append(chunk, event, it.event_idx(), user_room, room_depth)
-		};
+				&& visible(*event, request.user_id)
+
+				&& _append(chunk, *event, window[i], user_room, room_depth)
+			};
 
-		hit += ok;
-		miss += !ok;
+			hit += ok;
+			miss += !ok;
+		}
 	}
 	chunk.~array();
 
-	if(it || page.dir == 'b')
+	if(more || it || page.dir == 'b')
 		json::stack::member
 		{
 			top, "start", json::value{start}
 		};
 
-	if(it || page.dir != 'b')
+	if(more || it || page.dir != 'b')
 		json::stack::member
 		{
 			top, "end", json::value{end}
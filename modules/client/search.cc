@@ -12,6 +12,9 @@ namespace ircd::m::search
 {
 	static bool handle_result(result &, const query &);
 	static bool handle_content(result &, const query &, const json::object &);
+	static bool handle_indexed(result &, const query &);
+	static bool query_index_ranked(result &, const query &, const json::array &rooms);
+	static bool query_index(result &, const query &, const room::id &);
 	static bool query_all_rooms(result &, const query &);
 	static bool query_room(result &, const query &, const room::id &);
 	static bool query_rooms(result &, const query &);
@@ -19,6 +22,8 @@ namespace ircd::m::search
 	static resource::response search_post_handle(client &, const resource::request &);
 
 	extern conf::item<bool> count_total;
+	extern conf::item<bool> index_enable;
+	extern conf::item<size_t> index_rank_max;
 	extern resource::method search_post;
 	extern resource search_resource;
 	extern log::log log;
@@ -70,6 +75,34 @@ ircd::m::search::count_total
 	{ "default",  false                       },
 };
 
+decltype(ircd::m::search::index_enable)
+ircd::m::search::index_enable
+{
+	{ "name",     "ircd.m.search.index" },
+	{ "default",  false                 },
+	{ "description",
+
+	R"(
+	Answer queries from the inverted term index rather than scanning the
+	content of every event. New events are always indexed, but events which
+	predate the index must be indexed first with the console command
+	`search rebuild` or they will not be found.
+	)"}
+};
+
+decltype(ircd::m::search::index_rank_max)
+ircd::m::search::index_rank_max
+{
+	{ "name",     "ircd.m.search.index.rank.max" },
+	{ "default",  4096L                          },
+	{ "description",
+
+	R"(
+	Maximum number of matches considered when ordering results by rank. The
+	most recent matches of each room are considered first.
+	)"}
+};
+
 ircd::m::resource::response
 ircd::m::search::search_post_handle(client &client,
                                     const resource::request &request)
@@ -252,6 +285,14 @@ ircd::m::search::query_rooms(result &result,
 		*result.out, "results"
 	};
 
+	const bool ranked
+	{
+		json::get<"order_by"_>(query.room_events) != "recent"
+	};
+
+	if(index_enable && ranked)
+		return query_index_ranked(result, query, rooms);
+
 	if(rooms.empty())
 		return query_all_rooms(result, query);
 
@@ -279,6 +320,9 @@ ircd::m::search::query_room(result &result,
 			string_view{room_id},
 		};
 
+	if(index_enable)
+		return query_index(result, query, room_id);
+
 	const m::room::content content
 	{
 		room
@@ -302,6 +346,9 @@ ircd::m::search::query_all_rooms(result &result,
 			"You are not an operator."
 		};
 
+	if(index_enable)
+		return query_index(result, query, room::id{});
+
 	return m::events::content::for_each([&result, &query]
 	(const auto &event_idx, const json::object &content)
 	{
@@ -310,6 +357,124 @@ ircd::m::search::query_all_rooms(result &result,
 	});
 }
 
+bool
+ircd::m::search::query_index_ranked(result &result,
+                                    const query &query,
+                                    const json::array &rooms)
+{
+	using candidate = std::pair<long, event::idx>;
+
+	std::vector<candidate> candidates;
+	const auto collect{[&candidates]
+	(const room::id &room_id, const event::idx &event_idx, const long &rank)
+	{
+		candidates.emplace_back(rank, event_idx);
+		return candidates.size() < size_t(index_rank_max);
+	}};
+
+	if(rooms.empty() && !is_oper(query.user_id))
+		throw m::ACCESS_DENIED
+		{
+			"You are not an operator."
+		};
+
+	if(rooms.empty())
+		m::search::for_each(query.search_term, collect);
+
+	for(const json::string room_id : rooms)
+	{
+		if(!visible(m::room(room_id), query.user_id))
+			throw m::ACCESS_DENIED
+			{
+				"You are not permitted to view %s",
+				string_view{room_id},
+			};
+
+		if(!m::search::for_each(query.search_term, room_id, collect))
+			break;
+	}
+
+	// Highest rank first; ties are broken by the most recent event.
+	std::sort(rbegin(candidates), rend(candidates));
+	for(const auto &[rank, event_idx] : candidates)
+	{
+		result.rank = rank;
+		result.event_idx = event_idx;
+		if(!handle_indexed(result, query))
+			return false;
+	}
+
+	return true;
+}
+
+bool
+ircd::m::search::query_index(result &result,
+                             const query &query,
+                             const room::id &room_id)
+{
+	return m::search::for_each(query.search_term, room_id, [&result, &query]
+	(const room::id &room_id, const event::idx &event_idx, const long &rank)
+	{
+		result.rank = rank;
+		result.event_idx = event_idx;
+		return handle_indexed(result, query);
+	});
+}
+
+/// Candidates from the index have matched every term of the query; they are
+/// only re-checked to drop events which no longer have a body (i.e. redacted).
+bool
+ircd::m::search::handle_indexed(result &result,
+                                const query &query)
+try
+{
+	if(result.skipped < query.batch)
+	{
+		++result.skipped;
+		return true;
+	}
+
+	const bool match
+	{
+		m::query(std::nothrow, result.event_idx, "content", []
+		(const json::object &content)
+		{
+			return !empty(json::string(content["body"]));
+		})
+	};
+
+	const bool handled
+	{
+		match && handle_result(result, query)
+	};
+
+	result.checked += 1;
+	result.matched += match;
+	result.count += handled;
+	return result.count < query.limit;
+}
+catch(const ctx::interrupted &e)
+{
+	throw;
+}
+catch(const std::system_error &e)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		log, "Indexed query handling for '%s' by '%s' event_idx:%lu :%s",
+		query.search_term,
+		string_view{query.user_id},
+		result.event_idx,
+		e.what(),
+	};
+
+	return true;
+}
+
 bool
 ircd::m::search::handle_content(result &result,
                                 const query &query,
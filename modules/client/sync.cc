@@ -13,7 +13,7 @@ namespace ircd::m::sync
 {
 	struct response;
 
-	static const_buffer flush(data &, resource::response::chunked &, const const_buffer &);
+	static const_buffer flush(data &, resource::response::chunked &, std::string *const &, const const_buffer &);
 	static bool empty_response(data &, const uint64_t &next_batch);
 	static bool linear_handle(data &);
 	static bool polylog_handle(data &);
@@ -37,15 +37,45 @@ namespace ircd::m::sync
 
 namespace ircd::m::sync::longpoll
 {
+	static bool park(client &, data &);
 	static void fini() noexcept;
+
+	extern conf::item<bool> targeted;
+	extern conf::item<bool> park_enable;
+}
+
+namespace ircd::m::sync::snapshot
+{
+	static string_view make_key(const mutable_buffer &, const data &);
+	static bool serve(data &, resource::response::chunked &);
+	static void save(data &, const string_view &);
+	static void drop(const user::id &, const string_view &device_id);
+	static void handle_keys(const m::event &, m::vm::eval &);
+	static void init();
+	static void fini() noexcept;
+
+	extern m::hookfn<m::vm::eval &> keys_changed;
+	extern conf::item<bool> enable;
+	extern conf::item<size_t> delta_max;
+	extern conf::item<size_t> size_max;
+	extern conf::item<std::string> comp;
+	extern conf::item<size_t> cache_size;
+	extern const db::descriptor descriptor;
+	extern const db::description description;
+	extern std::shared_ptr<db::database> database;
+	extern db::column column;
 }
 
 ircd::mapi::header
 IRCD_MODULE
 {
-	"Client 6.2.1 :Sync", nullptr, []
+	"Client 6.2.1 :Sync", []
+	{
+		ircd::m::sync::snapshot::init();
+	}, []
 	{
 		ircd::m::sync::longpoll::fini();
+		ircd::m::sync::snapshot::fini();
 	}
 };
 
@@ -281,6 +311,39 @@ ircd::m::sync::handle_get(client &client,
 		)
 	};
 
+	// Conditions for parking this request without a stack until something
+	// arrives for it: a longpoll (see below) with nothing else to do first.
+	const bool should_park
+	{
+		longpoll::park_enable
+		&& longpoll::targeted
+		&& longpoll_enable
+		&& !data.phased
+		&& !initial_sync
+		&& !paused
+		&& !invalid_since
+		&& range.first > vm::sequence::retired
+		&& !args.full_state
+		&& !args.semaphore
+		&& args.next_batch == -1UL
+	};
+
+	if(should_park && longpoll::park(client, data))
+		return {};
+
+	// Conditions for serving this request from, or capturing it into, the
+	// initial-sync snapshot of this user, device and filter.
+	const bool should_snapshot
+	{
+		snapshot::enable
+		&& snapshot::database
+		&& initial_sync
+		&& !data.phased
+		&& !paused
+		&& !args.semaphore
+		&& args.next_batch == -1UL
+	};
+
 	static const http::header response_headers[]
 	{
 		{ "Cache-Control", "no-cache" },
@@ -298,14 +361,20 @@ ircd::m::sync::handle_get(client &client,
 	// response. Each flush will create and send a chunk containing in-progress
 	// JSON. This will yield the ircd::ctx as this chunk is copied to the
 	// kernel's TCP buffer, providing flow control for the sync composition.
+	std::string capture;
 	json::stack out
 	{
 		response.buf,
-		std::bind(sync::flush, std::ref(data), std::ref(response), ph::_1),
+		std::bind(sync::flush, std::ref(data), std::ref(response), should_snapshot? &capture: nullptr, ph::_1),
 		size_t(flush_hiwat)
 	};
 	data.out = &out;
 
+	// A stored snapshot is streamed verbatim; the client continues with an
+	// incremental sync from its next_batch.
+	if(should_snapshot && snapshot::serve(data, response))
+		return std::move(response);
+
 	log::debug
 	{
 		log, "request %s", loghead(data)
@@ -388,6 +457,11 @@ ircd::m::sync::handle_get(client &client,
 	if(!complete && should_polylog)
 		complete = polylog_handle(data);
 
+	// The response is complete only after the residue is flushed; anything
+	// short of a full polylog response is not captured.
+	if(complete && should_snapshot && should_polylog && out.flush(true) && out.flushed == out.appended)
+		snapshot::save(data, capture);
+
 	if(!complete && should_linear)
 		complete = linear_handle(data);
 
@@ -471,6 +545,7 @@ ircd::m::sync::empty_response(data &data,
 ircd::const_buffer
 ircd::m::sync::flush(data &data,
                      resource::response::chunked &response,
+                     std::string *const &capture,
                      const const_buffer &buffer)
 {
 	assert(size(buffer) <= size(response.buf));
@@ -479,6 +554,18 @@ ircd::m::sync::flush(data &data,
 		response.flush(buffer)
 	};
 
+	// The capture is abandoned once it exceeds the snapshot limit; it is
+	// then left holding a single null which is never a valid response.
+	const bool capturing
+	{
+		capture && (capture->empty() || capture->front() != '\0')
+	};
+
+	if(capturing && capture->size() + size(wrote) <= size_t(snapshot::size_max))
+		capture->append(ircd::data(wrote), size(wrote));
+	else if(capturing)
+		capture->assign(1, '\0');
+
 	assert(size(wrote) <= size(buffer));
 	if(data.stats)
 	{
@@ -489,6 +576,393 @@ ircd::m::sync::flush(data &data,
 	return wrote;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// snapshot
+//
+
+// Initial syncs are the most expensive requests served and are repeated for
+// the same user whenever clients reinstall, clear their cache or reconnect
+// in bulk. A complete non-phased initial sync response is captured as it is
+// flushed and stored, keyed by user, device and filter, along with its
+// next_batch. A later initial sync for the same key is served by streaming
+// the stored response rather than composing one. The response remains
+// correct as events arrive, since it is a consistent view as of its
+// next_batch and the client continues from there with an incremental sync;
+// a snapshot lagging the present by more than delta_max is not served and
+// is replaced by the next initial sync instead. The device is part of the
+// key because the response includes to-device messages and key counts; the
+// snapshots of a device are dropped when its one-time keys change, since an
+// incremental sync won't correct the counts until they change again.
+
+decltype(ircd::m::sync::snapshot::enable)
+ircd::m::sync::snapshot::enable
+{
+	{ "name",     "ircd.client.sync.snapshot.enable" },
+	{ "default",  false                              },
+};
+
+decltype(ircd::m::sync::snapshot::delta_max)
+ircd::m::sync::snapshot::delta_max
+{
+	{ "name",     "ircd.client.sync.snapshot.delta.max" },
+	{ "default",  16384L                                },
+	{ "description",
+
+	R"(
+	Maximum number of events by which a stored initial sync may lag the
+	present and still be served. The client must catch up on these with its
+	next sync; beyond this the response is composed and stored again.
+	)"}
+};
+
+decltype(ircd::m::sync::snapshot::size_max)
+ircd::m::sync::snapshot::size_max
+{
+	{ "name",     "ircd.client.sync.snapshot.size.max" },
+	{ "default",  long(64_MiB)                         },
+	{ "description",
+
+	R"(
+	Initial sync responses larger than this are not stored.
+	)"}
+};
+
+decltype(ircd::m::sync::snapshot::comp)
+ircd::m::sync::snapshot::comp
+{
+	{ "name",     "ircd.client.sync.snapshot.comp" },
+	{ "default",  "default"                        },
+};
+
+decltype(ircd::m::sync::snapshot::cache_size)
+ircd::m::sync::snapshot::cache_size
+{
+	{
+		{ "name",     "ircd.client.sync.snapshot.cache.size" },
+		{ "default",  long(0_MiB)                            },
+	}, []
+	{
+		if(!column)
+			return;
+
+		const size_t &value{cache_size};
+		db::capacity(db::cache(column), value);
+	}
+};
+
+decltype(ircd::m::sync::snapshot::descriptor)
+ircd::m::sync::snapshot::descriptor
+{
+	// name
+	"snapshot",
+
+	// explain
+	R"(
+	Stored initial sync responses.
+
+	[user_id | device_id, filter hash] => next_batch, response
+
+	The value is the next_batch of the response as a native integer followed
+	by the JSON response body exactly as it was sent.
+	)",
+
+	// typing
+	{
+		typeid(string_view), typeid(string_view)
+	},
+
+	{},      // options
+	{},      // comparator
+	{},      // prefix transform
+	false,   // drop column
+
+	// cache size
+	-1,
+
+	// cache size for compressed assets
+	0,
+
+	// bloom_bits
+	10,
+
+	// expect hit
+	false,
+
+	// block_size
+	64_KiB,
+
+	// meta block size
+	512,
+
+	// compression
+	string_view{comp},
+};
+
+decltype(ircd::m::sync::snapshot::description)
+ircd::m::sync::snapshot::description
+{
+	{ "default" }, // requirement of RocksDB
+
+	descriptor,
+};
+
+decltype(ircd::m::sync::snapshot::database)
+ircd::m::sync::snapshot::database;
+
+decltype(ircd::m::sync::snapshot::column)
+ircd::m::sync::snapshot::column;
+
+void
+ircd::m::sync::snapshot::init()
+{
+	static const std::string dbopts;
+	database = std::make_shared<db::database>("sync", dbopts, description);
+	column = db::column{*database, "snapshot"};
+
+	// The conf setter callbacks must be manually executed after
+	// the database was just loaded to set the cache size.
+	conf::reset("ircd.client.sync.snapshot.cache.size");
+}
+
+void
+ircd::m::sync::snapshot::fini()
+noexcept
+{
+	// see: media::fini()
+	column = {};
+	database = std::shared_ptr<db::database>{};
+}
+
+bool
+ircd::m::sync::snapshot::serve(data &data,
+                               resource::response::chunked &response)
+try
+{
+	char keybuf[id::MAX_SIZE * 2 + 16];
+	const string_view &key
+	{
+		make_key(keybuf, data)
+	};
+
+	bool found;
+	const std::string value
+	{
+		db::read(column, key, found)
+	};
+
+	if(!found || size(value) <= sizeof(event::idx))
+		return false;
+
+	const event::idx next_batch
+	{
+		byte_view<event::idx>(string_view(value).substr(0, sizeof(event::idx)))
+	};
+
+	if(next_batch > data.range.second)
+		return false;
+
+	if(data.range.second - next_batch > size_t(delta_max))
+		return false;
+
+	const_buffer body
+	{
+		ircd::data(value) + sizeof(event::idx), size(value) - sizeof(event::idx)
+	};
+
+	while(!empty(body))
+	{
+		const const_buffer chunk
+		{
+			ircd::data(body), std::min(size(body), size(response.buf))
+		};
+
+		consume(body, size(response.flush(chunk)));
+	}
+
+	if(data.stats)
+		data.stats->flush_bytes += size(value) - sizeof(event::idx);
+
+	log::logf
+	{
+		log, stats::info? log::level::INFO: log::level::DEBUG,
+		"request %s snapshot served %zu bytes @%lu lag:%lu",
+		loghead(data),
+		size(value) - sizeof(event::idx),
+		next_batch,
+		data.range.second - next_batch,
+	};
+
+	return true;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::system_error &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::derror
+	{
+		log, "request %s snapshot :%s",
+		loghead(data),
+		e.what(),
+	};
+
+	return false;
+}
+
+void
+ircd::m::sync::snapshot::save(data &data,
+                              const string_view &body)
+try
+{
+	if(empty(body) || body.front() != '{')
+		return;
+
+	char keybuf[id::MAX_SIZE * 2 + 16];
+	const string_view &key
+	{
+		make_key(keybuf, data)
+	};
+
+	const event::idx next_batch
+	{
+		data.range.second
+	};
+
+	std::string value;
+	value.reserve(sizeof(next_batch) + size(body));
+	value.append(byte_view<string_view>(next_batch));
+	value.append(body);
+	db::write(column, key, const_buffer{value});
+
+	log::debug
+	{
+		log, "request %s snapshot saved %zu bytes @%lu",
+		loghead(data),
+		size(body),
+		next_batch,
+	};
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::derror
+	{
+		log, "request %s snapshot save :%s",
+		loghead(data),
+		e.what(),
+	};
+}
+
+decltype(ircd::m::sync::snapshot::keys_changed)
+ircd::m::sync::snapshot::keys_changed
+{
+	handle_keys,
+	{
+		{ "_site",  "vm.effect" },
+	}
+};
+
+void
+ircd::m::sync::snapshot::handle_keys(const m::event &event,
+                                     m::vm::eval &eval)
+try
+{
+	if(!column)
+		return;
+
+	if(!startswith(json::get<"type"_>(event), "ircd.device.one_time_key"))
+		return;
+
+	const m::user::id &user_id
+	{
+		json::get<"sender"_>(event)
+	};
+
+	if(!my(user_id))
+		return;
+
+	const m::user::room user_room
+	{
+		user_id
+	};
+
+	if(json::get<"room_id"_>(event) != user_room.room_id)
+		return;
+
+	drop(user_id, json::get<"state_key"_>(event));
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::derror
+	{
+		log, "snapshot drop for %s :%s",
+		string_view{event.event_id},
+		e.what(),
+	};
+}
+
+/// Deletes the snapshots of the device under every filter.
+void
+ircd::m::sync::snapshot::drop(const user::id &user_id,
+                              const string_view &device_id)
+{
+	char buf[2][id::MAX_SIZE * 2 + 16];
+	mutable_buffer out[2] {buf[0], buf[1]};
+	for(size_t i(0); i < 2; ++i)
+	{
+		consume(out[i], copy(out[i], user_id));
+		consume(out[i], copy(out[i], '\0'));
+		consume(out[i], copy(out[i], trunc(device_id, id::MAX_SIZE)));
+		consume(out[i], copy(out[i], i? '\1': '\0'));
+	}
+
+	const std::pair<string_view, string_view> range
+	{
+		{ buf[0], ircd::data(out[0]) },
+		{ buf[1], ircd::data(out[1]) },
+	};
+
+	db::del(column, range);
+	log::debug
+	{
+		log, "snapshots of %s %s dropped on key change",
+		string_view{user_id},
+		device_id,
+	};
+}
+
+ircd::string_view
+ircd::m::sync::snapshot::make_key(const mutable_buffer &out_,
+                                  const data &data)
+{
+	assert(data.args);
+	const uint64_t filter_hash
+	{
+		hash(data.args->filter_id)
+	};
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, data.user.user_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, trunc(data.device_id, id::MAX_SIZE)));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, byte_view<string_view>(filter_hash)));
+	return { ircd::data(out_), ircd::data(out) };
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // longpoll
@@ -498,21 +972,105 @@ namespace ircd::m::sync
 {
 	// fwd decl as longpoll is a frontend to a linear-sync.
 	static size_t linear_proffer_event(data &, const mutable_buffer &);
+	static std::pair<event::idx, bool> linear_proffer(data &, window_buffer &);
 }
 
 namespace ircd::m::sync::longpoll
 {
+	struct waiter;
+	struct parked;
+
 	static bool polled(data &, const args &);
-	static int poll(data &);
+	static void skip(m::event::idx &, waiter &, const m::event::idx &limit);
+	static int poll(data &, waiter &);
+	static void route(const m::event &, const m::event::idx &);
 	static void handle_notify(const m::event &, m::vm::eval &);
-	static void fini() noexcept;
+	static bool resume(client &, const std::shared_ptr<parked> &);
+	static void unpark(parked &);
+	static void park_worker();
 
+	extern conf::item<bool> targeted;
 	extern m::hookfn<m::vm::eval &> notified;
-	extern ctx::dock dock;
+	extern std::set<waiter *> waiters;
+	extern std::multimap<string_view, waiter *> rooms;
+	extern std::multimap<string_view, waiter *> users;
+	extern std::array<std::pair<m::event::idx, uint64_t>, 64_KiB> routed;
+	extern uint64_t routed_seq;
+	extern std::multimap<system_point, std::shared_ptr<parked>> parks;
+	extern std::unique_ptr<context> park_timer;
+	extern ctx::dock park_dock;
+	extern size_t resuming;
 }
 
-decltype(ircd::m::sync::longpoll::dock)
-ircd::m::sync::longpoll::dock;
+/// A longpolling request registered under the rooms and the user it is
+/// interested in. The notify hook only wakes the waiters registered under the
+/// keys of an event. Events routed while a waiter is registered but which did
+/// not wake it are passed over without being fetched.
+struct ircd::m::sync::longpoll::waiter
+{
+	std::vector<std::string> room_ids;
+	std::vector<decltype(rooms)::iterator> room_its;
+	decltype(users)::iterator user_it;
+	std::set<m::event::idx> hits;
+	uint64_t seq {routed_seq};
+	ctx::dock dock;
+	parked *park {nullptr};
+
+	void notify();
+
+	waiter(const data &);
+	waiter(waiter &&) = delete;
+	waiter(const waiter &) = delete;
+	~waiter() noexcept;
+};
+
+/// A longpolling request which released its context (see client::park()).
+/// The query strings viewed by the args remain in the client's head buffer
+/// until it is resumed. range.first is the cursor of events evaluated.
+struct ircd::m::sync::longpoll::parked
+{
+	std::shared_ptr<ircd::client> client;
+	m::user::id::buf user_id;
+	m::device::id::buf device_id;
+	sync::args args;
+	m::events::range range;
+	std::unique_ptr<struct waiter> waiter;
+	decltype(parks)::iterator it;
+	bool woken {false};
+
+	parked(ircd::client &, const data &);
+	parked(parked &&) = delete;
+	parked(const parked &) = delete;
+};
+
+decltype(ircd::m::sync::longpoll::targeted)
+ircd::m::sync::longpoll::targeted
+{
+	{ "name",     "ircd.client.sync.longpoll.targeted" },
+	{ "default",  true                                 },
+	{ "description",
+
+	R"(
+	Wake only the longpolling clients an event might concern, by room and by
+	user. When disabled every longpolling client is woken for every event
+	and evaluates it.
+	)"}
+};
+
+decltype(ircd::m::sync::longpoll::park_enable)
+ircd::m::sync::longpoll::park_enable
+{
+	{ "name",     "ircd.client.sync.longpoll.park" },
+	{ "default",  false                            },
+	{ "description",
+
+	R"(
+	Release the request context of a longpoll which has nothing to wait on
+	but new events. The request is held without a stack until an event which
+	might concern it arrives or it times out, and then continues on a context
+	from the client pool. Requires ircd.client.sync.longpoll.targeted.
+	)"}
+};
 
 decltype(ircd::m::sync::longpoll::notified)
 ircd::m::sync::longpoll::notified
@@ -523,18 +1081,66 @@ ircd::m::sync::longpoll::notified
 	}
 };
 
+decltype(ircd::m::sync::longpoll::waiters)
+ircd::m::sync::longpoll::waiters;
+
+decltype(ircd::m::sync::longpoll::rooms)
+ircd::m::sync::longpoll::rooms;
+
+decltype(ircd::m::sync::longpoll::users)
+ircd::m::sync::longpoll::users;
+
+decltype(ircd::m::sync::longpoll::routed)
+ircd::m::sync::longpoll::routed;
+
+decltype(ircd::m::sync::longpoll::routed_seq)
+ircd::m::sync::longpoll::routed_seq;
+
+decltype(ircd::m::sync::longpoll::parks)
+ircd::m::sync::longpoll::parks;
+
+decltype(ircd::m::sync::longpoll::park_timer)
+ircd::m::sync::longpoll::park_timer;
+
+decltype(ircd::m::sync::longpoll::park_dock)
+ircd::m::sync::longpoll::park_dock;
+
+decltype(ircd::m::sync::longpoll::resuming)
+ircd::m::sync::longpoll::resuming;
+
 void
 ircd::m::sync::longpoll::fini()
 noexcept
 {
-	if(!dock.empty())
+	if(!waiters.empty())
 		log::warning
 		{
-			log, "Interrupting %zu longpolling clients...",
-			dock.size(),
+			log, "Interrupting %zu longpolling clients (%zu parked)...",
+			waiters.size(),
+			parks.size(),
 		};
 
-	interrupt(dock);
+	if(park_timer)
+	{
+		park_timer->terminate();
+		park_timer.reset();
+	}
+
+	// Parked clients are disconnected rather than resumed; resumptions
+	// already queued are waited for since they run this module's code.
+	for(const auto &[timesout, parked] : parks)
+		parked->client->close(net::dc::SSL_NOTIFY, net::close_ignore);
+
+	parks.clear();
+	for(auto *const &waiter : waiters)
+		if(!waiter->park)
+			interrupt(waiter->dock);
+
+	const ctx::uninterruptible::nothrow ui;
+	park_dock.wait([]
+	{
+		return !resuming;
+	});
 }
 
 void
@@ -546,7 +1152,22 @@ try
 	if(!eval.opts->notify_clients)
 		return;
 
-	dock.notify_all();
+	const auto &event_idx
+	{
+		vm::sequence::get(eval)
+	};
+
+	// Events without an index can't be passed over; every waiter evaluates
+	// them as it would without the registry.
+	if(!targeted || !event_idx)
+	{
+		for(auto *const &waiter : waiters)
+			waiter->notify();
+
+		return;
+	}
+
+	route(event, event_idx);
 }
 catch(const ctx::interrupted &)
 {
@@ -562,14 +1183,171 @@ catch(const std::exception &e)
 	};
 }
 
+/// Wake the waiters registered under the keys of the event and record that
+/// the event was routed; every other waiter will pass over it. The keys are
+/// a superset of what the linear handlers accept: the room of the event,
+/// which includes a user's own room (to-device, account data, typing); the
+/// room a read receipt is for; the target of a membership; and for presence
+/// and device list updates, every room joined by the user they describe.
+void
+ircd::m::sync::longpoll::route(const m::event &event,
+                               const m::event::idx &event_idx)
+{
+	const auto wake{[&event_idx]
+	(auto &map, const string_view &key)
+	{
+		auto pit(map.equal_range(key));
+		for(; pit.first != pit.second; ++pit.first)
+		{
+			auto &waiter(*pit.first->second);
+			waiter.hits.emplace(event_idx);
+			waiter.notify();
+		}
+	}};
+
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	const auto &state_key
+	{
+		json::get<"state_key"_>(event)
+	};
+
+	const string_view &subject
+	{
+		type == "ircd.presence"?
+			string_view{json::string(json::get<"content"_>(event).get("user_id"))}:
+
+		startswith(type, "ircd.device")?
+			string_view{json::get<"sender"_>(event)}:
+
+		string_view{}
+	};
+
+	if(subject && valid(m::id::USER, subject))
+	{
+		const m::user::rooms user_rooms
+		{
+			m::user::id(subject)
+		};
+
+		user_rooms.for_each("join", [&wake]
+		(const m::room &room, const string_view &)
+		{
+			wake(rooms, room.room_id);
+		});
+
+		wake(users, subject);
+	}
+
+	wake(rooms, json::get<"room_id"_>(event));
+
+	if(type == "ircd.read" && valid(m::id::ROOM, state_key))
+		wake(rooms, state_key);
+
+	if(type == "m.room.member" && valid(m::id::USER, state_key))
+		wake(users, state_key);
+
+	routed.at(event_idx % routed.size()) =
+	{
+		event_idx, ++routed_seq
+	};
+}
+
+//
+// waiter
+//
+
+ircd::m::sync::longpoll::waiter::waiter(const data &data)
+{
+	static const string_view memberships[]
+	{
+		"join", "invite",
+	};
+
+	room_ids.emplace_back(data.user_room.room_id);
+	for(const auto &membership : memberships)
+		data.user_rooms.for_each(membership, [this]
+		(const m::room &room, const string_view &)
+		{
+			room_ids.emplace_back(room.room_id);
+		});
+
+	// Keys view the strings above, so indexing waits until they're in place.
+	room_its.reserve(room_ids.size());
+	for(const auto &room_id : room_ids)
+		room_its.emplace_back(rooms.emplace(room_id, this));
+
+	user_it = users.emplace(data.user.user_id, this);
+	waiters.emplace(this);
+}
+
+ircd::m::sync::longpoll::waiter::~waiter()
+noexcept
+{
+	waiters.erase(this);
+	users.erase(user_it);
+	for(const auto &it : room_its)
+		rooms.erase(it);
+}
+
+//
+// parked
+//
+
+ircd::m::sync::longpoll::parked::parked(ircd::client &client,
+                                        const data &data)
+:client
+{
+	shared_from(client)
+}
+,user_id
+{
+	data.user.user_id
+}
+,device_id
+{
+	data.device_id
+}
+,args
+{
+	*data.args
+}
+,range
+{
+	data.range
+}
+,waiter
+{
+	std::make_unique<struct waiter>(data)
+}
+{
+}
+
+void
+ircd::m::sync::longpoll::waiter::notify()
+{
+	if(park)
+		unpark(*park);
+	else
+		dock.notify();
+}
+
 /// Longpolling blocks the client's request until a relevant event is processed
 /// by the m::vm. If no event is processed by a timeout this returns false.
 bool
 ircd::m::sync::longpoll_handle(data &data)
 try
 {
+	longpoll::waiter waiter
+	{
+		data
+	};
+
 	int ret;
-	while((ret = longpoll::poll(data)) == -1)
+	while((ret = longpoll::poll(data, waiter)) == -1)
 	{
 		// When the client explicitly gives a next_batch token we have to
 		// adhere to it and return an empty response before going past their
@@ -609,10 +1387,38 @@ catch(const std::exception &e)
 	throw;
 }
 
-/// When the vm's sequence number is incremented our dock is notified and the
-/// event at that next sequence number is fetched. That event gets proffered
+/// Advance the cursor past retired events which were routed while the
+/// waiter was registered without waking it. Events not found in the routing
+/// ring (overwritten, not yet notified, or never notified) stop the advance
+/// so they're evaluated the regular way.
+void
+ircd::m::sync::longpoll::skip(m::event::idx &cursor,
+                              waiter &waiter,
+                              const m::event::idx &limit)
+{
+	while(cursor <= limit)
+	{
+		const auto &[routed_idx, routed_seq]
+		{
+			routed.at(cursor % routed.size())
+		};
+
+		if(routed_idx != cursor || routed_seq <= waiter.seq)
+			break;
+
+		if(waiter.hits.count(cursor))
+			break;
+
+		++cursor;
+	}
+
+	waiter.hits.erase(begin(waiter.hits), waiter.hits.lower_bound(cursor));
+}
+
+/// When an event which might concern us is processed our dock is notified and
+/// the event at that next sequence number is fetched. That event gets proffered
 /// around the linear sync handlers for whether it's relevant to the user
-/// making the request on this stack.
+/// making the request on this stack. Events routed elsewhere are skipped.
 ///
 /// If relevant, we respond immediately with that one event and finish the
 /// request right there, providing them the next since token of one-past the
@@ -632,16 +1438,22 @@ catch(const std::exception &e)
 /// has been sent to the client yet here either.
 ///
 int
-ircd::m::sync::longpoll::poll(data &data)
+ircd::m::sync::longpoll::poll(data &data,
+                              waiter &waiter)
 {
-	const auto ready{[&data]
+	const auto ready{[&data, &waiter]
 	{
+		assert(data.args);
+		skip(data.range.second, waiter, int64_t(data.args->next_batch) > 0?
+			std::min(data.args->next_batch, vm::sequence::retired):
+			vm::sequence::retired);
+
 		assert(data.range.second <= m::vm::sequence::retired + 1);
 		return data.range.second <= m::vm::sequence::retired;
 	}};
 
 	assert(data.args);
-	if(!dock.wait_until(data.args->timesout, ready))
+	if(!waiter.dock.wait_until(data.args->timesout, ready))
 		return false;
 
 	// Check if client went away while we were sleeping,
@@ -771,6 +1583,187 @@ ircd::m::sync::longpoll::polled(data &data,
 	return true;
 }
 
+//
+// park
+//
+
+/// Release this context for the remainder of an idle longpoll. Returns false
+/// if the client can't be parked. Nothing has been written to the client; the
+/// response is made by resume() on another context.
+bool
+ircd::m::sync::longpoll::park(client &client,
+                              data &data)
+{
+	auto parked
+	{
+		std::make_shared<struct parked>(client, data)
+	};
+
+	if(!client.park())
+		return false;
+
+	parked->it = parks.emplace(parked->args.timesout, parked);
+	parked->waiter->park = parked.get();
+
+	if(!park_timer)
+		park_timer = std::make_unique<context>
+		(
+			"m.sync.park", 256_KiB, &park_worker, context::POST
+		);
+
+	// The timer only needs to hear about a new earliest deadline.
+	if(parked->it == begin(parks))
+		park_dock.notify_all();
+
+	log::debug
+	{
+		log, "request %s parked until %ld (%zu parked)",
+		loghead(data),
+		duration_cast<milliseconds>(parked->args.timesout.time_since_epoch()).count(),
+		parks.size(),
+	};
+
+	return true;
+}
+
+/// Hand the parked request to the client pool; called when it is woken by
+/// an event or by its timeout.
+void
+ircd::m::sync::longpoll::unpark(parked &parked_)
+{
+	if(parked_.woken)
+		return;
+
+	parked_.woken = true;
+	std::shared_ptr<parked> parked
+	{
+		std::move(parks.extract(parked_.it).mapped())
+	};
+
+	++resuming;
+	auto client(parked->client);
+	client::resume(std::move(client), [parked(std::move(parked))]
+	(ircd::client &client)
+	{
+		const unwind done{[]
+		{
+			--resuming;
+			park_dock.notify_all();
+		}};
+
+		return resume(client, parked);
+	});
+}
+
+/// Continue a parked request on a context from the client pool. The events
+/// since it was parked are evaluated the same way a longpoll does; when none
+/// are relevant and time remains the request is parked again.
+bool
+ircd::m::sync::longpoll::resume(client &client,
+                                const std::shared_ptr<parked> &parked)
+{
+	assert(parked->woken);
+	assert(client.sock);
+	net::check(*client.sock);
+
+	sync::stats stats;
+	sync::data data
+	{
+		parked->user_id,
+		parked->range,
+		&client,
+		nullptr,
+		&stats,
+		&parked->args,
+		parked->device_id,
+	};
+
+	const unique_buffer<mutable_buffer> buf
+	{
+		std::max(size_t(linear_buffer_size), size_t(128_KiB))
+	};
+
+	// Only probes for a hit; the response itself is composed by the regular
+	// linear handler below.
+	event::idx last {0};
+	while(!last)
+	{
+		skip(data.range.first, *parked->waiter, vm::sequence::retired);
+		data.range.second = vm::sequence::retired + 1;
+		if(data.range.first >= data.range.second)
+			break;
+
+		window_buffer wb{buf};
+		last = linear_proffer(data, wb).first;
+		if(!last)
+			data.range.first = data.range.second;
+	}
+
+	const bool timedout
+	{
+		ircd::now<system_point>() >= parked->args.timesout
+	};
+
+	if(!last && !timedout && client.park())
+	{
+		parked->range.first = data.range.first;
+		parked->woken = false;
+		parked->it = parks.emplace(parked->args.timesout, parked);
+		if(parked->it == begin(parks))
+			park_dock.notify_all();
+
+		return true;
+	}
+
+	static const http::header response_headers[]
+	{
+		{ "Cache-Control", "no-cache" },
+	};
+
+	resource::response::chunked response
+	{
+		client, http::OK, response_headers, buffer_size
+	};
+
+	json::stack out
+	{
+		response.buf,
+		std::bind(sync::flush, std::ref(data), std::ref(response), nullptr, ph::_1),
+		size_t(flush_hiwat)
+	};
+
+	data.out = &out;
+	if(!last || !linear_handle(data))
+		empty_response(data, data.range.second);
+
+	return true;
+}
+
+/// Resumes parked requests as they time out.
+void
+ircd::m::sync::longpoll::park_worker()
+{
+	while(1)
+	{
+		park_dock.wait([]
+		{
+			return !parks.empty();
+		});
+
+		// Notified on a new earliest deadline; wait again for that one.
+		if(park_dock.wait_until(begin(parks)->first))
+			continue;
+
+		const auto now
+		{
+			ircd::now<system_point>()
+		};
+
+		while(!parks.empty() && begin(parks)->first <= now)
+			unpark(*begin(parks)->second);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // linear
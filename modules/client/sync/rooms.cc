@@ -10,6 +10,8 @@
 
 namespace ircd::m::sync
 {
+	struct touched;
+
 	static bool should_ignore(const data &);
 
 	static bool _rooms_polylog_room(data &, const m::room &);
@@ -22,6 +24,23 @@ namespace ircd::m::sync
 	extern item rooms;
 }
 
+/// Cursor over the user's rows of the user_touch index. Rooms are tested in
+/// the order user::rooms presents them, which is also the order of the
+/// index, so the cursor usually just steps forward and the test of every room
+/// in a membership pass amounts to one ordered scan of the user's rows. A room
+/// out of that order costs a seek.
+struct ircd::m::sync::touched
+{
+	const sync::data &data;
+	char buf[dbs::USER_TOUCH_KEY_MAX_SIZE];
+	db::domain::const_iterator it;
+
+  public:
+	bool operator()(const m::room::id &);
+
+	touched(const sync::data &);
+};
+
 ircd::mapi::header
 IRCD_MODULE
 {
@@ -174,8 +193,13 @@ ircd::m::sync::_rooms_polylog(data &data,
 		*data.out, membership
 	};
 
+	// Incremental polylog only; initial and phased syncs visit every room.
+	std::optional<sync::touched> touched;
+	if(dbs::user_touch_enable && !data.phased && int64_t(data.range.first) > 0L)
+		touched.emplace(data);
+
 	bool ret{false};
-	const user::rooms::closure_bool closure{[&data, &ret, &phase]
+	const user::rooms::closure_bool closure{[&data, &ret, &phase, &touched]
 	(const m::room &room, const string_view &membership_)
 	{
 		if(data.phased)
@@ -190,6 +214,9 @@ ircd::m::sync::_rooms_polylog(data &data,
 				return true;
 		}
 
+		if(touched && !(*touched)(room.room_id))
+			return true;
+
 		#if defined(RB_DEBUG)
 		sync::stats stats
 		{
@@ -332,3 +359,43 @@ ircd::m::sync::should_ignore(const data &data)
 
 	return ret;
 }
+
+//
+// touched
+//
+
+ircd::m::sync::touched::touched(const sync::data &data)
+:data{data}
+,it
+{
+	dbs::user_touch.begin(dbs::user_touch_key(buf, data.user))
+}
+{
+}
+
+bool
+ircd::m::sync::touched::operator()(const m::room::id &room_id)
+{
+	const string_view &key
+	{
+		dbs::user_touch_key(buf, data.user, room_id)
+	};
+
+	// The iterator presents the domain-stripped key; the room is decoded
+	// from it. Seek only when the cursor isn't already on the room.
+	if(!it || dbs::user_touch_key(it->first) != room_id)
+		db::seek(it, key);
+
+	if(!it || dbs::user_touch_key(it->first) != room_id)
+		return false;
+
+	const event::idx event_idx
+	{
+		byte_view<event::idx>(it->second)
+	};
+
+	// Rooms are usually tested in the order of the index, so the next room
+	// is likely the next row.
+	++it;
+	return event_idx >= data.range.first;
+}
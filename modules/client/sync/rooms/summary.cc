@@ -155,22 +155,17 @@ ircd::m::sync::room_summary_append_counts(data &data)
 		}
 	};
 
-	// TODO: XXX
-	// Invited member count is omitted for now. We don't yet enjoy an
-	// optimized query for the invited member count like we do with the
-	// joined member count.
-	const long invited_members_count
-	{
-		0UL
-	};
-
-//	json::stack::member
-//	{
-//		*data.out, "m.invited_member_count", json::value
-//		{
-//			long(members.count("invite"))
-//		}
-//	};
+	// Invited member count is only given when the room's counters can answer
+	// it; otherwise it would be a scan of the member states of the room.
+	size_t invited_members_count {0};
+	if(room::stats::members(invited_members_count, *data.room, "invite"))
+		json::stack::member
+		{
+			*data.out, "m.invited_member_count", json::value
+			{
+				long(invited_members_count)
+			}
+		};
 
 	return joined_members_count || invited_members_count;
 }
@@ -6846,6 +6846,191 @@ console_cmd__me(opt &out, const string_view &line)
 	return true;
 }
 
+//
+// json
+//
+
+bool
+console_cmd__json__check(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"verbose"
+	}};
+
+	const bool verbose
+	{
+		param["verbose"] == "verbose"
+	};
+
+	std::vector<std::string> corpus
+	{
+		// literals
+		"true", "false", "null", "tru", "nul", "nulll", "True",
+
+		// numbers
+		"0", "-0", "01", "-01", "1.", ".5", "-", "+1", "1.5", "-1.5e10",
+		"1e", "1e+", "1E+2", "1e-2", "1.0e-5", "0e0", "1ee2", "1.2.3", "--1",
+		"12345678901234567890123456789", "1_000", "0x10", "Infinity", "NaN",
+
+		// strings and escapes
+		"\"\"", "\"a\"", "\"\\\"\"", "\"\\\\\"", "\"\\/\"", "\"\\b\\f\\n\\r\\t\"",
+		"\"\\u00e9\"", "\"\\u00E9\"", "\"\\u12\"", "\"\\u12g4\"", "\"\\x41\"",
+		"\"\\a\"", "\"\\\"", "\"abc", "abc\"", "\"\\ud83d\\ude00\"",
+		std::string{"\"a\tb\""}, std::string{"\"a\nb\""}, std::string{"\"\x01\""},
+		std::string{"\"\x7f\""}, "\"\xc3\xa9\"",
+
+		// whitespace
+		" 1", "1 ", "1\n", "1\r\n", "\t1", "[ 1 , 2 ]", "[\n1,\t2\r]", "{ \"a\" : 1 }",
+		"[1\v]", "[1\f]", std::string{"[1\0]", 4}, "", " ", "\n",
+
+		// containers
+		"[]", "{}", "[ ]", "{ }", "[,]", "[1,]", "[,1]", "{\"a\":}", "{\"a\"}", "{\"a\" 1}",
+		"{1:1}", "{\"a\":1,}", "[1 2]", "[1],", "[1]]", "[[1]", "{\"a\":1}}", "[}", "{]",
+		"{\"a\":[{\"b\":null}],\"c\":{\"d\":[true,false,\"e\"]}}",
+	};
+
+	// nesting about the depth limit of the scanner
+	for(const size_t &depth : {63UL, 64UL, 65UL, 128UL, 1024UL})
+	{
+		corpus.emplace_back(std::string(depth, '[') + std::string(depth, ']'));
+		corpus.emplace_back(std::string(depth, '[') + std::string(depth - 1, ']'));
+		std::string objs;
+		for(size_t i(0); i < depth; ++i)
+			objs += "{\"a\":";
+
+		objs += "1";
+		objs += std::string(depth, '}');
+		corpus.emplace_back(std::move(objs));
+	}
+
+	// every case again within an array, offset across a 64 byte boundary
+	const size_t base_count(corpus.size());
+	for(size_t i(0); i < base_count; ++i)
+		for(const size_t &pad : {0UL, 31UL, 60UL, 62UL, 63UL, 64UL})
+			corpus.emplace_back("[" + std::string(pad, ' ') + corpus.at(i) + "]");
+
+	size_t scanned(0), valid(0), mismatch(0);
+	for(const auto &s : corpus)
+	{
+		const bool expect
+		{
+			json::parse_valid(s)
+		};
+
+		const bool scan
+		{
+			json::scan(s)
+		};
+
+		const bool result
+		{
+			json::valid(s, std::nothrow)
+		};
+
+		// The scanner must never accept what the grammar rejects.
+		const bool bad
+		{
+			result != expect || (scan && !expect)
+		};
+
+		scanned += scan;
+		valid += expect;
+		mismatch += bad;
+		if(!bad && !verbose)
+			continue;
+
+		out
+		<< (bad? "MISMATCH ": "")
+		<< "scan:" << scan
+		<< " valid:" << result
+		<< " parse:" << expect
+		<< " :" << trunc(s, 80)
+		<< std::endl;
+	}
+
+	out
+	<< corpus.size() << " cases; "
+	<< valid << " valid; "
+	<< scanned << " accepted by scan; "
+	<< mismatch << " mismatches"
+	<< std::endl;
+
+	return true;
+}
+
+bool
+console_cmd__json__bench(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"count", "rounds"
+	}};
+
+	const size_t count
+	{
+		param.at<size_t>("count", 4096UL)
+	};
+
+	const size_t rounds
+	{
+		param.at<size_t>("rounds", 8UL)
+	};
+
+	m::event::fetch::opts fopts;
+	fopts.query_json_force = true;
+
+	// The most recent events are copied out of the database so the timings
+	// don't include any I/O.
+	std::vector<std::string> sources;
+	sources.reserve(count);
+	size_t bytes(0);
+	for(auto idx(m::vm::sequence::retired); idx && sources.size() < count; --idx)
+	{
+		const m::event::fetch event
+		{
+			std::nothrow, idx, fopts
+		};
+
+		if(!event.valid || !event.source)
+			continue;
+
+		sources.emplace_back(string_view{event.source});
+		bytes += sources.back().size();
+	}
+
+	const auto bench{[&out, &sources, &bytes, &rounds]
+	(const string_view &name, const auto &func)
+	{
+		size_t valid(0);
+		ircd::timer timer;
+		for(size_t i(0); i < rounds; ++i)
+			for(const auto &source : sources)
+				valid += func(source);
+
+		const auto elapsed
+		{
+			timer.at<nanoseconds>()
+		};
+
+		char pbuf[2][48];
+		out
+		<< std::left << std::setw(12) << name
+		<< " " << std::right << std::setw(8) << (valid / rounds) << " valid"
+		<< " " << std::right << std::setw(14) << pretty(pbuf[0], iec(bytes * rounds))
+		<< " in " << std::left << std::setw(12) << pretty(pbuf[1], elapsed, true)
+		<< " " << (elapsed.count()? double(bytes * rounds) / elapsed.count() * 1000.0 : 0.0)
+		<< " MB/s"
+		<< std::endl;
+	}};
+
+	out << sources.size() << " events; " << bytes << " bytes" << std::endl;
+	bench("scan", [](const string_view &s) { return json::scan(s); });
+	bench("parse", [](const string_view &s) { return json::parse_valid(s); });
+	bench("valid", [](const string_view &s) { return json::valid(s, std::nothrow); });
+	return true;
+}
+
 //
 // key
 //
@@ -7886,6 +8071,60 @@ console_cmd__events__rebuild(opt &out, const string_view &line)
 	return true;
 }
 
+//
+// search
+//
+
+bool
+console_cmd__search(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"room_id", "term"
+	}};
+
+	const string_view &room_id_arg
+	{
+		param["room_id"] != "*"?
+			param["room_id"]:
+			string_view{}
+	};
+
+	const auto room_id
+	{
+		room_id_arg?
+			m::room_id(room_id_arg):
+			m::room::id::buf{}
+	};
+
+	const string_view &term
+	{
+		tokens_after(line, ' ', 0)
+	};
+
+	size_t count(0);
+	m::search::for_each(term, room_id, [&out, &count]
+	(const m::room::id &room_id, const m::event::idx &event_idx, const long &rank)
+	{
+		out
+		<< std::setw(10) << std::right << event_idx
+		<< " " << std::setw(5) << std::right << rank
+		<< " " << room_id
+		<< std::endl;
+
+		return ++count < 256;
+	});
+
+	return true;
+}
+
+bool
+console_cmd__search__rebuild(opt &out, const string_view &line)
+{
+	m::search::rebuild();
+	return true;
+}
+
 //
 // event
 //
@@ -8315,6 +8554,8 @@ console_cmd__event__rewrite(opt &out, const string_view &line)
 	m::dbs::write_opts opts;
 	opts.op = db::op::SET;
 	opts.event_idx = event.event_idx;
+	opts.appendix.set(m::dbs::appendix::ROOM_COUNT, false);
+	opts.appendix.set(m::dbs::appendix::ROOM_STATS, false);
 
 	db::txn txn{*m::dbs::events};
 	m::dbs::write(txn, event, opts);
@@ -11887,6 +12128,18 @@ console_cmd__room__auth(opt &out, const string_view &line)
 	return true;
 }
 
+bool
+console_cmd__room__auth__rebuild(opt &out, const string_view &line)
+{
+	const size_t count
+	{
+		m::room::auth::chain::rebuild()
+	};
+
+	out << "Indexed " << count << " state events." << std::endl;
+	return true;
+}
+
 bool
 console_cmd__room__stats(opt &out, const string_view &line)
 {
@@ -11905,10 +12158,63 @@ console_cmd__room__stats(opt &out, const string_view &line)
 		m::room::stats::bytes_json(room_id)
 	};
 
+	out << "complete:      "
+	    << std::boolalpha << m::room::stats::complete(room_id)
+	    << std::endl;
+
+	out << "events:        "
+	    << m::room::stats::events(room_id)
+	    << std::endl;
+
 	out << "JSON bytes:    "
 	    << pretty(iec(bytes_json))
 	    << std::endl;
 
+	char buf[m::dbs::ROOM_STATS_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		m::dbs::room_stats_key(buf, room_id)
+	};
+
+	out << std::endl;
+	for(auto it(m::dbs::room_stats.begin(key)); it; ++it)
+	{
+		const auto &[name, host]
+		{
+			m::dbs::room_stats_key(it->first)
+		};
+
+		if(!name)
+			continue;
+
+		out << std::left << std::setw(24) << name
+		    << " " << std::setw(40) << host
+		    << " " << std::right << int64_t(byte_view<int64_t>(it->second))
+		    << std::endl;
+	}
+
+	return true;
+}
+
+bool
+console_cmd__room__stats__rebuild(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"room_id",
+	}};
+
+	const auto &room_id
+	{
+		m::room_id(param.at("room_id"))
+	};
+
+	m::room::stats::rebuild
+	{
+		room_id
+	};
+
+	out << "done" << std::endl;
 	return true;
 }
 
@@ -12585,6 +12891,55 @@ console_cmd__user__rooms__origins(opt &out, const string_view &line)
 	return true;
 }
 
+bool
+console_cmd__user__rooms__touched(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"user_id", "[since]"
+	}};
+
+	const m::user &user
+	{
+		param.at(0)
+	};
+
+	const m::event::idx &since
+	{
+		param.at<m::event::idx>(1, 0UL)
+	};
+
+	const m::user::rooms rooms
+	{
+		user
+	};
+
+	rooms.for_each_touched(since, [&out]
+	(const m::room::id &room_id, const m::event::idx &event_idx)
+	{
+		out
+		<< std::setw(10) << std::right << event_idx
+		<< " " << room_id
+		<< std::endl;
+
+		return true;
+	});
+
+	return true;
+}
+
+bool
+console_cmd__user__rooms__touched__rebuild(opt &out, const string_view &line)
+{
+	const size_t count
+	{
+		m::user::rooms::rebuild_touched()
+	};
+
+	out << "Indexed " << count << " rooms of local users." << std::endl;
+	return true;
+}
+
 bool
 console_cmd__user__read(opt &out, const string_view &line)
 {
@@ -14,6 +14,8 @@ struct unit;
 struct txndata;
 struct txn;
 struct node;
+struct notice;
+struct origins;
 
 struct unit
 :std::enable_shared_from_this<unit>
@@ -62,17 +64,42 @@ static_assert
 	sizeof(struct txn) == 32_KiB
 );
 
+/// PDUs are queued by their event_idx only; the event is read back from the
+/// database when the transaction is composed. The cursor is the event_idx of
+/// the last PDU acknowledged by the remote and is periodically saved to the
+/// cursors column so delivery resumes from it after a restart. When the queue is
+/// full the node enters catchup, where PDUs are no longer queued but found
+/// again by scanning forward from the cursor, keeping memory flat under an
+/// arbitrary backlog.
 struct node
 {
-	std::deque<std::shared_ptr<unit>> q;
+	std::deque<m::event::idx> pdus;
+	std::deque<std::shared_ptr<unit>> edus;
 	std::array<char, rfc3986::DOMAIN_BUFSIZE> rembuf;
 	string_view remote;
 	m::node::room room;
 	server::request::opts sopts;
 	txn *curtxn {nullptr};
-
+	m::event::idx cursor {0};      // last PDU acknowledged by remote
+	m::event::idx saved {0};       // cursor value last written to the column
+	m::event::idx head {0};        // greatest PDU given to this node
+	size_t inflight_pdus {0};
+	size_t inflight_edus {0};
+	size_t failures {0};
+	steady_point backoff;
+	bool loaded {false};
+	bool catchup {false};
+	bool busy {false};
+
+	bool pending() const;
+	void load(const m::event::idx &);
+	void save();
+	bool scan();
+	void success();
+	void failure();
 	bool flush();
 	void push(std::shared_ptr<unit>);
+	void push(const m::event::idx &);
 
 	node(const string_view &remote)
 	:remote{ircd::strlcpy{mutable_buffer{rembuf}, remote}}
@@ -80,10 +107,45 @@ struct node
 	{}
 };
 
+/// Notification from the vm. PDUs are carried by event_idx; only EDUs, which
+/// are not written to the database, carry their JSON.
+struct notice
+{
+	m::event::idx event_idx {0};
+	std::string edu;
+};
+
+/// Cache of the servers joined to a room. The set is an immutable sorted
+/// array; updates replace it so a fan-out can walk a snapshot across yields.
+/// Entries are kept in least-recently-used order and maintained from the
+/// membership events of cached rooms; missing rooms are read from the
+/// room_joined table once.
+struct origins
+{
+	using vector = std::vector<std::string>;
+	using ptr = std::shared_ptr<const vector>;
+
+	std::string room_id;
+	ptr set;
+
+	static std::list<origins> lru;
+	static std::map<string_view, std::list<origins>::iterator, std::less<>> map;
+	static uint64_t epoch;
+
+	static bool has(const vector &, const string_view &origin);
+	static void update(const m::room::id &, const string_view &origin);
+	static ptr get(const m::room::id &);
+};
+
 std::list<txn> txns;
 std::map<std::string, node, std::less<>> nodes;
 
 void remove_node(const node &);
+static node &get_node(const string_view &origin);
+static m::event::idx read_cursor(const string_view &key);
+static void write_cursor(const string_view &key, const m::event::idx &);
+static void save_cursors();
+static void retry_nodes();
 static void recv_timeout(txn &, node &);
 static void recv_timeouts();
 static bool recv_handle(txn &, node &);
@@ -91,45 +153,234 @@ static void recv();
 static void recv_worker();
 ctx::dock recv_action;
 
-static void send_from_user(const m::event &, const m::user::id &user_id);
-static void send_to_user(const m::event &, const m::user::id &user_id);
-static void send_to_room(const m::event &, const m::room::id &room_id);
-static void send(const m::event &);
+static void send_from_user(const m::event &, const m::event::idx &, const m::user::id &user_id);
+static void send_to_user(const m::event &, const m::event::idx &, const m::user::id &user_id);
+static void send_to_room(const m::event &, const m::event::idx &, const m::room::id &room_id);
+static void send(const m::event &, const m::event::idx &);
+static void replay();
 static void send_worker();
 
 static void handle_notify(const m::event &, m::vm::eval &);
+static void handle_member(const m::event &, m::vm::eval &);
+
+extern conf::item<size_t> txn_pdus_max;
+extern conf::item<size_t> txn_edus_max;
+extern conf::item<size_t> queue_pdus_max;
+extern conf::item<size_t> queue_edus_max;
+extern conf::item<seconds> backoff_min;
+extern conf::item<seconds> backoff_max;
+extern conf::item<seconds> cursor_interval;
+extern conf::item<bool> replay_enable;
+extern conf::item<size_t> origins_cache_max;
+extern const db::descriptor cursors_descriptor;
+extern const db::description cursors_description;
+std::shared_ptr<db::database> cursors_database;
+db::column cursors;
+
+static void init_sender();
+static void fini_sender() noexcept;
+
+context sender;
+context receiver;
 
-context
-sender
+mapi::header
+IRCD_MODULE
 {
-	"m.fedsnd.S", 1_MiB, &send_worker, context::POST,
+	"federation sender", init_sender, fini_sender
 };
 
-context
-receiver
+void
+init_sender()
 {
-	"m.fedsnd.R", 1_MiB, &recv_worker, context::POST,
-};
+	static const std::string dbopts;
+	cursors_database = std::make_shared<db::database>("federation", dbopts, cursors_description);
+	cursors = db::column{*cursors_database, "cursors"};
 
-mapi::header
-IRCD_MODULE
-{
-	"federation sender", nullptr,
-	[]
+	// The workers read the cursors, so they start after the database.
+	sender = context
 	{
+		"m.fedsnd.S", 1_MiB, &send_worker, context::POST,
+	};
+
+	receiver = context
+	{
+		"m.fedsnd.R", 1_MiB, &recv_worker, context::POST,
+	};
+}
+
+void
+fini_sender()
+noexcept
+{
+	if(sender)
 		sender.terminate();
+
+	if(receiver)
 		receiver.terminate();
-		sender.join();
-		receiver.join();
-	}
+
+	sender.join();
+	receiver.join();
+
+	// see: media::fini()
+	cursors = {};
+	cursors_database = std::shared_ptr<db::database>{};
+}
+
+decltype(cursors_descriptor)
+cursors_descriptor
+{
+	// name
+	"cursors",
+
+	// explain
+	R"(
+	Delivery cursors of the federation sender.
+
+	[remote] => event_idx
+
+	The value is the event_idx of the last PDU acknowledged by the remote as
+	a native integer. The key of our own server holds the low-water mark from
+	which our PDUs are replayed at startup.
+	)",
+
+	// typing
+	{
+		typeid(string_view), typeid(uint64_t)
+	},
+
+	{},      // options
+	{},      // comparator
+	{},      // prefix transform
+	false,   // drop column
+
+	// cache size
+	-1,
+
+	// cache size for compressed assets
+	0,
+
+	// bloom_bits
+	10,
+
+	// expect hit
+	false,
 };
 
-std::deque<std::pair<std::string, m::event::id::buf>>
+decltype(cursors_description)
+cursors_description
+{
+	{ "default" }, // requirement of RocksDB
+
+	cursors_descriptor,
+};
+
+conf::item<size_t>
+txn_pdus_max
+{
+	{ "name",     "ircd.federation.sender.txn.pdus.max" },
+	{ "default",  50L                                   },
+};
+
+conf::item<size_t>
+txn_edus_max
+{
+	{ "name",     "ircd.federation.sender.txn.edus.max" },
+	{ "default",  100L                                  },
+};
+
+conf::item<size_t>
+queue_pdus_max
+{
+	{ "name",     "ircd.federation.sender.queue.pdus.max" },
+	{ "default",  4096L                                   },
+	{ "description",
+
+	R"(
+	Maximum number of PDUs queued in memory for any one destination. Beyond
+	this the destination falls back to scanning the database forward from
+	its cursor as it is able to accept transactions.
+	)"}
+};
+
+conf::item<size_t>
+queue_edus_max
+{
+	{ "name",     "ircd.federation.sender.queue.edus.max" },
+	{ "default",  1024L                                   },
+	{ "description",
+
+	R"(
+	Maximum number of EDUs queued in memory for any one destination. EDUs
+	are ephemeral; the oldest are discarded beyond this limit.
+	)"}
+};
+
+conf::item<seconds>
+backoff_min
+{
+	{ "name",     "ircd.federation.sender.backoff.min" },
+	{ "default",  5L                                   },
+};
+
+conf::item<seconds>
+backoff_max
+{
+	{ "name",     "ircd.federation.sender.backoff.max" },
+	{ "default",  900L                                 },
+};
+
+conf::item<seconds>
+cursor_interval
+{
+	{ "name",     "ircd.federation.sender.cursor.interval" },
+	{ "default",  60L                                      },
+	{ "description",
+
+	R"(
+	Minimum interval between saving the delivery cursor of each destination.
+	PDUs acknowledged after the last save are sent again after a restart;
+	remotes deduplicate them.
+	)"}
+};
+
+conf::item<bool>
+replay_enable
+{
+	{ "name",     "ircd.federation.sender.replay" },
+	{ "default",  true                            },
+	{ "description",
+
+	R"(
+	Resume delivery from the saved cursors when the sender starts, sending
+	any of our PDUs which were not acknowledged before the last shutdown.
+	)"}
+};
+
+conf::item<size_t>
+origins_cache_max
+{
+	{ "name",     "ircd.federation.sender.origins.cache.max" },
+	{ "default",  4096L                                      },
+	{ "description",
+
+	R"(
+	Number of rooms for which the set of joined servers is kept in memory
+	for fan-out. Least recently used rooms are evicted. Zero disables the
+	cache and every fan-out queries the database.
+	)"}
+};
+
+std::deque<notice>
 notified_queue;
 
 ctx::dock
 notified_dock;
 
+/// The greatest event_idx processed by the send worker; all events up to
+/// this point have been queued for their destinations.
+m::event::idx
+notified_idx;
+
 m::hookfn<m::vm::eval &>
 notified
 {
@@ -139,6 +390,41 @@ notified
 	}
 };
 
+m::hookfn<m::vm::eval &>
+member_effect
+{
+	handle_member,
+	{
+		{ "_site",  "vm.effect"      },
+		{ "type",   "m.room.member"  },
+	}
+};
+
+void
+handle_member(const m::event &event,
+              m::vm::eval &eval)
+try
+{
+	const m::user::id &target
+	{
+		at<"state_key"_>(event)
+	};
+
+	origins::update(at<"room_id"_>(event), target.host());
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		m::log, "Federation sender origins update :%s",
+		e.what()
+	};
+}
+
 void
 handle_notify(const m::event &event,
               m::vm::eval &eval)
@@ -151,14 +437,22 @@ try
 	if(!eval.opts->notify_servers)
 		return;
 
-	const m::event::id::buf &event_id
+	if(event.event_id)
 	{
-		event.event_id?
-			m::event::id::buf{event.event_id}:
-			m::event::id::buf{}
-	};
+		const m::event::idx event_idx
+		{
+			eval.sequence?:
+				m::index(std::nothrow, event.event_id)
+		};
+
+		if(likely(event_idx))
+			notified_queue.emplace_back(notice{event_idx});
+	}
+	else notified_queue.emplace_back(notice
+	{
+		0UL, json::strung{event}
+	});
 
-	notified_queue.emplace_back(json::strung{event}, event_id);
 	notified_dock.notify_all();
 }
 catch(const ctx::interrupted &)
@@ -178,6 +472,8 @@ void
 __attribute__((noreturn))
 send_worker()
 {
+	replay();
+
 	while(1) try
 	{
 		notified_dock.wait([]
@@ -191,17 +487,31 @@ send_worker()
 			notified_queue.pop_front();
 		}};
 
-		const auto &[event_, event_id]
+		const auto &[event_idx, edu]
 		{
 			notified_queue.front()
 		};
 
-		const m::event event
+		if(!event_idx)
+		{
+			const m::event event
+			{
+				json::object{edu}
+			};
+
+			send(event, 0UL);
+			continue;
+		}
+
+		const m::event::fetch event
 		{
-			json::object{event_}, event_id
+			std::nothrow, event_idx
 		};
 
-		send(event);
+		if(likely(event.valid))
+			send(event, event_idx);
+
+		notified_idx = std::max(notified_idx, event_idx);
 	}
 	catch(const std::exception &e)
 	{
@@ -212,8 +522,70 @@ send_worker()
 	}
 }
 
+/// Sends our PDUs which were retired after the low-water mark saved under
+/// our own name; each destination skips what is behind its own cursor.
 void
-send(const m::event &event)
+replay()
+try
+{
+	const m::event::idx low
+	{
+		read_cursor(m::my_host())
+	};
+
+	const m::event::idx &retired
+	{
+		m::vm::sequence::retired
+	};
+
+	notified_idx = low?: retired;
+	if(!low || !replay_enable)
+		return;
+
+	size_t count(0);
+	const m::events::range range
+	{
+		low + 1, retired + 1
+	};
+
+	m::events::for_each(range, [&count]
+	(const m::event::idx &event_idx, const m::event &event)
+	{
+		if(event.event_id && my(event))
+		{
+			send(event, event_idx);
+			++count;
+		}
+
+		notified_idx = event_idx;
+		return true;
+	});
+
+	log::info
+	{
+		m::log, "Federation sender replayed %zu of our events in %lu:%lu to %zu nodes.",
+		count,
+		low + 1,
+		retired,
+		nodes.size(),
+	};
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		m::log, "Federation sender replay :%s",
+		e.what()
+	};
+}
+
+void
+send(const m::event &event,
+     const m::event::idx &event_idx)
 {
 	const auto &type
 	{
@@ -240,7 +612,7 @@ send(const m::event &event)
 
 	// target is every remote server in a room
 	if(valid(m::id::ROOM, room_id))
-		return send_to_room(event, m::room::id{room_id});
+		return send_to_room(event, event_idx, m::room::id{room_id});
 
 	// target is remote server hosting user/device
 	if(type == "m.direct_to_device")
@@ -251,32 +623,33 @@ send(const m::event &event)
 		};
 
 		if(valid(m::id::USER, target))
-			return send_to_user(event, m::user::id(target));
+			return send_to_user(event, event_idx, m::user::id(target));
 	}
 
 	// target is every remote server from every room a user is joined to.
 	if(valid(m::id::USER, sender))
-		return send_from_user(event, m::user::id{sender});
+		return send_from_user(event, event_idx, m::user::id{sender});
 }
 
 /// EDU and PDU path where the target is a room
 void
 send_to_room(const m::event &event,
+             const m::event::idx &event_idx,
              const m::room::id &room_id)
 {
-	const m::room room
-	{
-		room_id
-	};
+	// The membership effect may not have been applied yet; the update is
+	// idempotent so the fan-out for this event is made consistent here.
+	if(json::get<"type"_>(event) == "m.room.member")
+		origins::update(room_id, m::user::id(at<"state_key"_>(event)).host());
 
-	const m::room::origins origins
+	const auto servers
 	{
-		room
+		origins::get(room_id)
 	};
 
 	// Unit is not allocated until we find another server in the room.
 	std::shared_ptr<struct unit> unit;
-	const auto each_origin{[&unit, &event]
+	const auto each_origin{[&unit, &event, &event_idx]
 	(const string_view &origin)
 	{
 		if(my_host(origin))
@@ -285,28 +658,27 @@ send_to_room(const m::event &event,
 		if(m::fed::errant(origin))
 			return;
 
-		auto it
+		auto &node
 		{
-			nodes.lower_bound(origin)
+			get_node(origin)
 		};
 
-		if(it == end(nodes) || it->first != origin)
-			it = nodes.emplace_hint(it, origin, origin);
-
-		auto &node
+		if(event_idx)
+			node.push(event_idx);
+		else
 		{
-			it->second
-		};
+			if(!unit)
+				unit = std::make_shared<struct unit>(event);
 
-		if(!unit)
-			unit = std::make_shared<struct unit>(event);
+			node.push(unit);
+		}
 
-		node.push(unit);
 		node.flush();
 	}};
 
 	// Iterate all servers with a joined user
-	origins.for_each(each_origin);
+	for(const auto &origin : *servers)
+		each_origin(origin);
 
 	// Special case for negative membership changes (i.e kicks and bans)
 	// which may remove a server from the above iteration
@@ -323,7 +695,7 @@ send_to_room(const m::event &event,
 				target.host()
 			};
 
-			if(!origins.has(origin))
+			if(!origins::has(*servers, origin))
 				each_origin(origin);
 		}
 }
@@ -331,6 +703,7 @@ send_to_room(const m::event &event,
 /// EDU path where the target is a user/device
 void
 send_to_user(const m::event &event,
+             const m::event::idx &event_idx,
              const m::user::id &user_id)
 {
 	const string_view &origin
@@ -344,25 +717,16 @@ send_to_user(const m::event &event,
 	if(m::fed::errant(origin))
 		return;
 
-	auto it
-	{
-		nodes.lower_bound(origin)
-	};
-
-	if(it == end(nodes) || it->first != origin)
-		it = nodes.emplace_hint(it, origin, origin);
-
 	auto &node
 	{
-		it->second
+		get_node(origin)
 	};
 
-	auto unit
-	{
-		std::make_shared<struct unit>(event)
-	};
+	if(event_idx)
+		node.push(event_idx);
+	else
+		node.push(std::make_shared<struct unit>(event));
 
-	node.push(std::move(unit));
 	node.flush();
 }
 
@@ -370,6 +734,7 @@ send_to_user(const m::event &event,
 /// is joined to.
 void
 send_from_user(const m::event &event,
+               const m::event::idx &event_idx,
                const m::user::id &user_id)
 {
 	const m::user::servers servers
@@ -377,8 +742,11 @@ send_from_user(const m::event &event,
 		user_id
 	};
 
+	// Unit is not allocated until we find another server.
+	std::shared_ptr<struct unit> unit;
+
 	// Iterate all of the servers visible in this user's joined rooms.
-	servers.for_each("join", [&user_id, &event]
+	servers.for_each("join", [&unit, &event, &event_idx]
 	(const string_view &origin)
 	{
 		if(my_host(origin))
@@ -387,70 +755,282 @@ send_from_user(const m::event &event,
 		if(m::fed::errant(origin))
 			return true;
 
-		auto it
+		auto &node
 		{
-			nodes.lower_bound(origin)
+			get_node(origin)
 		};
 
-		if(it == end(nodes) || it->first != origin)
-			it = nodes.emplace_hint(it, origin, origin);
+		if(event_idx)
+			node.push(event_idx);
+		else
+		{
+			if(!unit)
+				unit = std::make_shared<struct unit>(event);
 
-		auto &node
+			node.push(unit);
+		}
+
+		node.flush();
+		return true;
+	});
+}
+
+node &
+get_node(const string_view &origin)
+{
+	auto it
+	{
+		nodes.lower_bound(origin)
+	};
+
+	if(it == end(nodes) || it->first != origin)
+		it = nodes.emplace_hint(it, origin, origin);
+
+	return it->second;
+}
+
+//
+// node
+//
+
+void
+node::push(std::shared_ptr<unit> su)
+{
+	// Discard the oldest EDU which is not part of the current txn.
+	if(edus.size() >= size_t(queue_edus_max) && edus.size() > inflight_edus)
+		edus.erase(begin(edus) + inflight_edus);
+
+	edus.emplace_back(std::move(su));
+}
+
+void
+node::push(const m::event::idx &event_idx)
+{
+	if(!loaded)
+		load(event_idx);
+
+	// Already queued, delivered, or covered by a catchup scan.
+	if(event_idx <= head)
+		return;
+
+	head = event_idx;
+	if(catchup)
+		return;
+
+	if(pdus.size() >= size_t(queue_pdus_max))
+	{
+		log::dwarning
 		{
-			it->second
+			m::log, "Federation sender queue to %s full at %zu; catching up from %lu",
+			remote,
+			pdus.size(),
+			cursor,
 		};
 
-		auto unit
+		catchup = true;
+		return;
+	}
+
+	pdus.emplace_back(event_idx);
+}
+
+/// Reads the saved cursor. Without one this node starts from the first PDU
+/// it is given.
+void
+node::load(const m::event::idx &event_idx)
+{
+	assert(!loaded);
+	loaded = true;
+	cursor = read_cursor(remote);
+
+	saved = cursor;
+	cursor = cursor?: event_idx - 1;
+	head = std::max(head, cursor);
+}
+
+void
+node::save()
+{
+	if(!loaded || cursor <= saved)
+		return;
+
+	write_cursor(remote, cursor);
+	saved = cursor;
+}
+
+/// Refills the empty queue during catchup by scanning our events forward
+/// from the cursor for rooms this node is joined to.
+bool
+node::scan()
+{
+	assert(catchup);
+	assert(pdus.empty());
+
+	const m::event::idx &retired
+	{
+		m::vm::sequence::retired
+	};
+
+	const m::events::range range
+	{
+		cursor + 1, retired + 1
+	};
+
+	const size_t max
+	{
+		std::min(size_t(txn_pdus_max), size_t(queue_pdus_max))
+	};
+
+	m::events::for_each(range, [this, &max]
+	(const m::event::idx &event_idx, const m::event &event)
+	{
+		if(!event.event_id || !my(event))
+			return true;
+
+		if(!valid(m::id::ROOM, json::get<"room_id"_>(event)))
+			return true;
+
+		const auto servers
 		{
-			std::make_shared<struct unit>(event)
+			origins::get(at<"room_id"_>(event))
 		};
 
-		node.push(unit);
-		node.flush();
-		return true;
+		if(origins::has(*servers, remote))
+			pdus.emplace_back(event_idx);
+
+		return pdus.size() < max;
 	});
+
+	// The scan reached everything pushed while in catchup.
+	if(pdus.size() < max && retired >= head)
+		catchup = false;
+
+	if(!pdus.empty())
+		head = std::max(head, pdus.back());
+
+	return !pdus.empty();
 }
 
 void
-node::push(std::shared_ptr<unit> su)
+node::success()
 {
-	q.emplace_back(std::move(su));
+	if(inflight_pdus)
+	{
+		cursor = pdus.at(inflight_pdus - 1);
+		pdus.erase(begin(pdus), begin(pdus) + inflight_pdus);
+	}
+	else if(pdus.empty() && !catchup)
+		cursor = std::max(cursor, head);
+
+	edus.erase(begin(edus), begin(edus) + std::min(inflight_edus, edus.size()));
+	inflight_pdus = 0;
+	inflight_edus = 0;
+	failures = 0;
+}
+
+void
+node::failure()
+{
+	inflight_pdus = 0;
+	inflight_edus = 0;
+	++failures;
+
+	const auto exp
+	{
+		std::min(failures - 1, 16UL)
+	};
+
+	const seconds delay
+	{
+		std::min(seconds(backoff_min) * (1L << exp), seconds(backoff_max))
+	};
+
+	backoff = now<steady_point>() + delay;
+	log::dwarning
+	{
+		m::log, "Federation sender backing off %s for %lds after %zu failures; %zu PDUs %zu EDUs pending",
+		remote,
+		delay.count(),
+		failures,
+		pdus.size(),
+		edus.size(),
+	};
+}
+
+bool
+node::pending()
+const
+{
+	return !pdus.empty() || !edus.empty() || catchup;
 }
 
 bool
 node::flush()
 try
 {
-	if(q.empty())
+	if(curtxn || busy)
 		return true;
 
-	if(curtxn)
+	if(now<steady_point>() < backoff)
 		return true;
 
-	size_t pdus{0}, edus{0};
-	for(const auto &unit : q) switch(unit->type)
+	const scope_restore busy_
 	{
-		case unit::PDU:   ++pdus;  break;
-		case unit::EDU:   ++edus;  break;
-		default:                   break;
-	}
+		this->busy, true
+	};
+
+	if(pdus.empty() && catchup)
+		scan();
+
+	if(pdus.empty() && edus.empty())
+		return true;
+
+	const size_t pdus_max
+	{
+		std::min(pdus.size(), size_t(txn_pdus_max))
+	};
+
+	const size_t edus_max
+	{
+		std::min(edus.size(), size_t(txn_edus_max))
+	};
+
+	// The EDUs are held here and marked inflight before this context yields
+	// for the PDUs; push() only discards EDUs after those inflight.
+	const std::vector<std::shared_ptr<unit>> edu_units
+	{
+		begin(edus), begin(edus) + edus_max
+	};
+
+	inflight_edus = edus_max;
+	const unwind_exceptional reset{[this]
+	{
+		inflight_edus = 0;
+	}};
+
+	// Strings must not be relocated after views into them are taken.
+	std::vector<std::string> strung;
+	strung.reserve(pdus_max);
 
 	size_t pc(0), ec(0);
-	std::vector<json::value> units(pdus + edus);
-	for(const auto &unit : q) switch(unit->type)
+	std::vector<json::value> units(pdus_max + edus_max);
+	for(size_t i(0); i < pdus_max; ++i)
 	{
-		case unit::PDU:
-			units.at(pc++) = string_view{unit->s};
-			break;
+		const m::event::fetch event
+		{
+			std::nothrow, pdus.at(i)
+		};
 
-		case unit::EDU:
-			units.at(pdus + ec++) = string_view{unit->s};
-			break;
+		if(unlikely(!event.valid))
+			continue;
 
-		default:
-			break;
+		strung.emplace_back(json::strung{event});
+		units.at(pc++) = string_view{strung.back()};
 	}
 
+	for(const auto &unit : edu_units)
+		units.at(pdus_max + ec++) = string_view{unit->s};
+
 	m::fed::send::opts opts;
 	opts.remote = remote;
 	opts.dynamic = false;
@@ -463,7 +1043,7 @@ try
 
 	const vector_view<const json::value> eduv
 	{
-		units.data() + pdus, units.data() + pdus + ec
+		units.data() + pdus_max, units.data() + pdus_max + ec
 	};
 
 	std::string content
@@ -474,19 +1054,26 @@ try
 	txns.emplace_back(*this, std::move(content), std::move(opts));
 	const unwind_nominal_assertion na;
 	curtxn = &txns.back();
-	q.clear();
+	inflight_pdus = pdus_max;
 	log::debug
 	{
-		m::log, "sending txn %s pdus:%zu edus:%zu to '%s'",
+		m::log, "sending txn %s pdus:%zu edus:%zu to '%s' queued pdus:%zu edus:%zu catchup:%b",
 		curtxn->txnid,
-		pdus,
-		edus,
+		pc,
+		ec,
 		this->remote,
+		pdus.size(),
+		edus.size(),
+		catchup,
 	};
 
 	recv_action.notify_one();
 	return true;
 }
+catch(const ctx::interrupted &)
+{
+	throw;
+}
 catch(const std::exception &e)
 {
 	log::error
@@ -497,19 +1084,29 @@ catch(const std::exception &e)
 	return false;
 }
 
+//
+// receiver
+//
+
 void
 __attribute__((noreturn))
 recv_worker()
 {
 	while(1)
 	{
-		recv_action.wait([]
+		recv_action.wait_for(seconds(1), []
 		{
 			return !txns.empty();
 		});
 
-		recv();
-		recv_timeouts();
+		if(!txns.empty())
+		{
+			recv();
+			recv_timeouts();
+		}
+
+		retry_nodes();
+		save_cursors();
 	}
 }
 
@@ -551,8 +1148,10 @@ try
 	node.curtxn = nullptr;
 	txns.erase(it);
 
-	if(!ret)
-		return;
+	if(ret)
+		node.success();
+	else
+		node.failure();
 
 	node.flush();
 }
@@ -671,6 +1270,96 @@ recv_timeout(txn &txn,
 	cancel(txn);
 }
 
+/// Flush the nodes with work remaining which are idle after a backoff or a
+/// catchup scan.
+void
+retry_nodes()
+{
+	const auto &now
+	{
+		ircd::now<steady_point>()
+	};
+
+	for(auto &[remote, node] : nodes)
+		if(!node.curtxn && node.pending() && node.backoff <= now)
+			node.flush();
+}
+
+/// Saves the cursor of each node which has advanced, and the low-water mark
+/// for replay under our own name; rate-limited by the interval.
+void
+save_cursors()
+try
+{
+	static steady_point last;
+	static m::event::idx last_low;
+	const auto &now
+	{
+		ircd::now<steady_point>()
+	};
+
+	if(last + seconds(cursor_interval) > now)
+		return;
+
+	last = now;
+	m::event::idx low
+	{
+		notified_idx
+	};
+
+	for(auto &[remote, node] : nodes)
+	{
+		if(node.pending() || node.curtxn)
+			low = std::min(low, node.cursor);
+
+		node.save();
+	}
+
+	if(!low || low <= last_low)
+		return;
+
+	write_cursor(m::my_host(), low);
+	last_low = low;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		m::log, "Federation sender saving cursors :%s",
+		e.what()
+	};
+}
+
+m::event::idx
+read_cursor(const string_view &key)
+{
+	m::event::idx ret{0};
+	cursors(key, std::nothrow, [&ret]
+	(const string_view &value)
+	{
+		if(likely(size(value) == sizeof(ret)))
+			ret = byte_view<m::event::idx>(value);
+	});
+
+	return ret;
+}
+
+void
+write_cursor(const string_view &key,
+             const m::event::idx &event_idx)
+{
+	const byte_view<string_view> value
+	{
+		event_idx
+	};
+
+	db::write(cursors, key, const_buffer{value});
+}
+
 void
 remove_node(const node &node)
 {
@@ -683,6 +1372,131 @@ remove_node(const node &node)
 	nodes.erase(it);
 }
 
+//
+// origins
+//
+
+decltype(origins::lru)
+origins::lru;
+
+decltype(origins::map)
+origins::map;
+
+decltype(origins::epoch)
+origins::epoch;
+
+origins::ptr
+origins::get(const m::room::id &room_id)
+{
+	const auto it
+	{
+		map.find(room_id)
+	};
+
+	if(it != end(map))
+	{
+		lru.splice(begin(lru), lru, it->second);
+		return it->second->set;
+	}
+
+	const m::room::origins room_origins
+	{
+		m::room{room_id}
+	};
+
+	// room_joined is iterated in key order so the result is sorted.
+	const auto epoch(origins::epoch);
+	auto set(std::make_shared<vector>());
+	room_origins.for_each([&set]
+	(const string_view &origin)
+	{
+		set->emplace_back(origin);
+	});
+
+	assert(std::is_sorted(begin(*set), end(*set)));
+	const size_t max(origins_cache_max);
+	if(!max)
+		return set;
+
+	// An update or concurrent fill was made while yielding for the query;
+	// this result might be stale so it's not cached.
+	if(epoch != origins::epoch || map.count(room_id))
+		return set;
+
+	lru.emplace_front(origins
+	{
+		std::string(room_id), set
+	});
+
+	map.emplace(lru.front().room_id, begin(lru));
+	while(lru.size() > max)
+	{
+		map.erase(lru.back().room_id);
+		lru.pop_back();
+	}
+
+	return set;
+}
+
+/// Recounts one server's joined members for a cached room and adds or
+/// removes it from the set. Uncached rooms are only invalidated.
+void
+origins::update(const m::room::id &room_id,
+                const string_view &origin)
+{
+	++epoch;
+	const auto it
+	{
+		map.find(room_id)
+	};
+
+	if(it == end(map))
+		return;
+
+	const m::room::members members
+	{
+		m::room{room_id}
+	};
+
+	const bool joined
+	{
+		!members.empty("join", origin)
+	};
+
+	// The entry may have been evicted while querying.
+	const auto jt
+	{
+		map.find(room_id)
+	};
+
+	if(jt == end(map) || has(*jt->second->set, origin) == joined)
+		return;
+
+	auto set
+	{
+		std::make_shared<vector>(*jt->second->set)
+	};
+
+	const auto pos
+	{
+		std::lower_bound(begin(*set), end(*set), origin)
+	};
+
+	if(joined)
+		set->emplace(pos, origin);
+	else
+		set->erase(pos);
+
+	jt->second->set = std::move(set);
+}
+
+bool
+origins::has(const vector &set,
+             const string_view &origin)
+{
+	return std::binary_search(begin(set), end(set), origin);
+}
+
 //
 // unit
 //
@@ -10,14 +10,76 @@
 
 namespace ircd::m::push
 {
+	struct program;
+	struct cache;
+
 	static void execute(const event &, vm::eval &, const user::id &, const path &, const rule &, const event::idx &);
-	static bool matching(const event &, vm::eval &, const user::id &, const path &, const rule &);
-	static bool handle_kind(const event &, vm::eval &, const user::id &, const path &);
-	static void handle_rules(const event &, vm::eval &, const user::id &, const string_view &scope);
+	static void handle_program(const event &, vm::eval &, const user::id &, const cache &, const program &, std::vector<int8_t> &, const json::object::tape &);
+	static void handle_user_room(const event &);
 	static void handle_event(const m::event &, vm::eval &);
+	static std::shared_ptr<cache> get_cache();
+
+	extern conf::item<size_t> cache_max;
+	extern std::shared_ptr<cache> cache_;
 	extern hookfn<vm::eval &> hook_event;
 }
 
+/// A user's push rules compiled for evaluation. The enabled rules of each
+/// kind are in their order of priority; the conditions of each rule are
+/// indexes into the cache, where identical conditions of all users are kept
+/// once. Conditions which don't depend on the user are then evaluated once
+/// per event for everybody in the room.
+struct ircd::m::push::program
+{
+	struct rule;
+
+	static const std::array<string_view, 5> kinds;
+
+	std::array<std::vector<rule>, kinds.size()> rules;
+	std::string displayname;
+};
+
+struct ircd::m::push::program::rule
+{
+	event::idx idx {0};              // zero for a server-default
+	std::string ruleid;
+	std::string source;              // content of a user-set rule
+	string_view default_source;      // content of a server-default rule
+	std::vector<uint32_t> conds;
+
+	json::object content() const     { return idx? string_view{source}: default_source; }
+};
+
+/// Compiled programs of users and the conditions they share. A program is
+/// dropped when its user's pushrules or profile change; the whole cache is
+/// replaced when it grows too large. Evaluations in progress hold the cache
+/// they started with.
+struct ircd::m::push::cache
+{
+	struct cond
+	{
+		std::string source;
+		bool per_user {false};
+	};
+
+	std::map<std::string, std::shared_ptr<const program>, std::less<>> programs;
+	std::map<std::string, uint32_t, std::less<>> cond_id;
+	std::deque<cond> conds;
+	uint64_t invalidations {0};
+
+	uint32_t intern(const string_view &cond);
+	std::shared_ptr<const program> compile(const user::id &);
+
+  public:
+	std::shared_ptr<const program> get(const user::id &);
+	bool invalidate(const user::id &);
+};
+
+namespace ircd::m::push
+{
+	static bool matching(const event &, const cache &, const program::rule &, std::vector<int8_t> &, const match::opts &);
+}
+
 ircd::mapi::header
 IRCD_MODULE
 {
@@ -33,19 +95,39 @@ ircd::m::push::hook_event
 	}
 };
 
+decltype(ircd::m::push::cache_max)
+ircd::m::push::cache_max
+{
+	{ "name",     "ircd.m.push.cache.max" },
+	{ "default",  16384L                  },
+};
+
+decltype(ircd::m::push::cache_)
+ircd::m::push::cache_;
+
+decltype(ircd::m::push::program::kinds)
+ircd::m::push::program::kinds
+{
+	"override",
+	"content",
+	"room",
+	"sender",
+	"underride",
+};
+
 void
 ircd::m::push::handle_event(const m::event &event,
                             vm::eval &eval)
 try
 {
-	// No push notifications are generated from events in internal rooms.
-	if(eval.room_internal)
-		return;
-
 	// No push notifications are generated from EDU's (at least directly).
 	if(!event.event_id)
 		return;
 
+	// No push notifications are generated from events in internal rooms.
+	if(eval.room_internal)
+		return handle_user_room(event);
+
 	const m::room::id &room_id
 	{
 		at<"room_id"_>(event)
@@ -56,7 +138,24 @@ try
 		room_id
 	};
 
-	members.for_each("join", my_host(), [&event, &eval]
+	// The content is indexed once for the rules of all members.
+	const json::object::tape content
+	{
+		json::get<"content"_>(event)
+	};
+
+	const auto cache
+	{
+		get_cache()
+	};
+
+	// Results of the conditions which don't depend on the user.
+	std::vector<int8_t> memo
+	(
+		cache->conds.size(), -1
+	);
+
+	members.for_each("join", my_host(), [&event, &eval, &content, &cache, &memo]
 	(const user::id &user_id, const event::idx &membership_event_idx)
 	{
 		// r0.6.0-13.13.15 Homeservers MUST NOT notify the Push Gateway for
@@ -64,7 +163,12 @@ try
 		if(user_id == at<"sender"_>(event))
 			return true;
 
-		handle_rules(event, eval, user_id, "global");
+		const auto program
+		{
+			cache->get(user_id)
+		};
+
+		handle_program(event, eval, user_id, *cache, *program, memo, content);
 		return true;
 	});
 }
@@ -82,86 +186,79 @@ catch(const std::exception &e)
 	};
 }
 
+/// Drop the program of a user whose pushrules or profile changed; the
+/// deletion of a rule is a redaction in the user's room.
 void
-ircd::m::push::handle_rules(const event &event,
-                            vm::eval &eval,
-                            const user::id &user_id,
-                            const string_view &scope)
+ircd::m::push::handle_user_room(const event &event)
 {
-	const push::path path[]
+	const auto &type
 	{
-		{ scope, "override",   string_view{}         },
-		{ scope, "content",    string_view{}         },
-		{ scope, "room",       at<"room_id"_>(event) },
-		{ scope, "sender",     at<"sender"_>(event)  },
-		{ scope, "underride",  string_view{}         },
+		json::get<"type"_>(event)
 	};
 
-	for(const auto &p : path)
-		if(!handle_kind(event, eval, user_id, p))
-			break;
-}
-
-bool
-ircd::m::push::handle_kind(const event &event,
-                           vm::eval &eval,
-                           const user::id &user_id,
-                           const path &path)
-{
-	const user::pushrules pushrules
+	const bool relevant
 	{
-		user_id
+		startswith(type, rule::type_prefix)
+		|| type == "ircd.profile"
+		|| type == "m.room.redaction"
 	};
 
-	return pushrules.for_each(path, [&event, &eval, &user_id]
-	(const auto &event_idx, const auto &path, const auto &rule)
-	{
-		if(matching(event, eval, user_id, path, rule))
-		{
-			execute(event, eval, user_id, path, rule, event_idx);
-			return false; // false to break due to match
-		}
-		else return true;
-	});
-}
+	if(!relevant || !cache_)
+		return;
 
-bool
-ircd::m::push::matching(const event &event,
-                        vm::eval &eval,
-                        const user::id &user_id,
-                        const path &path,
-                        const rule &rule)
-try
-{
-	const auto &[scope, kind, ruleid]
+	const m::user::id &sender
 	{
-		path
+		at<"sender"_>(event)
 	};
 
-	if(!json::get<"enabled"_>(rule))
-		return false;
+	if(!my(sender) || !m::user::room::is(at<"room_id"_>(event), sender))
+		return;
 
+	cache_->invalidate(sender);
+}
+
+void
+ircd::m::push::handle_program(const event &event,
+                              vm::eval &eval,
+                              const user::id &user_id,
+                              const cache &cache,
+                              const program &program,
+                              std::vector<int8_t> &memo,
+                              const json::object::tape &content)
+try
+{
 	push::match::opts opts;
 	opts.user_id = user_id;
-	const push::match match
-	{
-		event, rule, opts
-	};
+	opts.content = &content;
+	opts.displayname = &program.displayname;
 
-	#if 0
-	log::debug
-	{
-		log, "event %s rule { %s, %s, %s } for %s %s",
-		string_view{event.event_id},
-		scope,
-		kind,
-		ruleid,
-		string_view{user_id},
-		bool(match)? "MATCH"_sv : string_view{}
-	};
-	#endif
+	// The first matching rule of all kinds is executed.
+	for(size_t i(0); i < program.rules.size(); ++i)
+		for(size_t j(0); j < program.rules[i].size(); ++j)
+		{
+			const auto &rule
+			{
+				program.rules[i][j]
+			};
+
+			// The rule_id of room and sender rules is the room or sender
+			if(program::kinds[i] == "room" && rule.ruleid != json::get<"room_id"_>(event))
+				continue;
+
+			if(program::kinds[i] == "sender" && rule.ruleid != json::get<"sender"_>(event))
+				continue;
 
-	return bool(match);
+			if(!matching(event, cache, rule, memo, opts))
+				continue;
+
+			const push::path path
+			{
+				"global", program::kinds[i], rule.ruleid
+			};
+
+			execute(event, eval, user_id, path, push::rule{rule.content()}, rule.idx);
+			return;
+		}
 }
 catch(const ctx::interrupted &)
 {
@@ -169,23 +266,13 @@ catch(const ctx::interrupted &)
 }
 catch(const std::exception &e)
 {
-	const auto &[scope, kind, ruleid]
-	{
-		path
-	};
-
 	log::error
 	{
-		log, "Push rule matching in %s for %s at { %s, %s, %s } :%s",
+		log, "Push rule matching in %s for %s :%s",
 		string_view{event.event_id},
 		string_view{user_id},
-		scope,
-		kind,
-		ruleid,
 		e.what(),
 	};
-
-	return false;
 }
 
 void
@@ -269,3 +356,220 @@ catch(const std::exception &e)
 		e.what(),
 	};
 }
+
+bool
+ircd::m::push::matching(const event &event,
+                        const cache &cache,
+                        const program::rule &rule,
+                        std::vector<int8_t> &memo,
+                        const match::opts &opts)
+{
+	for(const auto &id : rule.conds)
+	{
+		assert(id < cache.conds.size());
+		const auto &cond
+		{
+			cache.conds.at(id)
+		};
+
+		// Conditions compiled after the event's evaluation began.
+		if(unlikely(id >= memo.size()))
+			memo.resize(cache.conds.size(), -1);
+
+		if(!cond.per_user && memo[id] >= 0)
+		{
+			if(!memo[id])
+				return false;
+
+			continue;
+		}
+
+		const bool ret
+		{
+			match(event, push::cond{json::object{cond.source}}, opts)
+		};
+
+		if(!cond.per_user)
+			memo[id] = ret;
+
+		if(!ret)
+			return false;
+	}
+
+	return true;
+}
+
+//
+// cache
+//
+
+std::shared_ptr<ircd::m::push::cache>
+ircd::m::push::get_cache()
+{
+	if(!cache_ || cache_->programs.size() > size_t(cache_max))
+		cache_ = std::make_shared<cache>();
+
+	return cache_;
+}
+
+std::shared_ptr<const ircd::m::push::program>
+ircd::m::push::cache::get(const user::id &user_id)
+{
+	const auto it
+	{
+		programs.find(user_id)
+	};
+
+	if(it != end(programs))
+		return it->second;
+
+	// The pushrules may change while they're read; a program compiled
+	// across an invalidation is used once but not kept.
+	const auto invalidations
+	{
+		this->invalidations
+	};
+
+	auto ret
+	{
+		compile(user_id)
+	};
+
+	if(invalidations == this->invalidations)
+		programs.emplace(std::string{user_id}, ret);
+
+	return ret;
+}
+
+bool
+ircd::m::push::cache::invalidate(const user::id &user_id)
+{
+	++invalidations;
+	const auto it
+	{
+		programs.find(user_id)
+	};
+
+	if(it == end(programs))
+		return false;
+
+	programs.erase(it);
+	return true;
+}
+
+std::shared_ptr<const ircd::m::push::program>
+ircd::m::push::cache::compile(const user::id &user_id)
+{
+	auto ret
+	{
+		std::make_shared<program>()
+	};
+
+	const user::pushrules pushrules
+	{
+		user_id
+	};
+
+	for(size_t i(0); i < program::kinds.size(); ++i)
+	{
+		const push::path path
+		{
+			"global", program::kinds[i], string_view{}
+		};
+
+		pushrules.for_each(path, [this, &ret, &i]
+		(const event::idx &event_idx, const push::path &path, const json::object &content)
+		{
+			const push::rule rule
+			{
+				content
+			};
+
+			if(!json::get<"enabled"_>(rule))
+				return true;
+
+			auto &compiled
+			{
+				ret->rules[i].emplace_back()
+			};
+
+			compiled.idx = event_idx;
+			compiled.ruleid = std::get<2>(path);
+			if(event_idx)
+				compiled.source = content;
+			else
+				compiled.default_source = content;
+
+			// Content rules match their pattern against the body.
+			if(json::get<"pattern"_>(rule))
+			{
+				const json::strung cond
+				{
+					json::members
+					{
+						{ "kind",     "event_match"               },
+						{ "key",      "content.body"              },
+						{ "pattern",  json::get<"pattern"_>(rule) },
+					}
+				};
+
+				compiled.conds.emplace_back(intern(cond));
+			}
+
+			for(const json::object cond : json::get<"conditions"_>(rule))
+				compiled.conds.emplace_back(intern(cond));
+
+			return true;
+		});
+	}
+
+	const m::user::profile profile
+	{
+		user_id
+	};
+
+	profile.get(std::nothrow, "displayname", [&ret]
+	(const string_view &, const json::string &displayname)
+	{
+		ret->displayname = displayname;
+	});
+
+	return ret;
+}
+
+uint32_t
+ircd::m::push::cache::intern(const string_view &source)
+{
+	const auto it
+	{
+		cond_id.lower_bound(source)
+	};
+
+	if(it != end(cond_id) && it->first == source)
+		return it->second;
+
+	const json::string &kind
+	{
+		json::object{source}["kind"]
+	};
+
+	const bool per_user
+	{
+		kind == "contains_user_mxid"
+		|| kind == "state_key_user_mxid"
+		|| kind == "contains_display_name"
+	};
+
+	const uint32_t id
+	(
+		conds.size()
+	);
+
+	conds.emplace_back(cond
+	{
+		std::string{source}, per_user
+	});
+
+	cond_id.emplace_hint(it, std::string{source}, id);
+	return id;
+}
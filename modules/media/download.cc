@@ -39,6 +39,31 @@ get__download_local(client &client,
                     const string_view &file,
                     const m::room &room);
 
+static bool
+get__download_remote(client &client,
+                     const m::resource::request &request,
+                     const m::media::mxc &mxc,
+                     const m::user::id &user_id);
+
+static std::pair<size_t, size_t>
+download_range(const m::resource::request &request,
+               const size_t &file_size,
+               const string_view &etag);
+
+static bool
+download_not_modified(const m::resource::request &request,
+                       const string_view &etag);
+
+static string_view
+download_etag(const mutable_buffer &buf,
+              const m::room::id &room_id);
+
+static const string_view
+download_headers
+{
+	"Cache-Control: public, max-age=31536000, immutable\r\n"
+};
+
 static m::resource::response
 get__download(client &client,
               const m::resource::request &request)
@@ -73,14 +98,101 @@ get__download(client &client,
 		request.query.get<bool>("allow_remote", true)
 	};
 
+	const m::media::mxc mxc
+	{
+		server, file
+	};
+
+	// A range is served once the file is stored.
+	if(!request.head.range && get__download_remote(client, request, mxc, user_id))
+		return {};
+
 	const m::room::id::buf room_id
 	{
-		m::media::file::download({server, file}, user_id)
+		m::media::file::download(mxc, user_id)
 	};
 
 	return get__download_local(client, request, server, file, room_id);
 }
 
+/// Presents a remote file to the client while it's being downloaded. False
+/// if nothing was sent because the file is to be read locally instead.
+static bool
+get__download_remote(client &client,
+                     const m::resource::request &request,
+                     const m::media::mxc &mxc,
+                     const m::user::id &user_id)
+{
+	const m::room::id::buf room_id
+	{
+		m::media::file::room_id(mxc)
+	};
+
+	char etag_buf[m::id::MAX_SIZE + 2];
+	const string_view etag
+	{
+		download_etag(etag_buf, room_id)
+	};
+
+	size_t file_size{0}, sent{0};
+	const auto head{[&client, &file_size, &etag]
+	(const size_t &size, const string_view &content_type)
+	{
+		char headers_buf[384];
+		file_size = size;
+		m::resource::response
+		{
+			client,
+			http::OK,
+			content_type,
+			file_size,
+			fmt::sprintf
+			{
+				headers_buf, "%sAccept-Ranges: bytes\r\nETag: %s\r\n",
+				download_headers,
+				etag,
+			},
+		};
+	}};
+
+	const auto content{[&client, &sent]
+	(const const_buffer &block)
+	{
+		sent += client.write_all(block);
+	}};
+
+	try
+	{
+		const bool ret
+		{
+			m::media::file::stream(mxc, user_id, head, content)
+		};
+
+		assert(!ret || sent == file_size);
+		return ret;
+	}
+	catch(const std::exception &e)
+	{
+		// Nothing was sent yet; the error is the response.
+		if(!file_size)
+			throw;
+
+		log::error
+		{
+			m::media::log, "File %s/%s failed after %zu of %zu bytes :%s",
+			mxc.server,
+			mxc.mediaid,
+			sent,
+			file_size,
+			e.what(),
+		};
+
+		// Have to kill client here after failing content length expectation.
+		client.close(net::dc::RST, net::close_ignore);
+		return true;
+	}
+}
+
 static m::resource::response
 get__download_local(client &client,
                     const m::resource::request &request,
@@ -127,48 +239,243 @@ get__download_local(client &client,
 		};
 	});
 
-	static const auto &addl_headers
+	char etag_buf[m::id::MAX_SIZE + 2];
+	const string_view etag
 	{
-		"Cache-Control: public, max-age=31536000, immutable\r\n"_sv
+		download_etag(etag_buf, room.room_id)
+	};
+
+	char headers_buf[384];
+	const auto headers{[&headers_buf, &etag]
+	(const string_view &content_range = {})
+	{
+		return fmt::sprintf
+		{
+			headers_buf, "%sAccept-Ranges: bytes\r\nETag: %s\r\n%s%s%s",
+			download_headers,
+			etag,
+			content_range? "Content-Range: "_sv: string_view{},
+			content_range,
+			content_range? "\r\n"_sv: string_view{},
+		};
+	}};
+
+	// Only the validators are repeated; there is no content.
+	if(download_not_modified(request, etag))
+	{
+		m::resource::response
+		{
+			client,
+			http::NOT_MODIFIED,
+			{},
+			0UL,
+			fmt::sprintf
+			{
+				headers_buf, "%sETag: %s\r\n",
+				download_headers,
+				etag,
+			},
+		};
+
+		return {};
+	}
+
+	const auto range
+	{
+		download_range(request, file_size, etag)
+	};
+
+	const bool partial
+	{
+		range.first || range.second != file_size
+	};
+
+	char content_range_buf[96];
+	const string_view content_range
+	{
+		partial?
+			fmt::sprintf
+			{
+				content_range_buf, "bytes %zu-%zu/%zu",
+				range.first,
+				range.first + range.second - 1,
+				file_size,
+			}:
+			string_view{}
 	};
 
 	// Send HTTP head to client
 	m::resource::response
 	{
 		client,
-		http::OK,
+		partial? http::PARTIAL_CONTENT: http::OK,
 		content_type,
-		file_size,
-		addl_headers,
+		range.second,
+		headers(content_range),
 	};
 
-	size_t sent{0}, read
+	const auto send{[&client](const const_buffer &block)
 	{
-		m::media::file::read(room, [&client, &sent]
-		(const string_view &block)
-		{
-			sent += write_all(*client.sock, block);
-		})
+		client.write_all(block);
+	}};
+
+	const size_t read
+	{
+		partial?
+			m::media::file::read(room, range, send):
+			m::media::file::read(room, send)
 	};
 
-	if(unlikely(read != file_size))
+	if(unlikely(read != range.second))
 		log::error
 		{
 			m::media::log, "File %s/%s [%s] size mismatch: expected %zu got %zu",
 			server,
 			file,
 			string_view{room.room_id},
-			file_size,
+			range.second,
 			read
 		};
 
 	// Have to kill client here after failing content length expectation.
-	if(unlikely(read != file_size))
+	if(unlikely(read != range.second))
 		client.close(net::dc::RST, net::close_ignore);
 
 	return {};
 }
 
+/// The entity tag of a file. The content of an mxc never changes, so the
+/// file's room, which is named by the mxc, is a strong validator; it's known
+/// before the content is, so it's the same whether or not the file is stored.
+static string_view
+download_etag(const mutable_buffer &buf,
+              const m::room::id &room_id)
+{
+	return fmt::sprintf
+	{
+		buf, "\"%s\"", room_id
+	};
+}
+
+/// True if the client's copy is current: the request's If-None-Match lists
+/// the file's entity tag (or is a wildcard).
+static bool
+download_not_modified(const m::resource::request &request,
+                      const string_view &etag)
+{
+	const string_view &if_none_match
+	{
+		http::headers(request.head.headers)["If-None-Match"]
+	};
+
+	if(!if_none_match || !etag)
+		return false;
+
+	bool ret(false);
+	tokens(if_none_match, ',', [&ret, &etag]
+	(const string_view &tag)
+	{
+		const string_view &candidate
+		{
+			lstrip(strip(tag, ' '), "W/")
+		};
+
+		ret |= candidate == etag || candidate == "*";
+	});
+
+	return ret;
+}
+
+/// The (offset, length) of the file to respond with. The whole file unless
+/// a satisfiable single byte range was requested. Multiple ranges and ranges
+/// conditional on another version of the file are answered in full.
+static std::pair<size_t, size_t>
+download_range(const m::resource::request &request,
+               const size_t &file_size,
+               const string_view &etag)
+{
+	const std::pair<size_t, size_t> full
+	{
+		0, file_size
+	};
+
+	const string_view &range
+	{
+		request.head.range
+	};
+
+	if(!range || !startswith(range, "bytes="))
+		return full;
+
+	if(request.head.if_range && request.head.if_range != etag)
+		return full;
+
+	const string_view spec
+	{
+		strip(lstrip(range, "bytes="), ' ')
+	};
+
+	if(has(spec, ','))
+		return full;
+
+	const auto &[first_, last_]
+	{
+		split(spec, '-')
+	};
+
+	const auto first
+	{
+		lex_castable<size_t>(first_)?
+			lex_cast<size_t>(first_):
+			size_t(-1)
+	};
+
+	const auto last
+	{
+		lex_castable<size_t>(last_)?
+			lex_cast<size_t>(last_):
+			size_t(-1)
+	};
+
+	// bytes=-N is the final N bytes.
+	if(!first_ && last != size_t(-1) && last > 0)
+		return
+		{
+			file_size - std::min(last, file_size), std::min(last, file_size)
+		};
+
+	if(first == size_t(-1) || (last_ && last == size_t(-1)) || (last_ && last < first))
+		return full;
+
+	if(first >= file_size)
+	{
+		m::error err
+		{
+			http::RANGE_NOT_SATISFIABLE, "M_RANGE_NOT_SATISFIABLE",
+			"Range starting at %zu is beyond the file size of %zu",
+			first,
+			file_size,
+		};
+
+		err.headers += fmt::snstringf
+		{
+			64, "Content-Range: bytes */%zu\r\n", file_size
+		};
+
+		throw err;
+	}
+
+	const size_t end
+	{
+		last_? std::min(last + 1, file_size): file_size
+	};
+
+	return
+	{
+		first, end - first
+	};
+}
+
 static m::resource::method
 method_get
 {
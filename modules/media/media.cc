@@ -100,12 +100,63 @@ ircd::m::media::blocks_descriptor
 	60s * 60 * 24 * 42,
 };
 
+// Thumbnails column
+decltype(ircd::m::media::thumbnails_descriptor)
+ircd::m::media::thumbnails_descriptor
+{
+	// name
+	"thumbnails",
+
+	// explain
+	R"(
+	Key-value store of thumbnails generated from files. The key is the mxc
+	followed by the dimensions and method of the thumbnail. The value is the
+	content-type, a null, and the binary image.
+	)",
+
+	// typing
+	{
+		typeid(string_view), typeid(string_view)
+	},
+
+	{},      // options
+	{},      // comparaor
+	{},      // prefix transform
+	false,   // drop column
+
+	bool(blocks_cache_enable)? -1 : 0,
+
+	bool(blocks_cache_comp_enable)? -1 : 0,
+
+	// bloom_bits
+	10,
+
+	// expect hit
+	false,
+
+	// block_size
+	32_KiB,
+
+	// meta block size
+	512,
+
+	// compression
+	{}, // no compression
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
 decltype(ircd::m::media::description)
 ircd::m::media::description
 {
 	{ "default" }, // requirement of RocksDB
 
 	blocks_descriptor,
+	thumbnails_descriptor,
 };
 
 decltype(ircd::m::media::blocks_cache_size)
@@ -140,6 +191,22 @@ ircd::m::media::blocks_cache_comp_size
 	}
 };
 
+decltype(ircd::m::media::thumbnails_cache_size)
+ircd::m::media::thumbnails_cache_size
+{
+	{
+		{ "name",     "ircd.media.thumbnails.cache.size" },
+		{ "default",  long(32_MiB)                       },
+	}, []
+	{
+		if(!thumbnails)
+			return;
+
+		const size_t &value{thumbnails_cache_size};
+		db::capacity(db::cache(thumbnails), value);
+	}
+};
+
 decltype(ircd::m::media::blocks_prefetch)
 ircd::m::media::blocks_prefetch
 {
@@ -160,12 +227,12 @@ ircd::m::media::database;
 decltype(ircd::m::media::blocks)
 ircd::m::media::blocks;
 
+decltype(ircd::m::media::thumbnails)
+ircd::m::media::thumbnails;
+
 decltype(ircd::m::media::downloading)
 ircd::m::media::downloading;
 
-decltype(ircd::m::media::downloading_dock)
-ircd::m::media::downloading_dock;
-
 //
 // init
 //
@@ -176,11 +243,13 @@ ircd::m::media::init()
 	static const std::string dbopts;
 	database = std::make_shared<db::database>("media", dbopts, description);
 	blocks = db::column{*database, "blocks"};
+	thumbnails = db::column{*database, "thumbnails"};
 
 	// The conf setter callbacks must be manually executed after
 	// the database was just loaded to set the cache size.
 	conf::reset("ircd.media.blocks.cache.size");
 	conf::reset("ircd.media.blocks.cache_comp.size");
+	conf::reset("ircd.media.thumbnails.cache.size");
 }
 
 void
@@ -189,7 +258,12 @@ ircd::m::media::fini()
 	// The database close contains pthread_join()'s within RocksDB which
 	// deadlock under certain conditions when called during a dlclose()
 	// (i.e static destruction of this module). Therefor we must manually
-	// close the db here first.
+	// close the db here first, after any downloads still writing to it.
+	download_dock.wait([]
+	{
+		return downloading.empty();
+	});
+
 	database = std::shared_ptr<db::database>{};
 }
 
@@ -224,100 +298,125 @@ ircd::m::media::file::download(const mxc &mxc,
                                const m::user::id &user_id,
                                const m::room::id &room_id,
                                string_view remote)
-try
 {
-	auto iit
+	auto it
 	{
-		downloading.emplace(room_id)
+		downloading.lower_bound(room_id)
 	};
 
-	if(!iit.second)
+	if(it != end(downloading) && it->first == room_id)
 	{
-		downloading_dock.wait([&room_id]
-		{
-			return !downloading.count(room_id);
-		});
-
+		const auto fetch(it->second);
+		fetch->follow({}, {});
 		return room_id;
 	}
 
-	const unwind uw{[&iit]
-	{
-		downloading.erase(iit.first);
-		downloading_dock.notify_all();
-	}};
-
 	if(exists(room_id))
 		return room_id;
 
-	if(!remote)
-		remote = mxc.server;
-
-	const unique_buffer<mutable_buffer> buf
+	const auto fetch
 	{
-		16_KiB
+		std::make_shared<media::fetch>(room_id)
 	};
 
-	const auto pair
+	it = downloading.emplace_hint(it, fetch->room_id, fetch);
+	const unwind erase{[&it]
 	{
-		download(buf, mxc, remote)
-	};
+		downloading.erase(it);
+		download_dock.notify_all();
+	}};
 
-	const auto &head
-	{
-		pair.first
-	};
+	fetch->run(mxc, user_id, remote?: mxc.server);
+	return room_id;
+}
 
-	const const_buffer &content
-	{
-		pair.second
-	};
+bool
+IRCD_MODULE_EXPORT
+ircd::m::media::file::stream(const mxc &mxc,
+                             const m::user::id &user_id,
+                             const head_closure &head_closure,
+                             const closure &closure,
+                             string_view remote)
+{
+	if(remote && my_host(remote))
+		return false;
 
-	char mime_type_buf[64];
-	const auto &content_type
-	{
-		magic::mime(mime_type_buf, content)
-	};
+	if(!remote && my_host(mxc.server))
+		return false;
 
-	if(content_type != head.content_type) log::dwarning
+	const m::room::id::buf room_id
 	{
-		log, "Server %s claims thumbnail %s is '%s' but we think it is '%s'",
-		remote,
-		mxc.mediaid,
-		head.content_type,
-		content_type,
+		file::room_id(mxc)
 	};
 
-	m::vm::copts vmopts;
-	const m::room room
+	auto it
 	{
-		room_id, &vmopts
+		downloading.lower_bound(room_id)
 	};
 
-	create(room, user_id, "file");
-	const unwind_exceptional purge{[&room]
+	if(it != end(downloading) && it->first == room_id)
 	{
-		m::room::purge(room);
-	}};
+		const auto fetch(it->second);
+		return fetch->follow(head_closure, closure);
+	}
 
-	const size_t written
+	if(exists(room_id))
+		return false;
+
+	const auto fetch
 	{
-		file::write(room, user_id, content, content_type)
+		std::make_shared<media::fetch>(room_id)
 	};
 
-	return room;
-}
-catch(const ircd::server::unavailable &e)
-{
-	throw m::error
+	downloading.emplace_hint(it, fetch->room_id, fetch);
+
+	// The download is conducted by its own context so it proceeds at the pace
+	// of the remote rather than of this client; this request then follows it
+	// like any other.
+	context
 	{
-		http::BAD_GATEWAY, "M_MEDIA_UNAVAILABLE",
-		"Server '%s' is not available for media for '%s/%s' :%s",
-		remote,
-		mxc.server,
-		mxc.mediaid,
-		e.what()
+		"media.fetch",
+		size_t(download_stack_size),
+		context::POST | context::DETACH,
+		[fetch,
+		 server(std::string(mxc.server)),
+		 mediaid(std::string(mxc.mediaid)),
+		 user_id(std::string(user_id)),
+		 remote(std::string(remote?: mxc.server))]
+		{
+			const unwind erase{[&fetch]
+			{
+				const auto it(downloading.find(fetch->room_id));
+				if(it != end(downloading) && it->second == fetch)
+					downloading.erase(it);
+
+				download_dock.notify_all();
+			}};
+
+			try
+			{
+				fetch->run(media::mxc{server, mediaid}, m::user::id{user_id}, remote);
+			}
+			catch(const ctx::interrupted &)
+			{
+				throw;
+			}
+			catch(const std::exception &e)
+			{
+				// Presented to the followers by the fetch.
+				log::derror
+				{
+					log, "Download of %s/%s from '%s' :%s",
+					server,
+					mediaid,
+					remote,
+					e.what(),
+				};
+			}
+		}
 	};
+
+	return fetch->follow(head_closure, closure);
 }
 
 decltype(ircd::m::media::download_timeout)
@@ -325,6 +424,58 @@ ircd::m::media::download_timeout
 {
 	{ "name",     "ircd.media.download.timeout" },
 	{ "default",  30L                           },
+	{ "description",
+
+	R"(
+	Seconds to wait for a remote server to respond with media, or to send
+	more of it once it started.
+	)"}
+};
+
+decltype(ircd::m::media::download_pending_max)
+ircd::m::media::download_pending_max
+{
+	{ "name",     "ircd.media.download.pending.max" },
+	{ "default",  64L                               },
+	{ "description",
+
+	R"(
+	Number of blocks of remote media which may be received ahead of being
+	written to the file's room. Reception is held until the backlog drains
+	below this number, and the remote is held off by the transport.
+	)"}
+};
+
+decltype(ircd::m::media::download_stack_size)
+ircd::m::media::download_stack_size
+{
+	{ "name",     "ircd.media.download.stack.size" },
+	{ "default",  long(512_KiB)                    },
+	{ "description",
+
+	R"(
+	Stack size of the context conducting a remote media download for a
+	streaming client request.
+	)"}
+};
+
+decltype(ircd::m::media::download_dock)
+ircd::m::media::download_dock;
+
+decltype(ircd::m::media::download_window)
+ircd::m::media::download_window
+{
+	{ "name",     "ircd.media.download.window" },
+	{ "default",  long(128_KiB)                },
+	{ "description",
+
+	R"(
+	Size of the buffer receiving remote media. Content is consumed from this
+	window in blocks as it arrives, so the whole file is never buffered in
+	memory at once. Chunked encoded responses are the exception: each chunk
+	is allocated as received and all of them are held until the response
+	completes.
+	)"}
 };
 
 std::pair
@@ -386,6 +537,400 @@ ircd::m::media::file::download(const mutable_buffer &buf_,
 	};
 }
 
+//
+// media::fetch
+//
+
+decltype(ircd::m::media::fetch::sopts)
+ircd::m::media::fetch::sopts{[]
+{
+	server::request::opts ret;
+	ret.content_window = true;
+	return ret;
+}()};
+
+ircd::m::media::fetch::fetch(const m::room::id &room_id)
+:room_id{room_id}
+{
+}
+
+/// Download the file and write it to its room as it arrives. Requests for
+/// the content follow() the fetch from the blocks as they are written.
+void
+ircd::m::media::fetch::run(const mxc &mxc,
+                           const m::user::id &user_id,
+                           const string_view &remote)
+try
+{
+	assert(!my_host(remote));
+	const unique_buffer<mutable_buffer> buf
+	{
+		32_KiB
+	};
+
+	const unique_buffer<mutable_buffer> window
+	{
+		size_t(download_window)
+	};
+
+	// The progress callback cuts the content into blocks which queue here
+	// until they are written. Reception is paused while the queue is full.
+	std::deque<unique_buffer<mutable_buffer>> pending;
+	unique_buffer<mutable_buffer> partial;
+	size_t partial_len(0), received(0);
+	fed::request *req {nullptr};
+	bool paused {false};
+
+	mutable_buffer out_buf
+	{
+		data(buf), 16_KiB
+	};
+
+	fed::request::opts fedopts;
+	fedopts.remote = remote;
+	fedopts.sopts = &sopts;
+	fedopts.in.head = buf + 16_KiB;
+	fedopts.in.content = window;
+	fedopts.in.progress = [this, &pending, &partial, &partial_len, &received, &paused, &req]
+	(const const_buffer &buffer, const const_buffer &content)
+	{
+		const_buffer in{buffer};
+
+		// Chunked responses are received into dynamic chunks (the window is
+		// nulled) which still end with their terminator here; it's only
+		// trimmed after this callback. The second argument views the chunk
+		// read so far, so only the chunk's payload is taken from the buffer.
+		assert(req);
+		if(null(req->in.content))
+		{
+			assert(!req->in.chunks.empty());
+			const size_t chunk_size
+			{
+				ircd::size(req->in.chunks.back())
+			};
+
+			const size_t payload_size
+			{
+				chunk_size - std::min(chunk_size, ircd::size(http::line::terminator))
+			};
+
+			const size_t offset
+			{
+				ircd::size(content) - ircd::size(buffer)
+			};
+
+			in = const_buffer
+			{
+				data(buffer), std::min(ircd::size(buffer), payload_size - std::min(payload_size, offset))
+			};
+		}
+
+		while(!empty(in))
+		{
+			if(empty(partial))
+				partial = unique_buffer<mutable_buffer>{file::block_size};
+
+			const size_t copied
+			{
+				copy(partial + partial_len, in)
+			};
+
+			consume(in, copied);
+			partial_len += copied;
+			if(partial_len < ircd::size(partial))
+				continue;
+
+			pending.emplace_back(std::move(partial));
+			partial_len = 0;
+		}
+
+		received += ircd::size(buffer);
+		if(!paused && pending.size() >= size_t(download_pending_max))
+		{
+			paused = true;
+			server::pause(*req);
+		}
+
+		dock.notify_all();
+	};
+
+	json::get<"method"_>(fedopts.request) = "GET";
+	json::get<"uri"_>(fedopts.request) = fmt::sprintf
+	{
+		out_buf, "/_matrix/media/r0/download/%s/%s",
+		mxc.server,
+		mxc.mediaid,
+	};
+	consume(out_buf, ircd::size(json::get<"uri"_>(fedopts.request)));
+
+	fed::request request
+	{
+		out_buf, std::move(fedopts)
+	};
+
+	req = &request;
+
+	// Failures don't reach the progress callback; the dock is notified when
+	// the request completes in any way.
+	ctx::state(request).then = [this](ctx::shared_state_base &)
+	{
+		dock.notify_all();
+	};
+
+	const auto requesting{[&request]
+	{
+		return ctx::is(ctx::state(request), ctx::future_state::PENDING);
+	}};
+
+	m::vm::copts vmopts;
+	const m::room room
+	{
+		room_id, &vmopts
+	};
+
+	bool created {false};
+	const unwind_exceptional purge{[this, &room, &created]
+	{
+		if(created && !done)
+			m::room::purge(room);
+	}};
+
+	// The file room is created and described with the first block, which
+	// is when the response head is first viewable.
+	const auto start{[&](const const_buffer &first)
+	{
+		parse::buffer pb{request.in.head};
+		parse::capstan pc{pb};
+		pc.read += ircd::size(request.in.head);
+		const http::response::head head{pc};
+
+		content_type = magic::mime(type_buf, first);
+		if(content_type != head.content_type) log::dwarning
+		{
+			log, "Server %s claims file %s is '%s' but we think it is '%s'",
+			remote,
+			mxc.mediaid,
+			head.content_type,
+			content_type,
+		};
+
+		size = !head.transfer_encoding? head.content_length: 0;
+		create(room, user_id, "file");
+		created = true;
+
+		//TODO: TXN
+		if(size)
+			send(room, user_id, "ircd.file.stat", "size", json::members
+			{
+				{ "value", long(size) }
+			});
+
+		//TODO: TXN
+		send(room, user_id, "ircd.file.stat", "type", json::members
+		{
+			{ "value", content_type }
+		});
+
+		this->head = true;
+		dock.notify_all();
+	}};
+
+	size_t wrote(0);
+	const auto write{[&](const const_buffer &block)
+	{
+		if(!head)
+			start(block);
+
+		char b58buf[b58::encode_size(sha256::digest_size)];
+		const auto hash
+		{
+			file::write_block(b58buf, room, user_id, block)
+		};
+
+		blocks.emplace_back(hash);
+		wrote += ircd::size(block);
+		dock.notify_all();
+	}};
+
+	while(requesting() || !pending.empty())
+	{
+		if(!pending.empty())
+		{
+			// Taken off the queue first; more may be appended by the progress
+			// callback while this context yields to write it.
+			const auto block
+			{
+				std::move(pending.front())
+			};
+
+			pending.pop_front();
+			if(paused && pending.size() < size_t(download_pending_max))
+			{
+				server::pause(request, false);
+				paused = false;
+			}
+
+			write(block);
+			continue;
+		}
+
+		const auto last(received);
+		const bool progress
+		{
+			dock.wait_for(seconds(download_timeout), [&requesting, &pending, &received, &last]
+			{
+				return !requesting() || !pending.empty() || received != last;
+			})
+		};
+
+		if(!progress)
+			throw m::error
+			{
+				http::GATEWAY_TIMEOUT, "M_MEDIA_DOWNLOAD_TIMEOUT",
+				"Server '%s' did not respond with media for '%s/%s' in time",
+				remote,
+				mxc.server,
+				mxc.mediaid
+			};
+	}
+
+	// Any error from the remote is thrown here.
+	request.get();
+
+	if(partial_len)
+		write(const_buffer{partial, partial_len});
+
+	if(!head)
+		start(const_buffer{});
+
+	//TODO: TXN
+	if(!size)
+		send(room, user_id, "ircd.file.stat", "size", json::members
+		{
+			{ "value", long(wrote) }
+		});
+
+	if(unlikely(size && wrote != size))
+		throw m::error
+		{
+			http::BAD_GATEWAY, "M_MEDIA_INCOMPLETE",
+			"Server '%s' sent %zu of %zu bytes of media for '%s/%s'",
+			remote,
+			wrote,
+			size,
+			mxc.server,
+			mxc.mediaid,
+		};
+
+	done = true;
+	dock.notify_all();
+}
+catch(const ircd::server::unavailable &e)
+{
+	try
+	{
+		throw m::error
+		{
+			http::BAD_GATEWAY, "M_MEDIA_UNAVAILABLE",
+			"Server '%s' is not available for media for '%s/%s' :%s",
+			remote,
+			mxc.server,
+			mxc.mediaid,
+			e.what()
+		};
+	}
+	catch(...)
+	{
+		eptr = std::current_exception();
+		done = true;
+		dock.notify_all();
+		throw;
+	}
+}
+catch(...)
+{
+	// The download itself may have completed; the error is the caller's.
+	if(!done)
+	{
+		eptr = std::current_exception();
+		done = true;
+		dock.notify_all();
+	}
+
+	throw;
+}
+
+/// Follow the download from another request. Without closures this only
+/// waits for the download to finish. Returns true if the content was
+/// presented to the closures; false when the size of the file was not known
+/// ahead of completion, in which case it is read from the room afterward.
+bool
+ircd::m::media::fetch::follow(const file::head_closure &head_closure,
+                              const file::closure &closure)
+{
+	if(!closure)
+	{
+		dock.wait([this]
+		{
+			return done;
+		});
+
+		return false;
+	}
+
+	dock.wait([this]
+	{
+		return head || done;
+	});
+
+	if(eptr)
+		std::rethrow_exception(eptr);
+
+	if(!size)
+	{
+		dock.wait([this]
+		{
+			return done;
+		});
+
+		if(eptr)
+			std::rethrow_exception(eptr);
+
+		return false;
+	}
+
+	head_closure(size, content_type);
+	for(size_t i(0);; ++i)
+	{
+		dock.wait([this, &i]
+		{
+			return i < blocks.size() || done;
+		});
+
+		if(eptr)
+			std::rethrow_exception(eptr);
+
+		if(i >= blocks.size())
+			break;
+
+		// Copied; the vector may grow while the closure yields.
+		const std::string hash
+		{
+			blocks.at(i)
+		};
+
+		if(unlikely(!block::get(hash, closure)))
+			throw m::NOT_FOUND
+			{
+				"File [%s] block %s missing while downloading",
+				string_view{room_id},
+				hash,
+			};
+	}
+
+	return true;
+}
+
 size_t
 IRCD_MODULE_EXPORT
 ircd::m::media::file::write(const m::room &room,
@@ -410,7 +955,7 @@ ircd::m::media::file::write(const m::room &room,
 	{
 		const size_t blksz
 		{
-			std::min(size(content) - off, size_t(32_KiB))
+			std::min(size(content) - off, size_t(block_size))
 		};
 
 		const const_buffer &block
@@ -418,7 +963,8 @@ ircd::m::media::file::write(const m::room &room,
 			data(content) + off, blksz
 		};
 
-		block::set(room, user_id, block);
+		char b58buf[b58::encode_size(sha256::digest_size)];
+		write_block(b58buf, room, user_id, block);
 		wrote += size(block);
 		off += blksz;
 	}
@@ -428,6 +974,143 @@ ircd::m::media::file::write(const m::room &room,
 	return wrote;
 }
 
+/// Writes the block and its event to the file's room; returns the hash.
+ircd::string_view
+ircd::m::media::file::write_block(const mutable_buffer &b58buf,
+                                  const m::room &room,
+                                  const m::user::id &user_id,
+                                  const const_buffer &block)
+{
+	const string_view hash
+	{
+		block::set(b58buf, block)
+	};
+
+	send(room, user_id, "ircd.file.block", json::members
+	{
+		{ "size",  long(size(block))  },
+		{ "hash",  hash               }
+	});
+
+	return hash;
+}
+
+/// Read the bytes of the file in the range [offset, offset + length). The
+/// blocks are found in the room's type index and only those events holding
+/// the range are fetched. All blocks but the last are block_size.
+size_t
+IRCD_MODULE_EXPORT
+ircd::m::media::file::read(const m::room &room,
+                           const std::pair<size_t, size_t> &range,
+                           const closure &closure)
+{
+	const auto &[offset, length]
+	{
+		range
+	};
+
+	if(!length)
+		return 0;
+
+	std::vector<event::idx> idxs;
+	const m::room::type blocks
+	{
+		room, "ircd.file.block"
+	};
+
+	blocks.for_each([&idxs]
+	(const string_view &, const uint64_t &, const event::idx &event_idx)
+	{
+		idxs.emplace_back(event_idx);
+		return true;
+	});
+
+	// The index iterates by descending depth.
+	std::reverse(begin(idxs), end(idxs));
+	const size_t first
+	{
+		offset / block_size
+	};
+
+	const size_t last
+	{
+		(offset + length - 1) / block_size
+	};
+
+	if(unlikely(last >= idxs.size()))
+		throw m::NOT_FOUND
+		{
+			"File [%s] block %zu not found of %zu blocks",
+			string_view{room.room_id},
+			last,
+			idxs.size(),
+		};
+
+	size_t ret{0}, prefetched{first};
+	for(size_t i(first); i <= last; ++i)
+	{
+		for(; prefetched <= last && prefetched < i + events_prefetch; ++prefetched)
+			m::prefetch(idxs[prefetched], "content");
+
+		char hashbuf[b58::encode_size(sha256::digest_size)];
+		size_t block_size_(0);
+		string_view hash;
+		m::get(idxs[i], "content", [&hashbuf, &block_size_, &hash]
+		(const json::object &content)
+		{
+			hash = strlcpy(hashbuf, json::string(content.at("hash")));
+			block_size_ = content.get<size_t>("size");
+		});
+
+		if(unlikely(block_size_ != block_size && i + 1 < idxs.size()))
+			throw m::NOT_FOUND
+			{
+				"File [%s] block %zu [%s] size %zu is irregular",
+				string_view{room.room_id},
+				i,
+				hash,
+				block_size_,
+			};
+
+		// Trim the block to the range at the first and last blocks.
+		const size_t start
+		{
+			i == first? offset % block_size: 0
+		};
+
+		const size_t stop
+		{
+			i == last? (offset + length - 1) % block_size + 1: block_size_
+		};
+
+		const bool found
+		{
+			block::get(hash, [&closure, &ret, &start, &stop]
+			(const const_buffer &block)
+			{
+				const const_buffer part
+				{
+					data(block) + start, std::min(stop, size(block)) - std::min(start, size(block))
+				};
+
+				ret += size(part);
+				closure(part);
+			})
+		};
+
+		if(unlikely(!found))
+			throw m::NOT_FOUND
+			{
+				"File [%s] block %zu [%s] missing",
+				string_view{room.room_id},
+				i,
+				hash,
+			};
+	}
+
+	return ret;
+}
+
 size_t
 IRCD_MODULE_EXPORT
 ircd::m::media::file::read(const m::room &room,
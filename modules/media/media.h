@@ -11,6 +11,7 @@
 namespace ircd::m::media
 {
 	struct magick;
+	struct fetch;
 
 	static void init();
 	static void fini();
@@ -22,18 +23,63 @@ namespace ircd::m::media
 	extern conf::item<size_t> blocks_cache_comp_size;
 	extern conf::item<size_t> blocks_prefetch;
 	extern conf::item<size_t> events_prefetch;
+	extern conf::item<size_t> thumbnails_cache_size;
 	extern const db::descriptor blocks_descriptor;
+	extern const db::descriptor thumbnails_descriptor;
 	extern const db::description description;
 	extern std::shared_ptr<db::database> database;
 	extern db::column blocks;
+	extern db::column thumbnails;
 
 	extern conf::item<seconds> download_timeout;
-	extern std::set<m::room::id> downloading;
-	extern ctx::dock downloading_dock;
+	extern conf::item<size_t> download_window;
+	extern conf::item<size_t> download_pending_max;
+	extern conf::item<size_t> download_stack_size;
+	extern ctx::dock download_dock;
+	extern std::map<m::room::id, std::shared_ptr<fetch>> downloading;
+}
+
+/// A remote file being downloaded. Blocks are hashed and written to the
+/// file's room as the content arrives rather than after the whole response
+/// is received. Other requests for the same file follow the fetch and are
+/// presented each block once it is written.
+struct ircd::m::media::fetch
+{
+	static const server::request::opts sopts;
+
+	m::room::id::buf room_id;
+	size_t size {0};                  // content-length; 0 when not known
+	char type_buf[64];
+	string_view content_type;
+	std::vector<std::string> blocks;  // hashes of the blocks written so far
+	std::exception_ptr eptr;
+	bool head {false};                // size and content_type are set
+	bool done {false};
+	ctx::dock dock;
+
+	bool follow(const file::head_closure &, const file::closure &);
+	void run(const mxc &, const m::user::id &, const string_view &remote);
+
+	fetch(const m::room::id &);
+};
+
+namespace ircd::m::media::file
+{
+	string_view write_block(const mutable_buffer &hash, const room &, const user::id &, const const_buffer &block);
 }
 
 namespace ircd::m::media::thumbnail
 {
+	using dimensions = std::pair<size_t, size_t>; // x, y
+
+	string_view method(const string_view &);
+	string_view make_key(const mutable_buffer &, const mxc &, const dimensions &, const string_view &method);
+	bool permitted(const string_view &content_type);
+	void generate(const const_buffer &file, const dimensions &, const string_view &method, const ircd::magick::thumbnail::result_closure &);
+	void store(const mxc &, const dimensions &, const string_view &method, const string_view &content_type, const const_buffer &);
+	void pregenerate(const mxc &, const const_buffer &file, const string_view &content_type, const string_view &spec);
+	size_t pregenerate(const mxc &, const const_buffer &file, const string_view &content_type);
+
 	extern conf::item<bool> enable;
 	extern conf::item<bool> enable_remote;
 	extern conf::item<size_t> width_min;
@@ -42,4 +88,7 @@ namespace ircd::m::media::thumbnail
 	extern conf::item<size_t> height_max;
 	extern conf::item<std::string> mime_whitelist;
 	extern conf::item<std::string> mime_blacklist;
+	extern conf::item<bool> store_enable;
+	extern conf::item<size_t> store_max;
+	extern conf::item<std::string> pregen;
 }
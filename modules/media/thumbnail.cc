@@ -69,6 +69,46 @@ ircd::m::media::thumbnail::mime_blacklist
 	{ "default",  ""                                      },
 };
 
+decltype(ircd::m::media::thumbnail::store_enable)
+ircd::m::media::thumbnail::store_enable
+{
+	{ "name",     "ircd.m.media.thumbnail.store.enable" },
+	{ "default",  true                                  },
+	{ "description",
+
+	R"(
+	Keep generated thumbnails in the media database. Subsequent requests for
+	the same file, dimensions and method are served from there.
+	)"}
+};
+
+decltype(ircd::m::media::thumbnail::store_max)
+ircd::m::media::thumbnail::store_max
+{
+	{ "name",     "ircd.m.media.thumbnail.store.max" },
+	{ "default",  long(1_MiB)                        },
+	{ "description",
+
+	R"(
+	Thumbnails larger than this many bytes are not kept.
+	)"}
+};
+
+decltype(ircd::m::media::thumbnail::pregen)
+ircd::m::media::thumbnail::pregen
+{
+	{ "name",     "ircd.m.media.thumbnail.pregen" },
+	{ "default",  ""                              },
+	{ "description",
+
+	R"(
+	Space separated list of thumbnails generated and kept when a file is
+	uploaded, each as WIDTHxHEIGHT:METHOD. The sizes recommended by the
+	specification are: 32x32:crop 96x96:crop 320x240:scale 640x480:scale
+	800x600:scale
+	)"}
+};
+
 m::resource
 thumbnail_resource__legacy
 {
@@ -95,6 +135,19 @@ get__thumbnail_local(client &client,
                      const m::media::mxc &,
                      const m::room &room);
 
+static bool
+get__thumbnail_stored(client &client,
+                      const m::resource::request &request,
+                      const m::media::mxc &);
+
+static m::media::thumbnail::dimensions
+get__thumbnail_dimensions(const m::resource::request &request);
+
+static const auto &addl_headers
+{
+	"Cache-Control: public, max-age=31536000, immutable\r\n"_sv
+};
+
 m::resource::response
 get__thumbnail(client &client,
                const m::resource::request &request)
@@ -116,6 +169,10 @@ get__thumbnail(client &client,
 		request.parv[0], request.parv[1]
 	};
 
+	// A thumbnail made before is sent without looking at the file at all.
+	if(get__thumbnail_stored(client, request, mxc))
+		return {};
+
 	// Thumbnail doesn't require auth so if there is no user_id detected
 	// then we download on behalf of @ircd.
 	const m::user::id &user_id
@@ -171,24 +228,16 @@ method_get
 	}
 };
 
-static m::resource::response
-get__thumbnail_local(client &client,
-                     const m::resource::request &request,
-                     const m::media::mxc &mxc,
-                     const m::room &room)
+static m::media::thumbnail::dimensions
+get__thumbnail_dimensions(const m::resource::request &request)
 {
-	const auto &method
-	{
-		request.query.get("method", "scale"_sv)
-	};
-
 	const size_t _dimension[]
 	{
 		request.query.get<size_t>("width", 0),
 		request.query.get<size_t>("height", 0),
 	};
 
-	const pair<size_t> dimension
+	return
 	{
 		_dimension[0]?
 			std::clamp(_dimension[0], size_t(width_min), size_t(width_max)):
@@ -198,6 +247,76 @@ get__thumbnail_local(client &client,
 			std::clamp(_dimension[1], size_t(height_min), size_t(height_max)):
 			_dimension[1]
 	};
+}
+
+static bool
+get__thumbnail_stored(client &client,
+                      const m::resource::request &request,
+                      const m::media::mxc &mxc)
+{
+	if(!enable || !store_enable || !m::media::thumbnails)
+		return false;
+
+	const auto &method
+	{
+		m::media::thumbnail::method(request.query.get("method", "scale"_sv))
+	};
+
+	const auto dimension
+	{
+		get__thumbnail_dimensions(request)
+	};
+
+	char keybuf[512];
+	const string_view key
+	{
+		m::media::thumbnail::make_key(keybuf, mxc, dimension, method)
+	};
+
+	bool found;
+	const std::string value
+	{
+		db::read(m::media::thumbnails, key, found)
+	};
+
+	if(!found)
+		return false;
+
+	const auto &[content_type, content]
+	{
+		split(value, '\0')
+	};
+
+	if(unlikely(!content_type || !content))
+		return false;
+
+	// The configuration may have changed since it was stored.
+	if(!m::media::thumbnail::permitted(content_type))
+		return false;
+
+	m::resource::response
+	{
+		client, content, content_type, http::OK, addl_headers
+	};
+
+	return true;
+}
+
+static m::resource::response
+get__thumbnail_local(client &client,
+                     const m::resource::request &request,
+                     const m::media::mxc &mxc,
+                     const m::room &room)
+{
+	const auto &method
+	{
+		m::media::thumbnail::method(request.query.get("method", "scale"_sv))
+	};
+
+	const auto dimension
+	{
+		get__thumbnail_dimensions(request)
+	};
 
 	static const m::event::fetch::opts fopts
 	{
@@ -267,27 +386,15 @@ get__thumbnail_local(client &client,
 			copied
 		};
 
-	const auto mime_type
-	{
-		split(content_type, ';').first
-	};
-
 	const bool permitted
 	{
-		// If there's a blacklist, mime type must not in the blacklist.
-		(!mime_blacklist || !has(mime_blacklist, mime_type))
-
-		// If there's a whitelist, mime type must be in the whitelist.
-		&& (!mime_whitelist || has(mime_whitelist, mime_type))
+		m::media::thumbnail::permitted(content_type)
 	};
 
 	const bool valid_args
 	{
 		// Both dimension parameters given in query string
 		(dimension.first && dimension.second)
-
-		// Known thumbnailing method in query string
-		&& (method == "scale" || method == "crop")
 	};
 
 	const bool fallback // Reasons to just send the original image
@@ -321,36 +428,213 @@ get__thumbnail_local(client &client,
 				"Unknown reason",
 		};
 
-	static const auto &addl_headers
-	{
-		"Cache-Control: public, max-age=31536000, immutable\r\n"_sv
-	};
-
 	if(fallback)
 		return m::resource::response
 		{
 			client, buf, content_type, http::OK, addl_headers
 		};
 
-	const auto closure{[&client, &content_type]
+	const auto closure{[&client, &mxc, &dimension, &method, &content_type]
 	(const const_buffer &buf)
 	{
+		m::media::thumbnail::store(mxc, dimension, method, content_type, buf);
 		m::resource::response
 		{
 			client, buf, content_type, http::OK, addl_headers
 		};
 	}};
 
+	m::media::thumbnail::generate(buf, dimension, method, closure);
+	return {}; // responded from closure.
+}
+
+//
+// media::thumbnail
+//
+
+/// The thumbnailing method conducted for the method in a request; anything
+/// but crop is scaled. Keys are made with the result so requests and
+/// pregenerated thumbnails agree.
+ircd::string_view
+ircd::m::media::thumbnail::method(const string_view &method)
+{
+	return method == "crop"?
+		"crop"_sv:
+		"scale"_sv;
+}
+
+ircd::string_view
+ircd::m::media::thumbnail::make_key(const mutable_buffer &buf,
+                                    const mxc &mxc,
+                                    const dimensions &dimension,
+                                    const string_view &method)
+{
+	return fmt::sprintf
+	{
+		buf, "%s/%s %zux%zu %s",
+		mxc.server,
+		mxc.mediaid,
+		dimension.first,
+		dimension.second,
+		thumbnail::method(method),
+	};
+}
+
+bool
+ircd::m::media::thumbnail::permitted(const string_view &content_type)
+{
+	const auto mime_type
+	{
+		split(content_type, ';').first
+	};
+
+	const bool permitted
+	{
+		// If there's a blacklist, mime type must not in the blacklist.
+		(!mime_blacklist || !has(mime_blacklist, mime_type))
+
+		// If there's a whitelist, mime type must be in the whitelist.
+		&& (!mime_whitelist || has(mime_whitelist, mime_type))
+	};
+
+	return permitted;
+}
+
+void
+ircd::m::media::thumbnail::generate(const const_buffer &file,
+                                    const dimensions &dimension,
+                                    const string_view &method,
+                                    const ircd::magick::thumbnail::result_closure &closure)
+{
 	if(method == "crop")
-		magick::thumbcrop
+		ircd::magick::thumbcrop
 		{
-			buf, dimension, closure
+			file, dimension, closure
 		};
 	else
-		magick::thumbnail
+		ircd::magick::thumbnail
 		{
-			buf, dimension, closure
+			file, dimension, closure
 		};
+}
 
-	return {}; // responded from closure.
+void
+ircd::m::media::thumbnail::store(const mxc &mxc,
+                                 const dimensions &dimension,
+                                 const string_view &method,
+                                 const string_view &content_type,
+                                 const const_buffer &thumb)
+try
+{
+	if(!store_enable || !thumbnails)
+		return;
+
+	if(size(thumb) > size_t(store_max))
+		return;
+
+	char keybuf[512];
+	const string_view key
+	{
+		make_key(keybuf, mxc, dimension, method)
+	};
+
+	std::string value;
+	value.reserve(size(content_type) + 1 + size(thumb));
+	value.append(content_type);
+	value.push_back('\0');
+	value.append(data(thumb), size(thumb));
+	db::write(thumbnails, key, const_buffer{value});
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::derror
+	{
+		log, "Failed to store thumbnail %s/%s %zux%zu %s :%s",
+		mxc.server,
+		mxc.mediaid,
+		dimension.first,
+		dimension.second,
+		method,
+		e.what(),
+	};
+}
+
+/// Generate and store the thumbnails configured by ircd.m.media.thumbnail.pregen
+/// for a newly written file. Returns the number generated.
+size_t
+ircd::m::media::thumbnail::pregenerate(const mxc &mxc,
+                                       const const_buffer &file,
+                                       const string_view &content_type)
+{
+	if(!IRCD_USE_MAGICK || !enable || !store_enable || !thumbnails)
+		return 0;
+
+	if(!permitted(content_type))
+		return 0;
+
+	size_t ret(0);
+	const std::string list(pregen);
+	tokens(list, ' ', [&](const string_view &token)
+	{
+		try
+		{
+			pregenerate(mxc, file, content_type, token);
+			++ret;
+		}
+		catch(const ctx::interrupted &)
+		{
+			throw;
+		}
+		catch(const std::exception &e)
+		{
+			log::derror
+			{
+				log, "Failed to pregenerate thumbnail %s for %s/%s :%s",
+				token,
+				mxc.server,
+				mxc.mediaid,
+				e.what(),
+			};
+		}
+	});
+
+	return ret;
+}
+
+void
+ircd::m::media::thumbnail::pregenerate(const mxc &mxc,
+                                       const const_buffer &file,
+                                       const string_view &content_type,
+                                       const string_view &spec)
+{
+	const auto &[size, method]
+	{
+		split(spec, ':')
+	};
+
+	const auto &[width, height]
+	{
+		split(size, 'x')
+	};
+
+	const dimensions dimension
+	{
+		std::clamp(lex_cast<size_t>(width), size_t(width_min), size_t(width_max)),
+		std::clamp(lex_cast<size_t>(height), size_t(height_min), size_t(height_max)),
+	};
+
+	if(method != "scale" && method != "crop")
+		throw ircd::error
+		{
+			"Unknown thumbnailing method '%s'", method
+		};
+
+	generate(file, dimension, method, [&](const const_buffer &thumb)
+	{
+		store(mxc, dimension, method, content_type, thumb);
+	});
 }
@@ -103,13 +103,31 @@ post__upload(client &client,
 		filename,
 	};
 
-	return m::resource::response
+	m::resource::response
 	{
 		client, http::CREATED, json::members
 		{
 			{ "content_uri", content_uri }
 		}
 	};
+
+	// The client has its response; thumbnails configured to be made up front
+	// are generated on this request's time.
+	const size_t pregenerated
+	{
+		m::media::thumbnail::pregenerate(mxc, buf, content_type)
+	};
+
+	if(pregenerated)
+		log::debug
+		{
+			m::media::log, "%s pregenerated %zu thumbnails for `%s'",
+			request.user_id,
+			pregenerated,
+			content_uri,
+		};
+
+	return {};
 }
 
 static const struct m::resource::method::opts